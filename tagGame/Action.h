@@ -32,8 +32,8 @@ namespace tagGame
 
       Action& operator=(Action const& a);
 
-      inline void setDesiredDirection(RealVec const& direction);
-      inline RealVec const& getDesiredDirection() const;
+      inline void setDesiredDirection(RealVec2 const& direction);
+      inline RealVec2 const& getDesiredDirection() const;
       inline void setDesiredSpeed(Real const speed);
       inline Real getDesiredSpeed() const;
 
@@ -48,19 +48,19 @@ namespace tagGame
       // problems with vectors whose length might otherwise get close to 0.
 
       // direction is a unit vector
-      RealVec direction;
+      RealVec2 direction;
       // speed is in the range [0, 1]
       Real speed;
    };
 
    std::ostream& operator<<(std::ostream& out, Action const& a);
 
-   void Action::setDesiredDirection(RealVec const& direction)
+   void Action::setDesiredDirection(RealVec2 const& direction)
    {
       this->direction = direction;
    }
    
-   RealVec const& Action::getDesiredDirection() const
+   RealVec2 const& Action::getDesiredDirection() const
    {
       return direction;
    }
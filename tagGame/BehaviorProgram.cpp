@@ -0,0 +1,288 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#include "BehaviorProgram.h"
+#include "ControllerConditional.h"
+#include "ControllerAvoid.h"
+#include "ControllerPeriodic.h"
+#include "ControllerPeriodicRamp.h"
+#include "ControllerRandomize.h"
+#include "ControllerEvade.h"
+#include "ControllerPursue.h"
+#include "ControllerWander.h"
+#include "Obstacle.h"
+#include "Random.h"
+#include "Steering.h"
+
+#include <algorithm>
+
+using namespace tagGame;
+
+using namespace std;
+
+BehaviorProgram::BehaviorProgram(Controller& root) :
+   instanceCount(0)
+{
+   compile(root, root.getPerception());
+}
+
+size_t BehaviorProgram::addNode(Op const op, size_t const slotCount)
+{
+   Node n;
+   n.op = op;
+   n.children[0] = n.children[1] = 0;
+   n.condition = NULL;
+   n.distance = NULL;
+   fill(n.parameters, n.parameters + 3, Real(0));
+   n.slot = initialSlots.size();
+
+   nodes.push_back(n);
+   initialSlots.resize(initialSlots.size() + slotCount);
+
+   return nodes.size() - 1;
+}
+
+size_t BehaviorProgram::compile(Controller& c, PerceptionPtr perception)
+{
+   // Every node uses the perception object passed to run.
+   TG_ASSERT(c.getPerception() == perception);
+
+   if (ControllerConditional* cc = dynamic_cast<ControllerConditional*>(&c))
+   {
+      size_t const k = addNode(conditionalOp, 0);
+      nodes[k].condition = cc->getCondition();
+      size_t const first = compile(*cc->getControllerTrue(), perception);
+      size_t const second = compile(*cc->getControllerFalse(), perception);
+      nodes[k].children[0] = first;
+      nodes[k].children[1] = second;
+      return k;
+   }
+
+   if (ControllerAvoid* ca = dynamic_cast<ControllerAvoid*>(&c))
+   {
+      // When it last detected a collision, and its last action.
+      size_t const k = addNode(avoidOp, 4);
+      initialSlots[nodes[k].slot] = -1;
+      store(Action(), &initialSlots[nodes[k].slot + 1]);
+      size_t const child = compile(*ca->getDefaultController(), perception);
+      nodes[k].children[0] = child;
+      return k;
+   }
+
+   if (ControllerPeriodic* cp = dynamic_cast<ControllerPeriodic*>(&c))
+   {
+      // When it last made a decision, and what it was.
+      size_t const k = addNode(periodicOp, 4);
+      initialSlots[nodes[k].slot] = -1;
+      store(Action(), &initialSlots[nodes[k].slot + 1]);
+      nodes[k].parameters[0] = cp->getPeriod();
+      size_t const child = compile(*cp->getController(), perception);
+      nodes[k].children[0] = child;
+      return k;
+   }
+
+   if (ControllerPeriodicRamp* cr = dynamic_cast<ControllerPeriodicRamp*>(&c))
+   {
+      size_t const k = addNode(periodicRampOp, 4);
+      initialSlots[nodes[k].slot] = -1;
+      store(Action(), &initialSlots[nodes[k].slot + 1]);
+      nodes[k].distance = cr->getDistance();
+      nodes[k].parameters[0] = cr->getFarDistance();
+      nodes[k].parameters[1] = cr->getMinPeriod();
+      nodes[k].parameters[2] = cr->getMaxPeriod();
+      size_t const child = compile(*cr->getController(), perception);
+      nodes[k].children[0] = child;
+      return k;
+   }
+
+   if (ControllerRandomize* cr = dynamic_cast<ControllerRandomize*>(&c))
+   {
+      size_t const k = addNode(randomizeOp, 0);
+      nodes[k].distance = cr->getDistance();
+      nodes[k].parameters[0] = cr->getFarDistance();
+      size_t const child = compile(*cr->getController(), perception);
+      nodes[k].children[0] = child;
+      return k;
+   }
+
+   if (dynamic_cast<ControllerEvade*>(&c)) { return addNode(evadeOp, 0); }
+   if (dynamic_cast<ControllerPursue*>(&c)) { return addNode(pursueOp, 0); }
+   if (dynamic_cast<ControllerWander*>(&c)) { return addNode(wanderOp, 0); }
+
+   Util::error("BehaviorProgram can't compile this type of controller");
+   return 0;
+}
+
+size_t BehaviorProgram::addInstance()
+{
+   if (!freeInstances.empty())
+   {
+      size_t const instance = freeInstances.back();
+      freeInstances.pop_back();
+      copy(initialSlots.begin(), initialSlots.end(), slots.begin() + instance * initialSlots.size());
+      return instance;
+   }
+
+   slots.insert(slots.end(), initialSlots.begin(), initialSlots.end());
+
+   return instanceCount++;
+}
+
+void BehaviorProgram::removeInstance(size_t const instance)
+{
+   TG_ASSERT(instance < instanceCount);
+
+   freeInstances.push_back(instance);
+}
+
+void BehaviorProgram::save(Snapshot& snapshot) const
+{
+   snapshot.write(instanceCount);
+   snapshot.writeArray(slots);
+   snapshot.writeArray(freeInstances);
+}
+
+void BehaviorProgram::restore(Snapshot const& snapshot, size_t& offset)
+{
+   // The instances belong to controllers, which aren't in the snapshot.
+   size_t n;
+   snapshot.read(offset, n);
+   if (n != instanceCount) { Util::error("BehaviorProgram: can't restore a snapshot with different instances"); }
+   snapshot.readArray(offset, slots, instanceCount * initialSlots.size());
+   snapshot.readArray(offset, freeInstances);
+   for (size_t i = 0; i < freeInstances.size(); i++)
+   {
+      if (instanceCount <= freeInstances[i]) { Util::error("BehaviorProgram: can't restore a snapshot with different instances"); }
+   }
+}
+
+void BehaviorProgram::run(size_t const instance, Perception& perception, Action& action)
+{
+   TG_ASSERT(instance < instanceCount);
+
+   run(0, &slots[0] + instance * initialSlots.size(), perception, action);
+}
+
+// Each case does exactly what the corresponding controller's calcAction
+// does, in the same order, so that the results are identical.
+void BehaviorProgram::run(size_t const node, Real* slots, Perception& perception, Action& action) const
+{
+   Node const& n(nodes[node]);
+   Real* const state = slots + n.slot;
+
+   switch (n.op)
+   {
+   case conditionalOp:
+      run(n.children[(perception.*(n.condition))() ? 0 : 1], slots, perception, action);
+      return;
+
+   case avoidOp:
+      if (perception.timeToCollision() > ControllerAvoid::soonThreshold ||
+          (perception.nextCollider() && Inf != perception.nextCollider()->getMass()))
+      {  // No collision danger.
+         Real const time = perception.getTime();
+         if (state[0] < 0 || time - state[0] > ControllerAvoid::delay)
+         {
+            run(n.children[0], slots, perception, action);
+            store(action, state + 1);
+            return;
+         }
+         // Just continue with last action.
+         load(state + 1, action);
+         return;
+      }
+      else
+      {
+         state[0] = perception.getTime();
+
+         // Collision danger present so need to take evasive action.
+         RealVec2 rp(perception.nextCollisionPoint().relativeTo(perception.myPosition()));
+         rp.normalize();
+         RealVec2 v(Util2D::perpendicularTo(rp, perception.nextCollider()->normalTo(*static_cast<Obstacle*>(perception.getMe()))));
+         TG_ASSERT(MathUtil::isAlmostZero(v.dot(rp)));
+
+         action.setDesiredDirection(v);
+         action.setDesiredSpeed(1);
+         store(action, state + 1);
+         return;
+      }
+
+   case periodicOp:
+   case periodicRampOp:
+   {
+      Real const time = perception.getTime();
+      Real period = n.parameters[0];
+      if (periodicRampOp == n.op)
+      {
+         Real const periodUnclamped = (Real(n.parameters[2])/n.parameters[0]) * (perception.*(n.distance))();
+         period = MathUtil::clamp(periodUnclamped, n.parameters[1], n.parameters[2]);
+      }
+
+      if (0 <= state[0] && time - state[0] < period)
+      {
+         load(state + 1, action);
+         return;
+      }
+      state[0] = time;
+      run(n.children[0], slots, perception, action);
+      store(action, state + 1);
+      return;
+   }
+
+   case randomizeOp:
+   {
+      Action a;
+      run(n.children[0], slots, perception, a);
+      Real const d((perception.*(n.distance))());
+      // Compute the distance as a fraction of "farDistance"
+      Real const dFrac(std::min(Real(1), d/n.parameters[0]));
+      Real const angle(Util2D::angle(a.getDesiredDirection()) + dFrac * Real(Random::current().uniform(360) - 180));
+      action.setDesiredDirection(Util2D::dir(angle));
+      action.setDesiredSpeed(a.getDesiredSpeed());
+      TG_ASSERT(0 < action.getDesiredSpeed());
+      return;
+   }
+
+   case evadeOp:
+   {
+      RealVec2 const& v(perception.directionFromTagged());
+      TG_ASSERT(!MathUtil::isAlmostZero(v.length()));
+      action.setDesiredSpeed(Real(1));
+      action.setDesiredDirection(v);
+      return;
+   }
+
+   case pursueOp:
+   {
+      action.setDesiredSpeed(1.0);
+      action.setDesiredDirection(Steering::pursue(perception.myPosition(), perception.nearestCharacterPosition()));
+      return;
+   }
+
+   case wanderOp:
+   {
+      RealVec2 direction(Util2D::dim);
+      Real speed;
+      Steering::wander(Random::current(), direction, speed);
+      action.setDesiredDirection(direction);
+      action.setDesiredSpeed(speed);
+      return;
+   }
+   }
+
+   Util::error("BehaviorProgram: unknown node type");
+}
@@ -0,0 +1,157 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_BEHAVIOR_PROGRAM_H
+#define TG_BEHAVIOR_PROGRAM_H
+
+#include "Controller.h"
+#include "Perception.h"
+#include "Util2D.h"
+
+namespace tagGame
+{
+   class BehaviorProgram;
+
+   typedef SharedPtr<BehaviorProgram>::type BehaviorProgramPtr;
+
+   /// A controller tree (see GameSetup::createNPCController) compiled into a
+   /// flat array of nodes, that can be shared by any number of characters.
+   /// A controller tree keeps its state (e.g. when it last made a decision)
+   /// in its controllers, so each character needs a tree of its own, and
+   /// selecting an action means following pointers and making virtual calls
+   /// all the way down the tree.  A program keeps the state for each of the
+   /// characters that run it (called instances) in one array, a few slots
+   /// per character, and the interpreter (run) just switches on each node's
+   /// type.  Running a program gives exactly the same actions as the tree
+   /// it was compiled from.
+   ///
+   /// Only the conditional, avoid, periodic, periodic ramp, randomize,
+   /// evade, pursue and wander controllers can be compiled.
+   class BehaviorProgram
+   {
+   public:
+      /// Compile the tree whose root is root.  The tree itself is left as
+      /// it is, and its controllers' current state is ignored.  All the
+      /// controllers in the tree must share the same perception object.
+      explicit BehaviorProgram(Controller& root);
+
+      /// Add an instance, whose state is as if the tree had just been made,
+      /// and return its index.  Not safe to call while the program is running.
+      /// The indices of removed instances are reused.
+      size_t addInstance();
+      /// Remove an instance, e.g. because its character has been removed
+      /// from the game.  Not safe to call while the program is running.
+      void removeInstance(size_t const instance);
+      inline size_t getInstanceCount() const;
+
+      /// Write the state of every instance to a snapshot, or read it back
+      /// (see Snapshot).
+      void save(Snapshot& snapshot) const;
+      void restore(Snapshot const& snapshot, size_t& offset);
+
+      /// The number of nodes, and of state slots per instance.
+      inline size_t getNodeCount() const;
+      inline size_t getSlotCount() const;
+
+      /// Select the action for instance, from the point of view of the
+      /// character currently set in perception (see Perception::setMe).
+      /// Different instances can be run in parallel.
+      void run(size_t const instance, Perception& perception, Action& action);
+
+   protected:
+   private:
+      enum Op
+      {
+         conditionalOp,
+         avoidOp,
+         periodicOp,
+         periodicRampOp,
+         randomizeOp,
+         evadeOp,
+         pursueOp,
+         wanderOp
+      };
+
+      struct Node
+      {
+         Op op;
+         // The node's children, as indices into nodes.
+         size_t children[2];
+         PerceptBool condition;
+         PerceptReal distance;
+         // The node's parameters, e.g. distances and periods.
+         Real parameters[3];
+         // Where the node's state starts in each instance's slots.
+         size_t slot;
+      };
+
+      // Add the nodes for the tree whose root is c, in pre-order, and
+      // return the index of the root's node.
+      size_t compile(Controller& c, PerceptionPtr perception);
+      // Add a node of type op, with slotCount slots of state.
+      size_t addNode(Op const op, size_t const slotCount);
+
+      void run(size_t const node, Real* slots, Perception& perception, Action& action) const;
+
+      // A node that keeps its last action stores it in three slots.
+      inline static void load(Real const* slots, Action& action);
+      inline static void store(Action const& action, Real* slots);
+
+      std::vector<Node> nodes;
+      // The initial state of an instance.
+      std::vector<Real> initialSlots;
+      // The state of every instance, one after another.
+      std::vector<Real> slots;
+      // Instances up to instanceCount have been added, but the free ones
+      // have been removed since.
+      size_t instanceCount;
+      std::vector<size_t> freeInstances;
+   };
+
+   size_t BehaviorProgram::getInstanceCount() const
+   {
+      return instanceCount - freeInstances.size();
+   }
+
+   size_t BehaviorProgram::getNodeCount() const
+   {
+      return nodes.size();
+   }
+
+   size_t BehaviorProgram::getSlotCount() const
+   {
+      return initialSlots.size();
+   }
+
+   void BehaviorProgram::load(Real const* slots, Action& action)
+   {
+      RealVec2 direction(Util2D::dim);
+      direction[0] = slots[0];
+      direction[1] = slots[1];
+      action.setDesiredDirection(direction);
+      action.setDesiredSpeed(slots[2]);
+   }
+
+   void BehaviorProgram::store(Action const& action, Real* slots)
+   {
+      slots[0] = action.getDesiredDirection()[0];
+      slots[1] = action.getDesiredDirection()[1];
+      slots[2] = action.getDesiredSpeed();
+   }
+}
+
+#endif
@@ -22,15 +22,15 @@ using namespace tagGame;
 
 Character::Character(ShapePtr shape, ControllerPtr controller) :
    Obstacle(shape),
-   controller(controller),
-   maxTurnRate(10.0),
-   maxSpeed(100.0),
-   maxForce(150.0),
-   // maxSpeed(50.0),
-   // maxForce(950.0),
-   tagTime(-1),
-   collideTime(-1)
+   controller(controller)
 {
+   store->getMaxTurnRates()[id] = 10.0;
+   store->getMaxSpeeds()[id] = 100.0;
+   store->getMaxForces()[id] = 150.0;
+   // store->getMaxSpeeds()[id] = 50.0;
+   // store->getMaxForces()[id] = 950.0;
+   store->getTagTimes()[id] = -1;
+   store->getCollideTimes()[id] = -1;
 }
 
 Character::~Character()
@@ -42,7 +42,7 @@ void Character::setTagged(int tagTime)
    // Important to update the perception object with the new information about who the
    // tagged character is.  Otherwise the information has to be calculated by looping
    // through all the characters, which is an unnecessarily inefficiency.
-   this->tagTime = tagTime;
+   store->getTagTimes()[id] = tagTime;
    if (0 <= tagTime)
    {  // NOTE: tagTime = -1 implies this character was tagged, but is no longer
       // TODO: make a separate untagged method
@@ -60,13 +60,9 @@ namespace tagGame
       /// Pointer to this character's (possibly shared) controller
       ControllerPtr controller;
       Action lastAction;
-      Real maxTurnRate;
-      Real maxSpeed;
-      Real maxForce;
-      // How long since this character was tagged (-1 if not currently tagged).
-      int tagTime;
-      // How long since this character collided with something (-1 if never collided).
-      int collideTime;
+      // The rest of the character's state is in its entity store, along with
+      // the tag time (-1 if not currently tagged) and the collide time (-1 if
+      // never collided).
    };
 
    typedef SharedPtr<Character>::type CharacterPtr;
@@ -89,28 +85,27 @@ namespace tagGame
 
    bool Character::getIsTagged() const
    {
-      return 0 <= tagTime;
+      return 0 <= getTaggedTime();
    }
    
    int Character::getTaggedTime() const
    {
-      return tagTime;
+      return store->getTagTimes()[id];
    }
    
    Real Character::getMaxTurnRate() const
    {
-      return maxTurnRate;
+      return store->getMaxTurnRates()[id];
    }
    
    Real Character::getMaxSpeed() const
    {
-      if (getIsTagged()) { return 0.8 * maxSpeed; }
-      return maxSpeed;
+      return store->getMaxSpeed(id);
    }
    
    Real Character::getMaxForce() const
    {
-      return maxForce;
+      return store->getMaxForces()[id];
    }
    
    ControllerPtr Character::getController()
@@ -125,12 +120,12 @@ namespace tagGame
    
    void Character::setCollideTime(int collideTime)
    {
-      this->collideTime = collideTime;
+      store->getCollideTimes()[id] = collideTime;
    }
    
    int Character::getCollideTime() const
    {
-      return collideTime;
+      return store->getCollideTimes()[id];
    }
 }
 
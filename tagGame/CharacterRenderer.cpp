@@ -43,8 +43,8 @@ void CharacterRenderer::render(Obstacle const* o)
 
    // return;
 
-   RealVec start(o->getPosition());
-   RealVec v(o->getOrientation());
+   RealVec2 start(o->getPosition());
+   RealVec2 v(o->getOrientation());
    v.scale(static_cast<Circle const&>(c->getShape()).getRadius());
 
    start.add(v);
@@ -18,15 +18,24 @@
 #include "Circle.h"
 #include "Side.h"
 #include "Util2D.h"
+#include "Narrowphase.h"
 
 using namespace tagGame;
 
 using namespace std;
 
 Circle::Circle() :
-   Shape(),
-   radius(10.0)
+   Shape()
 {
+   getStore()->getShapeKinds()[getId()] = EntityStore::circleShape;
+   setRadius(10.0);
+}
+
+Circle::Circle(EntityStore* store, size_t const id) :
+   Shape(store, id)
+{
+   getStore()->getShapeKinds()[getId()] = EntityStore::circleShape;
+   setRadius(10.0);
 }
 
 ostream& Circle::output(ostream& out) const
@@ -37,6 +46,17 @@ ostream& Circle::output(ostream& out) const
    return out;
 }
 
+bool Circle::getBounds(RealVec2& lower, RealVec2& upper) const
+{
+   RealVec2 r(Util2D::dim);
+   r.set(getRadius());
+   lower = getPosition().relativeTo(r);
+   upper = getPosition();
+   upper.add(r);
+
+   return true;
+}
+
 Real Circle::distanceTo(Shape const& o) const
 {
    return o.distanceTo(*this);
@@ -44,7 +64,7 @@ Real Circle::distanceTo(Shape const& o) const
 
 Real Circle::distanceTo(Circle const& c) const
 {
-   return (getPosition().relativeTo(c.getPosition())).length() - getRadius() - c.getRadius();
+   return Narrowphase::circleDistance(getPosition(), getRadius(), c.getPosition(), c.getRadius());
 }
 
 Real Circle::distanceTo(Side const& s) const
@@ -52,39 +72,84 @@ Real Circle::distanceTo(Side const& s) const
    return s.distanceTo(*this);
 }
 
+Real Circle::timeToImpact(Shape const& o, RealVec2 const& v, Real& leave) const
+{
+   // o moves with velocity -v relative to this.
+   RealVec2 u(v);
+   return o.timeToImpact(*this, u.scale(-1), leave);
+}
+
+Real Circle::timeToImpact(Circle const& c, RealVec2 const& v, Real& leave) const
+{
+   // The circles touch when |p + v t| <= r, so solve the quadratic
+   // a t^2 + 2 b t + k = 0 for when they start and stop touching.
+   RealVec2 const p(getPosition().relativeTo(c.getPosition()));
+   Real const r = getRadius() + c.getRadius();
+   Real const a = v.squaredLength();
+   Real const b = p.dot(v);
+   Real const k = p.squaredLength() - r * r;
+
+   leave = Inf;
+
+   if (MathUtil::isAlmostZero(a))
+   {
+      // Not moving relative to each other.
+      return k <= 0 ? Real(0) : Inf;
+   }
+
+   Real const d = b * b - a * k;
+   if (d < 0) { return Inf; } // Never close enough to touch.
+
+   Real const dSqrt = sqrt(d);
+   Real const enter = (-b - dSqrt) / a;
+   Real const exit = (-b + dSqrt) / a;
+   if (exit < 0) { return Inf; } // Already moved apart.
+
+   leave = exit;
+   return std::max(Real(0), enter);
+}
+
+Real Circle::timeToImpact(Side const& s, RealVec2 const& v, Real& leave) const
+{
+   RealVec2 u(v);
+   return s.timeToImpact(*this, u.scale(-1), leave);
+}
+
 // TODO: What we really want is the future intersection point of
 // another circle.  This could be done by temporarily adding the other
 // circle's radius to this and intersecting with a line as below.
 // Then projecting the intersection point back onto this.  An
 // analogous trick could be done when intersecting with a side object.
-RealVec Circle::nearestIntersection(RealVec const& p, RealVec const& v) const
+RealVec2 Circle::nearestIntersection(RealVec2 const& p, RealVec2 const& v) const
 {
    TG_ASSERT(MathUtil::isAlmostEq(v.length(), 1));
 
-   RealVec const rp = p.relativeTo(getPosition());
+   RealVec2 const rp = p.relativeTo(getPosition());
    Real const k0 = rp.squaredLength() - getRadius() * getRadius();
    Real const k1 = v.dot(rp);
 
-   vector<Real> roots;
+   // At most two roots, so no need for a (heap allocated) vector.
+   Real roots[2];
+   size_t rootCount = 0;
    Real const k = k1 * k1 - k0;
    if (MathUtil::isAlmostZero(k))
    {
-      roots.push_back(-k1);
+      roots[rootCount++] = -k1;
    }
    else if (0 < k)
    {
       Real const kSqrt = sqrt(k);
-      roots.push_back(-k1 - kSqrt);
-      roots.push_back(-k1 + kSqrt);
+      roots[rootCount++] = -k1 - kSqrt;
+      roots[rootCount++] = -k1 + kSqrt;
       TG_ASSERT(roots[0] < roots[1]);
    }
 
-   RealVec q(Util2D::dim);
+   RealVec2 q(Util2D::dim);
    // This code assumes 2D.
    TG_ASSERT(2 == Util2D::dim);
    q.set(Inf);
 
-   for (size_t i = 0; i < roots.size(); i++)
+   for (size_t i = 0; i < rootCount; i++)
    {
       if (MathUtil::isAlmostZero(roots[i]) || 0 < roots[i])
       {
@@ -98,13 +163,13 @@ RealVec Circle::nearestIntersection(RealVec const& p, RealVec const& v) const
    return q;
 }
 
-RealVec Circle::normalTo(Shape const& o) const
+RealVec2 Circle::normalTo(Shape const& o) const
 {
    return o.normalTo(static_cast<Circle const&>(*this)).scale(-1);
 }
 
-RealVec Circle::normalTo(Circle const& c) const
+RealVec2 Circle::normalTo(Circle const& c) const
 {
-   return (c.getPosition().relativeTo(getPosition())).normalize();
+   return Narrowphase::circleNormal(getPosition(), c.getPosition());
 }
 
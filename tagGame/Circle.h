@@ -27,34 +27,41 @@ namespace tagGame
    {
    public:
       Circle();
+      /// A circle that is entity id of store (see Shape).
+      Circle(EntityStore* store, size_t const id);
 
       virtual std::ostream& output(std::ostream& out) const;
 
       inline Real getRadius() const;
       inline void setRadius(Real const radius);
 
-      virtual RealVec nearestIntersection(RealVec const& p, RealVec const& v) const;
+      virtual bool getBounds(RealVec2& lower, RealVec2& upper) const;
 
-      virtual RealVec normalTo(Shape const& o) const;
-      virtual RealVec normalTo(Circle const& c) const;
+      virtual RealVec2 nearestIntersection(RealVec2 const& p, RealVec2 const& v) const;
+
+      virtual RealVec2 normalTo(Shape const& o) const;
+      virtual RealVec2 normalTo(Circle const& c) const;
 
       virtual Real distanceTo(Shape const& o) const;
       virtual Real distanceTo(Circle const& c) const;
       virtual Real distanceTo(Side const& s) const;
 
+      virtual Real timeToImpact(Shape const& o, RealVec2 const& v, Real& leave) const;
+      virtual Real timeToImpact(Circle const& c, RealVec2 const& v, Real& leave) const;
+      virtual Real timeToImpact(Side const& s, RealVec2 const& v, Real& leave) const;
+
    protected:
    private:
-      Real radius;
    };
 
    Real Circle::getRadius() const
    {
-      return radius;
+      return getStore()->getRadii()[getId()];
    }
    
    void Circle::setRadius(Real const radius)
    {
-      this->radius = radius;
+      getStore()->getRadii()[getId()] = radius;
    }
 }
 
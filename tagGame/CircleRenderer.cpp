@@ -35,8 +35,8 @@ void CircleRenderer::render(Obstacle const* o)
 {
    RendererColor::render(o);
 
-   RealVec const& p(o->getPosition());
-   RealVec const& v(o->getOrientation());
+   RealVec2 const& p(o->getPosition());
+   RealVec2 const& v(o->getOrientation());
    Real const r = static_cast<Circle const&>(o->getShape()).getRadius();
 
    Gui::drawCircle(p, v, r);
@@ -27,6 +27,10 @@
 
 using namespace tagGame;
 
+// TODO: could pass these in as parameters
+Real const ControllerAvoid::soonThreshold = Real(50);
+Real const ControllerAvoid::delay = 0.5;
+
 ControllerAvoid::ControllerAvoid(PerceptionPtr perception, ControllerPtr defaultController) :
    Controller(perception),
    defaultController(defaultController),
@@ -40,9 +44,6 @@ ControllerAvoid::~ControllerAvoid()
 
 void ControllerAvoid::calcAction()
 {
-   // TODO: could pass this is as a parameter
-   Real const soonThreshold = Real(50);
-
    // TODO: re-factor so that we have a timedEventController.  Then
    // get rid of this "if" and wrap the two controllers in the
    // timedEventController.
@@ -56,7 +57,7 @@ void ControllerAvoid::calcAction()
    {
       Gui::setColor(Gui::getColorFromName("yellow"));
    }
-   RealVec rp1(perception->nextCollisionPoint().relativeTo(perception->myPosition()));
+   RealVec2 rp1(perception->nextCollisionPoint().relativeTo(perception->myPosition()));
    rp1.normalize();
    rp1.scale(perception->timeToCollision());
    rp1.add(perception->myPosition());
@@ -70,9 +71,6 @@ void ControllerAvoid::calcAction()
    if (perception->timeToCollision() > soonThreshold || (perception->nextCollider() && Inf != perception->nextCollider()->getMass()))
    {  // No collision danger.
       Real const time = perception->getTime();
-      // How many milliseconds to wait after a potential collision was detected before
-      // resuming with the default controller.  TODO: consider making a settable class variable.
-      Real const delay = 0.5;
       if (timeLastCollisionDetected < 0 || time - timeLastCollisionDetected > delay)
       {
          defaultController->calcAction();
@@ -90,30 +88,30 @@ void ControllerAvoid::calcAction()
    timeLastCollisionDetected = perception->getTime();
 
    // Collision danger present so need to take evasive action.
-   // RealVec rp(perception->nextCollisionPoint().relativeTo(perception->myPosition()));
-   RealVec rp(perception->nextCollisionPoint().relativeTo(perception->myPosition()));
+   // RealVec2 rp(perception->nextCollisionPoint().relativeTo(perception->myPosition()));
+   RealVec2 rp(perception->nextCollisionPoint().relativeTo(perception->myPosition()));
    rp.normalize();
 
-   RealVec v(Util2D::perpendicularTo(rp, perception->nextCollider()->normalTo(*static_cast<Obstacle*>(perception->getMe()))));
+   RealVec2 v(Util2D::perpendicularTo(rp, perception->nextCollider()->normalTo(*static_cast<Obstacle*>(perception->getMe()))));
 
 #if 0
    // TODO: get rid of this dynamic_cast
    ObstacleSide* sPtr(dynamic_cast<ObstacleSide*>(perception->nextCollider()));
    if (sPtr)
    {
-      RealVec const n(sPtr->normalTo(*static_cast<Obstacle*>(perception->getMe())));
-      RealVec const b(sPtr->getBegin());
-      RealVec const e(sPtr->getEnd());
+      RealVec2 const n(sPtr->normalTo(*static_cast<Obstacle*>(perception->getMe())));
+      RealVec2 const b(sPtr->getBegin());
+      RealVec2 const e(sPtr->getEnd());
       Real const db = b.relativeTo(perception->myPosition()).length();
       Real const de = e.relativeTo(perception->myPosition()).length();
-      RealVec const b1(db < de ? b : e);
-      RealVec const e1(db < de ? e : b);
-      RealVec u(e1.relativeTo(b1));
+      RealVec2 const b1(db < de ? b : e);
+      RealVec2 const e1(db < de ? e : b);
+      RealVec2 u(e1.relativeTo(b1));
       Real const alpha = perception->nextCollisionPoint().relativeTo(b1).length()/u.length();
-      RealVec const n1(u.scale(alpha).add(n.scale(1.0-alpha)));
+      RealVec2 const n1(u.scale(alpha).add(n.scale(1.0-alpha)));
       // TODO: there are 2 perpendicular directions, use one closest to obstacle's normal
       v = Util2D::perpendicularTo(rp, n1.normalize());
-      // RealVec v(Util2D::perpendicularTo(rp, perception->nextCollider()->normalTo(*static_cast<Obstacle*>(perception->getMe()))));
+      // RealVec2 v(Util2D::perpendicularTo(rp, perception->nextCollider()->normalTo(*static_cast<Obstacle*>(perception->getMe()))));
    }
 #endif
    TG_ASSERT(MathUtil::isAlmostZero(v.dot(rp)));
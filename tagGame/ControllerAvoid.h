@@ -31,11 +31,24 @@ namespace tagGame
 
       virtual void calcAction();
 
+      inline ControllerPtr getDefaultController() const;
+
+      /// Collisions less than this far away need avoiding.
+      static Real const soonThreshold;
+      /// How long (in seconds) to wait after a potential collision was
+      /// detected before resuming with the default controller.
+      static Real const delay;
+
    protected:
    private:
       ControllerPtr defaultController;
       Real timeLastCollisionDetected;
    };
+
+   ControllerPtr ControllerAvoid::getDefaultController() const
+   {
+      return defaultController;
+   }
 }
 
 #endif
@@ -36,7 +36,7 @@ ControllerEvade::~ControllerEvade()
 // with a percept like the conditional controller.
 void ControllerEvade::calcAction()
 {
-   RealVec v(perception->myPosition().relativeTo(perception->taggedPosition()));
+   RealVec2 const& v(perception->directionFromTagged());
 
    // Following assert would fail if I am tagged character, i.e. can't evade myself!
    // TODO: necessary?
@@ -46,5 +46,5 @@ void ControllerEvade::calcAction()
    // that speed increases as tagged character gets closer
    // std::max(Real(0), std::min(Real(1), Real(1) - (Real(0.25)*tagDist)/tagFar));
    action.setDesiredSpeed(Real(1));
-   action.setDesiredDirection(v.normalize());
+   action.setDesiredDirection(v);
 }
@@ -0,0 +1,262 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#include "ControllerLookahead.h"
+#include "ControllerProgram.h"
+#include "Perception.h"
+#include "Simulator.h"
+#include "Circle.h"
+#include "Side.h"
+#include "Timer.h"
+#include "Util2D.h"
+
+#include <cmath>
+
+using namespace tagGame;
+
+using namespace std;
+
+namespace
+{
+   // Keeps doing whatever action it was last given.
+   class ControllerHold : public Controller
+   {
+   public:
+      ControllerHold(PerceptionPtr perception) :
+         Controller(perception)
+      {
+      }
+
+      virtual void calcAction()
+      {
+      }
+   };
+}
+
+// A copy of the world to run rollouts in, with the same characters and
+// obstacles, in the same order.
+class ControllerLookahead::Replica
+{
+public:
+   Replica(GameState& world, BehaviorProgramPtr worldProgram) :
+      gs(world.getWorldDim(), world.getSeed()),
+      sim(&gs),
+      perception(new Perception(&gs)),
+      program(new BehaviorProgram(*worldProgram)),
+      held(world.getCharacterListEnd() - world.getCharacterListBegin())
+   {
+      for (CharacterIterator i = world.getCharacterListBegin(); i != world.getCharacterListEnd(); i++)
+      {
+         ControllerProgram* const p = dynamic_cast<ControllerProgram*>(&*(*i)->getController());
+         ControllerPtr controller;
+         if (p && p->getProgram() == worldProgram)
+         {
+            controller = ControllerPtr(new ControllerProgram(perception, program, p->getInstance()));
+         }
+         else
+         {
+            controller = ControllerPtr(new ControllerHold(perception));
+            held[i - world.getCharacterListBegin()] = controller;
+         }
+         gs.addCharacter(CharacterPtr(new Character(CirclePtr(new Circle()), controller)));
+      }
+
+      // Everything but the kind of shape comes from the snapshot (except for
+      // the ends of sides, which are only used for drawing).
+      for (ObstacleIterator i = world.getNonCharacterObstacleListBegin(); i != world.getNonCharacterObstacleListEnd(); i++)
+      {
+         Side const* const s = dynamic_cast<Side const*>(&(*i)->getShape());
+         ShapePtr shape;
+         if (s)
+         {
+            SidePtr side(new Side());
+            side->setBegin(s->getBegin());
+            side->setEnd(s->getEnd());
+            shape = side;
+         }
+         else
+         {
+            shape = CirclePtr(new Circle());
+         }
+         gs.addObstacle(ObstaclePtr(new Obstacle(shape)));
+      }
+   }
+
+   GameState gs;
+   Simulator sim;
+   PerceptionPtr perception;
+   BehaviorProgramPtr program;
+   // The controllers of the characters that don't run the program, by id.
+   std::vector<ControllerPtr> held;
+};
+
+// Runs the rollouts for a range of candidates.
+class ControllerLookahead::RolloutJob : public ThreadPool::Job
+{
+public:
+   RolloutJob(ControllerLookahead& controller) :
+      controller(controller)
+   {
+   }
+
+   virtual void run(size_t const begin, size_t const end, size_t const worker)
+   {
+      for (size_t i = begin; i < end; i++)
+      {
+         if (0 < controller.budget && controller.deadline < Timer::preciseTime()) { return; }
+         controller.rollout(i, *controller.workers->replicas[worker]);
+      }
+   }
+
+private:
+   ControllerLookahead& controller;
+};
+
+Real const ControllerLookahead::stepLength = Real(0.1);
+
+ControllerLookahead::Workers::Workers(BehaviorProgramPtr program, size_t const threadCount) :
+   program(program),
+   pool(threadCount),
+   changeCount(-1)
+{
+}
+
+ControllerLookahead::Workers::~Workers()
+{
+   for (size_t i = 0; i < replicas.size(); i++)
+   {
+      delete replicas[i];
+   }
+}
+
+void ControllerLookahead::Workers::update(GameState& gs)
+{
+   if (!replicas.empty() && changeCount == gs.getChangeCount()) { return; }
+
+   for (size_t i = 0; i < replicas.size(); i++)
+   {
+      delete replicas[i];
+   }
+   replicas.resize(pool.getThreadCount());
+   for (size_t i = 0; i < replicas.size(); i++)
+   {
+      replicas[i] = new Replica(gs, program);
+   }
+   changeCount = gs.getChangeCount();
+}
+
+ControllerLookahead::ControllerLookahead(PerceptionPtr perception, WorkersPtr workers,
+                                         size_t const candidateCount, Real const horizon, Real const period) :
+   Controller(perception),
+   workers(workers),
+   candidateCount(candidateCount),
+   horizon(horizon),
+   period(period),
+   budget(0),
+   timeOfLastDecision(-1),
+   me(0),
+   wasTagged(false),
+   deadline(0)
+{
+   TG_ASSERT(0 < candidateCount && 0 < horizon);
+
+   for (size_t i = 0; i < candidateCount; i++)
+   {
+      Action a;
+      a.setDesiredDirection(Util2D::dir(Real(360) * Real(i)/Real(candidateCount) - Real(180)));
+      a.setDesiredSpeed(Real(1));
+      candidates.push_back(a);
+   }
+}
+
+ControllerLookahead::~ControllerLookahead()
+{
+}
+
+void ControllerLookahead::calcAction()
+{
+   Real const time = perception->getTime();
+   if (0 <= timeOfLastDecision && time - timeOfLastDecision < period) { return; }
+   timeOfLastDecision = time;
+
+   GameState& gs(*perception->getGameState());
+   workers->update(gs);
+
+   snapshot.capture(gs, *perception, &*workers->program);
+   me = perception->getMe()->getId();
+   wasTagged = perception->myselfTagged();
+   lastActions.resize(gs.getCharacterListEnd() - gs.getCharacterListBegin());
+   for (size_t i = 0; i < lastActions.size(); i++)
+   {
+      lastActions[i] = gs.getCharacterListBegin()[i]->getAction();
+   }
+
+   scores.assign(candidateCount, -Inf);
+   deadline = Timer::preciseTime() + budget;
+   RolloutJob job(*this);
+   workers->pool.run(job, candidateCount);
+
+   // Ties go to the first, and if everything is hopeless, carry on as before.
+   size_t best = candidateCount;
+   for (size_t i = 0; i < candidateCount; i++)
+   {
+      if (-Inf < scores[i] && (candidateCount == best || scores[best] < scores[i])) { best = i; }
+   }
+   if (best < candidateCount) { action = candidates[best]; }
+}
+
+void ControllerLookahead::rollout(size_t const candidate, Replica& replica)
+{
+   snapshot.restore(replica.gs, *replica.perception, &*replica.program);
+   for (size_t i = 0; i < replica.held.size(); i++)
+   {
+      if (replica.held[i]) { replica.held[i]->setAction(lastActions[i]); }
+   }
+   TG_ASSERT(replica.held[me]);
+   replica.held[me]->setAction(candidates[candidate]);
+
+   int const stepCount = max(1, MathUtil::round(horizon/stepLength));
+   for (int i = 0; i < stepCount; i++)
+   {
+      replica.gs.incFrame();
+      replica.sim.forward(stepLength);
+   }
+
+   scores[candidate] = score(replica);
+}
+
+Real ControllerLookahead::score(Replica& replica) const
+{
+   CharacterIterator const characters(replica.gs.getCharacterListBegin());
+   Character const& c(*characters[me]);
+   Character const* const tagged = replica.perception->getTagged();
+   TG_ASSERT(tagged);
+
+   if (!wasTagged)
+   {
+      return tagged == &c ? -Inf : c.distanceTo(*tagged);
+   }
+
+   if (tagged != &c) { return Inf; }
+
+   Real nearest = Inf;
+   for (CharacterIterator i = characters; i != replica.gs.getCharacterListEnd(); i++)
+   {
+      if (&**i != &c) { nearest = min(nearest, c.distanceTo(**i)); }
+   }
+   return -nearest;
+}
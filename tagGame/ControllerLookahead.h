@@ -0,0 +1,166 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_CONTROLLERLOOKAHEAD_H
+#define TG_CONTROLLERLOOKAHEAD_H
+
+#include "Controller.h"
+#include "BehaviorProgram.h"
+#include "Snapshot.h"
+#include "ThreadPool.h"
+
+namespace tagGame
+{
+   /// Controller that looks ahead before it decides which way to go.  Every
+   /// period seconds, it tries each of candidateCount directions (evenly
+   /// spaced around the circle, at full speed) by simulating the next
+   /// horizon seconds of the world with the real simulator, and picks the
+   /// direction with the best outcome.  If I'm tagged, the best outcome is
+   /// tagging someone, or else ending up as close as possible to the
+   /// nearest character.  Otherwise, it is ending up as far as possible
+   /// from the tagged character, without being tagged.
+   ///
+   /// The simulations (rollouts) are run in parallel by a set of workers
+   /// (see Workers): a pool of threads, each with a replica of the world,
+   /// which the world is copied into with a snapshot before each rollout
+   /// (see Snapshot).  In a replica, the characters that run the workers'
+   /// program (see GameSetup::setupCharacters) carry on running it from
+   /// their current state, and any others (including other lookahead
+   /// characters) keep doing what they did last.  Only one character
+   /// decides at a time, so all the lookahead controllers in a world should
+   /// share one set of workers.
+   ///
+   /// If a budget is set, no more rollouts are started once it has run out,
+   /// and the directions that weren't tried are ignored.  That makes the
+   /// choice depend on how fast the computer is, so without a budget a run
+   /// is the same whatever the number of threads.
+   ///
+   /// While it decides, the controller reads the state of the whole world,
+   /// so the simulator it is run by must only have one thread.
+   class ControllerLookahead : public Controller
+   {
+   private:
+      class Replica;
+
+   public:
+      /// The threads and replicas of the world that rollouts are run on.
+      /// The replicas are built the first time they are needed, and rebuilt
+      /// whenever characters or obstacles are added to or removed from the
+      /// world.
+      class Workers
+      {
+      public:
+         /// threadCount threads (0 for one per processor), for a world whose
+         /// NPCs run program.
+         explicit Workers(BehaviorProgramPtr program, size_t const threadCount = 1);
+         ~Workers();
+
+         inline size_t getThreadCount() const;
+         inline BehaviorProgramPtr getProgram() const;
+
+      private:
+         friend class ControllerLookahead;
+
+         // Not copyable.
+         Workers(Workers const&);
+         Workers& operator=(Workers const&);
+
+         void update(GameState& gs);
+
+         BehaviorProgramPtr program;
+         ThreadPool pool;
+         // One replica of the world per thread, and the change count of the
+         // world when they were built (see GameState::getChangeCount).
+         std::vector<Replica*> replicas;
+         int changeCount;
+      };
+
+      typedef SharedPtr<Workers>::type WorkersPtr;
+
+      ControllerLookahead(PerceptionPtr perception, WorkersPtr workers,
+                          size_t const candidateCount = 8, Real const horizon = 1, Real const period = 0.5);
+      virtual ~ControllerLookahead();
+
+      virtual void calcAction();
+
+      /// Wall clock time (in seconds) allowed per decision, or 0 for no limit.
+      inline Real getBudget() const;
+      inline void setBudget(Real const budget);
+
+      /// How each direction scored in the last decision (higher is better),
+      /// or -Inf if it wasn't tried, or it led to me being tagged.
+      inline std::vector<Real> const& getScores() const;
+
+      /// The length (in seconds) of a step of a rollout.
+      static Real const stepLength;
+
+   protected:
+   private:
+      class RolloutJob;
+      friend class RolloutJob;
+
+      void rollout(size_t const candidate, Replica& replica);
+      Real score(Replica& replica) const;
+
+      WorkersPtr workers;
+      size_t candidateCount;
+      Real horizon;
+      Real period;
+      Real budget;
+      Real timeOfLastDecision;
+
+      // The state of the world when the decision is being made.
+      Snapshot snapshot;
+      // Who I am, whether I was tagged, and what the characters that don't
+      // run program did last.
+      size_t me;
+      bool wasTagged;
+      std::vector<Action> lastActions;
+      Real deadline;
+
+      std::vector<Action> candidates;
+      std::vector<Real> scores;
+   };
+
+   size_t ControllerLookahead::Workers::getThreadCount() const
+   {
+      return pool.getThreadCount();
+   }
+
+   BehaviorProgramPtr ControllerLookahead::Workers::getProgram() const
+   {
+      return program;
+   }
+
+   Real ControllerLookahead::getBudget() const
+   {
+      return budget;
+   }
+
+   void ControllerLookahead::setBudget(Real const budget)
+   {
+      TG_ASSERT(0 <= budget);
+      this->budget = budget;
+   }
+
+   std::vector<Real> const& ControllerLookahead::getScores() const
+   {
+      return scores;
+   }
+}
+
+#endif
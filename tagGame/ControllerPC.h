@@ -60,7 +60,7 @@ namespace tagGame
    template<class T>
    void ControllerPC<T>::calcAction()
    {
-      RealVec v(Util2D::dim);
+      RealVec2 v(Util2D::dim);
       v[0] = joystick.getX();
       v[1] = joystick.getY();
    
@@ -0,0 +1,45 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#include "ControllerProgram.h"
+#include "Perception.h"
+
+using namespace tagGame;
+
+ControllerProgram::ControllerProgram(PerceptionPtr perception, BehaviorProgramPtr program) :
+   Controller(perception),
+   program(program),
+   instance(program->addInstance())
+{
+}
+
+ControllerProgram::ControllerProgram(PerceptionPtr perception, BehaviorProgramPtr program, size_t const instance) :
+   Controller(perception),
+   program(program),
+   instance(instance)
+{
+}
+
+ControllerProgram::~ControllerProgram()
+{
+   program->removeInstance(instance);
+}
+
+void ControllerProgram::calcAction()
+{
+   program->run(instance, *perception, action);
+}
@@ -0,0 +1,63 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_CONTROLLERPROGRAM_H
+#define TG_CONTROLLERPROGRAM_H
+
+#include "Controller.h"
+#include "BehaviorProgram.h"
+
+namespace tagGame
+{
+   /// Controller that runs a compiled behavior program (see BehaviorProgram).
+   /// Each character has its own instance of the program, but the program
+   /// itself can be shared.
+   class ControllerProgram : public Controller
+   {
+   public:
+      /// Adds a new instance to program, which is removed again when the
+      /// controller is destroyed.
+      ControllerProgram(PerceptionPtr perception, BehaviorProgramPtr program);
+      /// Runs an instance that is already in program, e.g. in a copy of the
+      /// program that some other controller added it to.  It is still
+      /// removed when the controller is destroyed.
+      ControllerProgram(PerceptionPtr perception, BehaviorProgramPtr program, size_t const instance);
+      virtual ~ControllerProgram();
+
+      virtual void calcAction();
+
+      inline BehaviorProgramPtr getProgram() const;
+      inline size_t getInstance() const;
+
+   protected:
+   private:
+      BehaviorProgramPtr program;
+      size_t instance;
+   };
+
+   BehaviorProgramPtr ControllerProgram::getProgram() const
+   {
+      return program;
+   }
+
+   size_t ControllerProgram::getInstance() const
+   {
+      return instance;
+   }
+}
+
+#endif
@@ -19,6 +19,7 @@
 #include "Perception.h"
 #include "Timer.h"
 #include "Util2D.h"
+#include "Steering.h"
 
 using namespace tagGame;
 
@@ -37,13 +38,11 @@ ControllerPursue::~ControllerPursue()
 void ControllerPursue::calcAction()
 {
    // Currently always chases nearest, TODO: take anger into account
-   RealVec v(perception->nearestCharacterPosition().relativeTo(perception->myPosition()));
-
    // go as fast as possible all the time!
-   // TODO: consider predicating speed on v.length()
+   // TODO: consider predicating speed on distance
    action.setDesiredSpeed(1.0); 
 
-   action.setDesiredDirection(v.normalize());
+   action.setDesiredDirection(Steering::pursue(perception->myPosition(), perception->nearestCharacterPosition()));
 }
 
 Character* ControllerPursue::calcWhoToChase()
@@ -17,6 +17,7 @@
 
 #include "ControllerRandomize.h"
 #include "Util2D.h"
+#include "Random.h"
 
 using namespace tagGame;
 
@@ -47,7 +48,7 @@ void ControllerRandomize::calcAction()
    // Compute the distance as a fraction of "farDistance"
    Real const dFrac(std::min(Real(1), d/farDistance));
 
-   Real const angle(Util2D::angle(a.getDesiredDirection()) + dFrac * Real(MathUtil::uniform(360) - 180));
+   Real const angle(Util2D::angle(a.getDesiredDirection()) + dFrac * Real(Random::current().uniform(360) - 180));
    action.setDesiredDirection(Util2D::dir(angle));
 
 #if 0
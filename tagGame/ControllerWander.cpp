@@ -18,6 +18,8 @@
 #include "ControllerWander.h"
 #include "Perception.h"
 #include "Util2D.h"
+#include "Random.h"
+#include "Steering.h"
 
 using namespace tagGame;
 
@@ -32,8 +34,11 @@ ControllerWander::~ControllerWander()
 
 void ControllerWander::calcAction()
 {
-   action.setDesiredDirection(Util2D::uniformDir());
-   // Speed is clamped to at least 0.25 because slow movement is boring!
-   action.setDesiredSpeed(MathUtil::clamp(MathUtil::uniform01(), 0.25, 1));
+   // Draws from the character's own stream (see Simulator::generateActions).
+   RealVec2 direction(Util2D::dim);
+   Real speed;
+   Steering::wander(Random::current(), direction, speed);
+   action.setDesiredDirection(direction);
+   action.setDesiredSpeed(speed);
 }
 
@@ -0,0 +1,175 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+
+#include "EntityStore.h"
+#include "Util2D.h"
+
+using namespace tagGame;
+
+using namespace std;
+
+EntityStore::EntityStore()
+{
+}
+
+size_t EntityStore::add()
+{
+   RealVec2 orientation(Util2D::dim);
+   orientation[0] = 1;
+
+   positions.push_back(RealVec2(Util2D::dim));
+   orientations.push_back(orientation);
+   speeds.push_back(0);
+   masses.push_back(Inf); // By default objects are too heavy to move
+   radii.push_back(0);
+   shapeKinds.push_back(noShape);
+   handles.push_back(Handle());
+
+   maxTurnRates.push_back(0);
+   maxSpeeds.push_back(0);
+   maxForces.push_back(0);
+   tagTimes.push_back(-1);
+   collideTimes.push_back(-1);
+   randoms.push_back(Random());
+
+   return size() - 1;
+}
+
+size_t EntityStore::add(size_t const count)
+{
+   size_t const first = size();
+   size_t const n = first + count;
+
+   RealVec2 orientation(Util2D::dim);
+   orientation[0] = 1;
+
+   // The same defaults as add().
+   positions.resize(n, RealVec2(Util2D::dim));
+   orientations.resize(n, orientation);
+   speeds.resize(n, 0);
+   masses.resize(n, Inf);
+   radii.resize(n, 0);
+   shapeKinds.resize(n, noShape);
+   handles.resize(n, Handle());
+
+   maxTurnRates.resize(n, 0);
+   maxSpeeds.resize(n, 0);
+   maxForces.resize(n, 0);
+   tagTimes.resize(n, -1);
+   collideTimes.resize(n, -1);
+   randoms.resize(n, Random());
+
+   return first;
+}
+
+size_t EntityStore::add(EntityStore const& store, size_t const id)
+{
+   TG_ASSERT(id < store.size());
+
+   positions.push_back(store.positions[id]);
+   orientations.push_back(store.orientations[id]);
+   speeds.push_back(store.speeds[id]);
+   masses.push_back(store.masses[id]);
+   radii.push_back(store.radii[id]);
+   shapeKinds.push_back(store.shapeKinds[id]);
+   handles.push_back(store.handles[id]);
+
+   maxTurnRates.push_back(store.maxTurnRates[id]);
+   maxSpeeds.push_back(store.maxSpeeds[id]);
+   maxForces.push_back(store.maxForces[id]);
+   tagTimes.push_back(store.tagTimes[id]);
+   collideTimes.push_back(store.collideTimes[id]);
+   randoms.push_back(store.randoms[id]);
+
+   return size() - 1;
+}
+
+// Move the last element of v into v[id], and drop the last element.
+template<class T>
+static void removeSwap(vector<T>& v, size_t const id)
+{
+   v[id] = v.back();
+   v.pop_back();
+}
+
+void EntityStore::remove(size_t const id)
+{
+   TG_ASSERT(id < size());
+
+   removeSwap(positions, id);
+   removeSwap(orientations, id);
+   removeSwap(speeds, id);
+   removeSwap(masses, id);
+   removeSwap(radii, id);
+   removeSwap(shapeKinds, id);
+   removeSwap(handles, id);
+
+   removeSwap(maxTurnRates, id);
+   removeSwap(maxSpeeds, id);
+   removeSwap(maxForces, id);
+   removeSwap(tagTimes, id);
+   removeSwap(collideTimes, id);
+   removeSwap(randoms, id);
+}
+
+void EntityStore::save(Snapshot& snapshot) const
+{
+   // The kinds of shapes first, so they can be checked before anything is
+   // restored.
+   snapshot.writeArray(shapeKinds);
+   snapshot.writeArray(positions);
+   snapshot.writeArray(orientations);
+   snapshot.writeArray(speeds);
+   snapshot.writeArray(masses);
+   snapshot.writeArray(radii);
+   snapshot.writeArray(handles);
+
+   snapshot.writeArray(maxTurnRates);
+   snapshot.writeArray(maxSpeeds);
+   snapshot.writeArray(maxForces);
+   snapshot.writeArray(tagTimes);
+   snapshot.writeArray(collideTimes);
+   snapshot.writeArray(randoms);
+}
+
+void EntityStore::restore(Snapshot const& snapshot, size_t& offset)
+{
+   // The shapes themselves aren't in the snapshot, so the store's entities
+   // have to have the same kinds of shapes as the snapshot's.
+   if (!snapshot.isArrayEqual(offset, shapeKinds))
+   {
+      Util::error("EntityStore: can't restore a snapshot with different kinds of shapes");
+   }
+   // Every column has one element per entity, so they stay in step with the
+   // game-state's lists of characters and obstacles.
+   size_t const n = size();
+   snapshot.readArray(offset, shapeKinds, n);
+   snapshot.readArray(offset, positions, n);
+   snapshot.readArray(offset, orientations, n);
+   snapshot.readArray(offset, speeds, n);
+   snapshot.readArray(offset, masses, n);
+   snapshot.readArray(offset, radii, n);
+   snapshot.readArray(offset, handles, n);
+
+   snapshot.readArray(offset, maxTurnRates, n);
+   snapshot.readArray(offset, maxSpeeds, n);
+   snapshot.readArray(offset, maxForces, n);
+   snapshot.readArray(offset, tagTimes, n);
+   snapshot.readArray(offset, collideTimes, n);
+   snapshot.readArray(offset, randoms, n);
+}
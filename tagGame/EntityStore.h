@@ -0,0 +1,293 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_ENTITY_STORE_H
+#define TG_ENTITY_STORE_H
+
+#include "Vec.h"
+#include "Random.h"
+#include "Handle.h"
+#include "Snapshot.h"
+
+namespace tagGame
+{
+   class EntityStore;
+
+   typedef SharedPtr<EntityStore>::type EntityStorePtr;
+
+   /// Contiguous storage for the state of many obstacles and characters.
+   /// Each field is kept in its own array, indexed by entity id, so that the
+   /// simulator can loop over the state of all the characters without
+   /// chasing pointers.  Shapes, obstacles and characters are views onto an
+   /// entity in a store (see Obstacle::bind).  The character fields are
+   /// unused by other obstacles.  What the shape fields mean depends on the
+   /// kind of shape: the radius is a circle's radius, or a side's distance
+   /// from the origin, whose normal is stored as its orientation.
+   class EntityStore
+   {
+   public:
+      EntityStore();
+
+      /// The kinds of shape (see Narrowphase).
+      enum ShapeKind
+      {
+         noShape,
+         circleShape,
+         sideShape
+      };
+
+      /// Add an entity with default values and return its id.
+      size_t add();
+      /// Add count entities with default values and return the first one's
+      /// id.  The rest follow it.
+      size_t add(size_t const count);
+      /// Add a copy of entity id from store and return the copy's id.
+      size_t add(EntityStore const& store, size_t const id);
+      /// Remove entity id by moving the last entity into its place, so the
+      /// ids stay dense.  The last entity's id becomes id.
+      void remove(size_t const id);
+
+      /// Write every field of every entity to a snapshot, or read them back
+      /// (see Snapshot).
+      void save(Snapshot& snapshot) const;
+      void restore(Snapshot const& snapshot, size_t& offset);
+
+      inline size_t size() const;
+
+      /// Obstacle fields.
+      inline std::vector<RealVec2>& getPositions();
+      inline std::vector<RealVec2> const& getPositions() const;
+      inline std::vector<RealVec2>& getOrientations();
+      inline std::vector<RealVec2> const& getOrientations() const;
+      inline std::vector<Real>& getSpeeds();
+      inline std::vector<Real> const& getSpeeds() const;
+      inline std::vector<Real>& getMasses();
+      inline std::vector<Real> const& getMasses() const;
+      inline std::vector<Real>& getRadii();
+      inline std::vector<Real> const& getRadii() const;
+      inline std::vector<ShapeKind>& getShapeKinds();
+      inline std::vector<ShapeKind> const& getShapeKinds() const;
+      /// Each entity's handle in the game-state it belongs to, if any.
+      inline std::vector<Handle>& getHandles();
+      inline std::vector<Handle> const& getHandles() const;
+
+      /// Character fields.
+      inline std::vector<Real>& getMaxTurnRates();
+      inline std::vector<Real> const& getMaxTurnRates() const;
+      inline std::vector<Real>& getMaxSpeeds();
+      inline std::vector<Real> const& getMaxSpeeds() const;
+      inline std::vector<Real>& getMaxForces();
+      inline std::vector<Real> const& getMaxForces() const;
+      inline std::vector<int>& getTagTimes();
+      inline std::vector<int> const& getTagTimes() const;
+      inline std::vector<int>& getCollideTimes();
+      inline std::vector<int> const& getCollideTimes() const;
+      /// Each character's own random number stream (see GameState::setSeed).
+      inline std::vector<Random>& getRandoms();
+      inline std::vector<Random> const& getRandoms() const;
+
+      /// A character's maximum speed, which is lower while it is tagged.
+      inline Real getMaxSpeed(size_t const id) const;
+
+      /// The velocity is stored as a speed and an orientation.
+      inline RealVec2 getVelocity(size_t const id) const;
+      inline void setVelocity(size_t const id, RealVec2 const& velocity);
+
+   protected:
+   private:
+      std::vector<RealVec2> positions;
+      std::vector<RealVec2> orientations;
+      std::vector<Real> speeds;
+      std::vector<Real> masses;
+      std::vector<Real> radii;
+      std::vector<ShapeKind> shapeKinds;
+      std::vector<Handle> handles;
+
+      std::vector<Real> maxTurnRates;
+      std::vector<Real> maxSpeeds;
+      std::vector<Real> maxForces;
+      std::vector<int> tagTimes;
+      std::vector<int> collideTimes;
+      std::vector<Random> randoms;
+   };
+
+   size_t EntityStore::size() const
+   {
+      return positions.size();
+   }
+
+   std::vector<RealVec2>& EntityStore::getPositions()
+   {
+      return positions;
+   }
+
+   std::vector<RealVec2> const& EntityStore::getPositions() const
+   {
+      return positions;
+   }
+
+   std::vector<RealVec2>& EntityStore::getOrientations()
+   {
+      return orientations;
+   }
+
+   std::vector<RealVec2> const& EntityStore::getOrientations() const
+   {
+      return orientations;
+   }
+
+   std::vector<Real>& EntityStore::getSpeeds()
+   {
+      return speeds;
+   }
+
+   std::vector<Real> const& EntityStore::getSpeeds() const
+   {
+      return speeds;
+   }
+
+   std::vector<Real>& EntityStore::getMasses()
+   {
+      return masses;
+   }
+
+   std::vector<Real> const& EntityStore::getMasses() const
+   {
+      return masses;
+   }
+
+   std::vector<Real>& EntityStore::getRadii()
+   {
+      return radii;
+   }
+
+   std::vector<Real> const& EntityStore::getRadii() const
+   {
+      return radii;
+   }
+
+   std::vector<EntityStore::ShapeKind>& EntityStore::getShapeKinds()
+   {
+      return shapeKinds;
+   }
+
+   std::vector<EntityStore::ShapeKind> const& EntityStore::getShapeKinds() const
+   {
+      return shapeKinds;
+   }
+
+   std::vector<Handle>& EntityStore::getHandles()
+   {
+      return handles;
+   }
+
+   std::vector<Handle> const& EntityStore::getHandles() const
+   {
+      return handles;
+   }
+
+   std::vector<Real>& EntityStore::getMaxTurnRates()
+   {
+      return maxTurnRates;
+   }
+
+   std::vector<Real> const& EntityStore::getMaxTurnRates() const
+   {
+      return maxTurnRates;
+   }
+
+   std::vector<Real>& EntityStore::getMaxSpeeds()
+   {
+      return maxSpeeds;
+   }
+
+   std::vector<Real> const& EntityStore::getMaxSpeeds() const
+   {
+      return maxSpeeds;
+   }
+
+   std::vector<Real>& EntityStore::getMaxForces()
+   {
+      return maxForces;
+   }
+
+   std::vector<Real> const& EntityStore::getMaxForces() const
+   {
+      return maxForces;
+   }
+
+   std::vector<int>& EntityStore::getTagTimes()
+   {
+      return tagTimes;
+   }
+
+   std::vector<int> const& EntityStore::getTagTimes() const
+   {
+      return tagTimes;
+   }
+
+   std::vector<int>& EntityStore::getCollideTimes()
+   {
+      return collideTimes;
+   }
+
+   std::vector<int> const& EntityStore::getCollideTimes() const
+   {
+      return collideTimes;
+   }
+
+   std::vector<Random>& EntityStore::getRandoms()
+   {
+      return randoms;
+   }
+
+   std::vector<Random> const& EntityStore::getRandoms() const
+   {
+      return randoms;
+   }
+
+   Real EntityStore::getMaxSpeed(size_t const id) const
+   {
+      if (0 <= tagTimes[id]) { return 0.8 * maxSpeeds[id]; }
+      return maxSpeeds[id];
+   }
+
+   RealVec2 EntityStore::getVelocity(size_t const id) const
+   {
+      RealVec2 v(orientations[id]);
+      return v.scale(speeds[id]);
+   }
+
+   void EntityStore::setVelocity(size_t const id, RealVec2 const& velocity)
+   {
+      RealVec2 v(velocity);
+      Real const s = v.length();
+      if (MathUtil::isAlmostZero(s))
+      {
+         speeds[id] = 0;
+         // Don't change the orientation if the speed is zero.
+      }
+      else
+      {
+         TG_ASSERT(masses[id] < Inf); // Infinitely heavy object can't move
+         speeds[id] = s;
+         orientations[id] = v.normalize();
+      }
+   }
+}
+
+#endif
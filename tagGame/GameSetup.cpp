@@ -0,0 +1,180 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+
+#include "GameSetup.h"
+#include "GameState.h"
+#include "Character.h"
+#include "ControllerPursue.h"
+#include "ControllerEvade.h"
+#include "ControllerPeriodicRamp.h"
+#include "ControllerConditional.h"
+#include "ControllerAvoid.h"
+#include "ControllerRandomize.h"
+#include "ControllerProgram.h"
+#include "Perception.h"
+#include "Circle.h"
+#include "Side.h"
+#include "Util2D.h"
+#include "Random.h"
+
+using namespace tagGame;
+
+using namespace std;
+
+Real const GameSetup::characterRadius = Real(10);
+
+GameSetup::NPCTuning::NPCTuning() :
+   tagNear(2),
+   tagFar(10),
+   minPeriod(0.2),
+   maxPeriod(0.4)
+{
+}
+
+ControllerPtr GameSetup::createNPCController(PerceptionPtr perception, Real radius, NPCTuning const& tuning)
+{
+   // Define what counts as the tagged character being "near"
+   Real const tagNear = tuning.tagNear * radius;
+   
+   // Define what counts as the tagged character being "far"
+   Real const tagFar = tuning.tagFar * tagNear;
+
+   // What's the minimum time (in seconds) allowed between decisions
+   Real const minPeriod = tuning.minPeriod;
+
+   // What's the maximum time (in seconds) allowed between decisions
+   Real const maxPeriod = tuning.maxPeriod;
+
+   return ControllerPtr(
+             new ControllerConditional(perception,
+             &Perception::myselfTagged,
+             ControllerPtr(new ControllerAvoid(perception, ControllerPtr(new ControllerPursue(perception)))),
+             ControllerPtr(new ControllerAvoid(perception,
+                ControllerPtr(new ControllerPeriodicRamp(perception,
+                   ControllerPtr(new ControllerRandomize(perception,
+                      ControllerPtr(new ControllerEvade(perception)),
+                      &Perception::distanceToTagged, tagNear, tagFar)),
+                                                         &Perception::distanceToTagged, tagNear, tagFar, minPeriod, maxPeriod))))));
+}
+
+static CirclePtr newCircle(GameSetup::Pools* pools)
+{
+   return pools ? pools->circles.share() : CirclePtr(new Circle());
+}
+
+static SidePtr newSide(GameSetup::Pools* pools)
+{
+   return pools ? pools->sides.share() : SidePtr(new Side());
+}
+
+static ObstaclePtr newObstacle(GameSetup::Pools* pools, ShapePtr shape)
+{
+   return pools ? pools->obstacles.share(shape) : ObstaclePtr(new Obstacle(shape));
+}
+
+BehaviorProgramPtr GameSetup::setupCharacters(GameState& gs, PerceptionPtr perception, size_t const count, RendererPtr renderer,
+                                Pools* pools, NPCTuning const& tuning)
+{
+   Random::Scope scope(gs.getRandom());
+   BehaviorProgramPtr program(new BehaviorProgram(*createNPCController(perception, characterRadius, tuning)));
+
+   for (size_t i = 0; i < count; i++)
+   {
+      CirclePtr cs(newCircle(pools));
+      cs->setRadius(characterRadius);
+      ControllerPtr controller;
+      if (pools) { controller = pools->controllers.share(perception, program); }
+      else { controller = ControllerPtr(new ControllerProgram(perception, program)); }
+      CharacterPtr c(pools ? pools->characters.share(cs, controller) : CharacterPtr(new Character(cs, controller)));
+      c->setRenderer(renderer);
+      c->setPosition(Util2D::randomPosition(gs.getWorldDim()));
+      c->setMass(1);
+      gs.addCharacter(c);
+   }
+
+   return program;
+}
+
+void GameSetup::setupObstacles(GameState& gs, RendererPtr renderer, size_t const circularObstacleCount,
+                               Pools* pools)
+{
+   RealVec2 const& worldDim(gs.getWorldDim());
+   Random::Scope scope(gs.getRandom());
+
+   for (size_t i = 0; i < circularObstacleCount; i++)
+   {
+      ObstaclePtr o(newObstacle(pools, newCircle(pools)));
+      o->setRenderer(renderer);
+      o->setPosition(Util2D::randomPosition(worldDim));
+      gs.addObstacle(o);
+   }
+
+   RealVec2 normal(Util2D::dim);
+   RealVec2 begin(Util2D::dim);
+   RealVec2 end(Util2D::dim);
+
+   vector<ObstaclePtr> sides(4);
+
+   SidePtr s(newSide(pools));
+   begin.set(0);
+   end.set(0);
+   end[1] = worldDim[1];
+   s->setBegin(end);
+   s->setEnd(begin);
+   normal.set(Real(0));
+   normal[0] = Real(1);
+   s->setNormal(normal);
+   s->setDistance(Real(0));
+   sides[0] = newObstacle(pools, s);
+
+   s = newSide(pools);
+   begin[0] = worldDim[0];
+   end[0] = worldDim[0];
+   s->setBegin(end);
+   s->setEnd(begin);
+   normal[0] = Real(-1);
+   s->setNormal(normal);
+   s->setDistance(-worldDim[0]);
+   sides[1] = newObstacle(pools, s);
+
+   s = newSide(pools);
+   begin.set(0);
+   end[1] = 0;
+   s->setBegin(end);
+   s->setEnd(begin);
+   normal.set(Real(0));
+   normal[1] = Real(1);
+   s->setNormal(normal);
+   s->setDistance(Real(0));
+   sides[2] = newObstacle(pools, s);
+
+   s = newSide(pools);
+   begin[1] = worldDim[1];
+   end[1] = worldDim[1];
+   s->setBegin(end);
+   s->setEnd(begin);
+   normal[1] = Real(-1);
+   s->setNormal(normal);
+   s->setDistance(-worldDim[1]);
+   sides[3] = newObstacle(pools, s);
+
+   for (size_t i = 0; i < sides.size(); i++)
+   {
+      gs.addObstacle(sides[i]);
+   }
+}
@@ -0,0 +1,89 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_GAME_SETUP_H
+#define TG_GAME_SETUP_H
+
+#include "Controller.h"
+#include "Obstacle.h"
+#include "Character.h"
+#include "Circle.h"
+#include "Side.h"
+#include "ControllerProgram.h"
+#include "Pool.h"
+
+namespace tagGame
+{
+   class GameState;
+
+   /// Functions for populating a game world.
+   /// They are shared by the game itself and by the headless tools, so
+   /// nothing in here depends on the Gui.  Renderers are passed in and
+   /// can be left NULL when nothing is going to be drawn.
+   class GameSetup
+   {
+   public:
+      /// Pools for the objects the functions below create (see Pool), so
+      /// that each type's objects are allocated together.  The pools must
+      /// outlive the game-state, and anything else the objects are given to.
+      struct Pools
+      {
+         Pool<Character> characters;
+         Pool<Circle> circles;
+         Pool<Side> sides;
+         Pool<Obstacle> obstacles;
+         Pool<ControllerProgram> controllers;
+      };
+
+      /// Default radius of a character.
+      static Real const characterRadius;
+
+      /// The constants that tune the NPC behavior, e.g. for searching for
+      /// better values (see tagSweep).  The defaults are the game's.
+      struct NPCTuning
+      {
+         NPCTuning();
+
+         /// The tagged character counts as near within tagNear radii, and
+         /// as far beyond tagFar times that.
+         Real tagNear;
+         Real tagFar;
+         /// The least and most time (in seconds) allowed between decisions.
+         Real minPeriod;
+         Real maxPeriod;
+      };
+
+      /// The behavior used by all the NPCs.
+      static ControllerPtr createNPCController(PerceptionPtr perception, Real radius,
+                                               NPCTuning const& tuning = NPCTuning());
+
+      /// Add count NPCs at random positions in the world.  They all run the
+      /// NPC behavior compiled into one shared program (see BehaviorProgram).
+      /// If pools are given, the NPCs are allocated from them.  Returns the
+      /// program, which holds the NPCs' controller state (see Snapshot).
+      static BehaviorProgramPtr setupCharacters(GameState& gs, PerceptionPtr perception, size_t const count, RendererPtr renderer,
+                                  Pools* pools = NULL, NPCTuning const& tuning = NPCTuning());
+
+      /// Add some circular obstacles at random positions and a side obstacle
+      /// along each edge of the world.  If pools are given, the obstacles are
+      /// allocated from them.
+      static void setupObstacles(GameState& gs, RendererPtr renderer, size_t const circularObstacleCount = 7,
+                                 Pools* pools = NULL);
+   };
+}
+
+#endif
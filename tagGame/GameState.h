@@ -19,6 +19,7 @@
 #define TG_GAME_STATE_H
 
 #include "Character.h"
+#include "SpatialGrid.h"
 #include "Timer.h"
 
 namespace tagGame
@@ -27,7 +28,7 @@ namespace tagGame
    class GameState
    {
    public:
-      inline GameState(RealVec const& worldDim);
+      inline GameState(RealVec2 const& worldDim, Random::Bits const seed = 0);
       inline ~GameState();
 
       inline ObstacleIterator getObstacleListBegin();
@@ -52,20 +53,103 @@ namespace tagGame
       inline void addCharacter(CharacterPtr c);
       inline void addObstacle(ObstaclePtr o);
 
-      inline RealVec const& getWorldDim() const;
+      /// Remove a character, or a non-character obstacle, in O(1).  To keep
+      /// the lists and stores dense, the last character (or non-character
+      /// obstacle) is moved into the removed one's place, which changes its
+      /// id and its place in the lists, and invalidates any iterators.  The
+      /// removed object gets its own copy of its state (see
+      /// Obstacle::detach), so it is still usable by anything holding on to it.
+      inline void removeCharacter(Character* c);
+      inline void removeObstacle(Obstacle* o);
+
+      /// Look up a character or obstacle by its handle (see
+      /// Obstacle::getHandle), in O(1).  NULL if it has been removed since (or,
+      /// for getCharacter, if it isn't a character).
+      inline Character* getCharacter(Handle const& h) const;
+      inline Obstacle* getObstacle(Handle const& h) const;
+
+      /// The number of times anything has been added or removed (or the
+      /// world restored from a snapshot), so that anything that depends on
+      /// ids can tell when they might have changed.
+      inline int getChangeCount() const;
+
+      /// Write the state of the world to a snapshot, or read it back (see
+      /// Snapshot).  The state can only be read back into a world with the
+      /// same number of characters and obstacles, with the same kinds of
+      /// shapes, as the one it was written from: the same world, or a
+      /// replica of it.  Handles mean the same after as they did before.
+      inline void save(Snapshot& snapshot) const;
+      inline void restore(Snapshot const& snapshot, size_t& offset);
+
+      inline RealVec2 const& getWorldDim() const;
+
+      /// Everything random in a world is drawn from streams seeded from the
+      /// world's seed: one stream for the world itself (used for things like
+      /// setting up the world) and one per character (stored with the
+      /// character's state), so that a run can be reproduced from its seed no
+      /// matter how many threads it is run on.  Setting the seed re-seeds all
+      /// the streams.
+      inline Random::Bits getSeed() const;
+      inline void setSeed(Random::Bits const seed);
+      inline Random& getRandom();
+
+      /// The state of all the characters, in the same order as the
+      /// character list (so the id of a character is its index in the list).
+      inline EntityStore& getCharacterStore();
+      inline EntityStore const& getCharacterStore() const;
+      /// The state of the non-character obstacles, in list order.
+      inline EntityStore& getObstacleStore();
+      inline EntityStore const& getObstacleStore() const;
+
+      /// A spatial index of where all the characters and obstacles are.  The
+      /// index is re-built on demand, so it must be invalidated whenever
+      /// anything moves (see Simulator::updateGameState).
+      inline SpatialGrid const& getGrid();
+      inline void invalidateGrid();
 
       inline int getFrame() const;
       inline void incFrame();
 
+      /// Game time.
+      /// Unlike the Timer's game time, this is advanced by the simulator
+      /// (see Simulator::forward), so that a world can be stepped faster
+      /// (or slower) than wall clock time.
+      inline Real getTime() const;
+      inline int getTicks() const;
+      inline void incTime(Real const deltaT);
+
       inline int getLastTaggedTime();
       inline void setTagged();
 
    protected:
    private:
+      // Characters and obstacles are views onto the game-state's stores, so
+      // copying a game-state would be ambiguous.
+      GameState(GameState const&);
+      GameState& operator=(GameState const&);
+
+      // What a handle's slot refers to: the id of a character or non-character
+      // obstacle, and its place in the list of all obstacles.  The id of a
+      // free slot is the next free slot.
+      struct Slot
+      {
+         unsigned int generation;
+         bool isCharacter;
+         size_t id;
+         size_t order;
+      };
+
+      inline Handle addSlot(bool const isCharacter, size_t const id);
+      inline void removeSlot(Handle const& h);
+      inline Slot const* findSlot(Handle const& h) const;
+      inline void removeFromObstacleList(size_t const order);
+
       // List of all obstacles
       ObstacleList obstacles;
       // The current frame number
       int frame;
+      // The current game time in seconds
+      Real time;
       // Instead of maintaining separate lists of characters and non-character obstacles,
       // some other options are:
       //  i) Just use dynamic_cast to figure out which type an obstacle is;
@@ -76,19 +160,43 @@ namespace tagGame
       CharacterList characters;
       ObstacleList nonCharacterObstacles;
 
-      RealVec worldDim;
+      EntityStore characterStore;
+      EntityStore obstacleStore;
+
+      RealVec2 worldDim;
+
+      Random::Bits seed;
+      Random random;
+
+      SpatialGrid grid;
 
       int lastTagTime;
+
+      std::vector<Slot> slots;
+      size_t freeSlot;
+      int changeCount;
    }; // GameState
 
-   GameState::GameState(RealVec const& worldDim) :
+   GameState::GameState(RealVec2 const& worldDim, Random::Bits const seed) :
       frame(0),
+      time(0),
       worldDim(worldDim),
-      lastTagTime(-1)
+      seed(seed),
+      random(seed),
+      lastTagTime(-1),
+      freeSlot(Handle::nullSlot),
+      changeCount(0)
    {}
 
    GameState::~GameState()
    {
+      // Anything that outlives the game-state needs its own copy of its state.
+      // Every obstacle is referred to twice by the game-state: once in the list
+      // of all obstacles, and once in the character or non-character list.
+      for (ObstacleIterator i = obstacles.begin(); i != obstacles.end(); i++)
+      {
+         if (2 < i->use_count()) { (*i)->detach(); }
+      }
    }
 
    int GameState::getLastTaggedTime()
@@ -156,11 +264,68 @@ namespace tagGame
       return nonCharacterObstacles.end();
    }
 
-   RealVec const& GameState::getWorldDim() const
+   RealVec2 const& GameState::getWorldDim() const
    {
       return worldDim;
    }
    
+   Random::Bits GameState::getSeed() const
+   {
+      return seed;
+   }
+
+   void GameState::setSeed(Random::Bits const seed)
+   {
+      this->seed = seed;
+      random.seed(seed);
+      // Stream 0 is the world's, so characters' streams start at 1.
+      std::vector<Random>& randoms(characterStore.getRandoms());
+      for (size_t id = 0; id < randoms.size(); id++)
+      {
+         randoms[id].seed(seed, id + 1);
+      }
+   }
+
+   Random& GameState::getRandom()
+   {
+      return random;
+   }
+
+   EntityStore& GameState::getCharacterStore()
+   {
+      return characterStore;
+   }
+
+   EntityStore const& GameState::getCharacterStore() const
+   {
+      return characterStore;
+   }
+
+   EntityStore& GameState::getObstacleStore()
+   {
+      return obstacleStore;
+   }
+
+   EntityStore const& GameState::getObstacleStore() const
+   {
+      return obstacleStore;
+   }
+
+   SpatialGrid const& GameState::getGrid()
+   {
+      if (!grid.isValid())
+      {
+         grid.build(*this);
+      }
+
+      return grid;
+   }
+
+   void GameState::invalidateGrid()
+   {
+      grid.invalidate();
+   }
+
    int GameState::getFrame() const
    {
       return frame;
@@ -170,22 +335,222 @@ namespace tagGame
    {
       frame++;
    }
+
+   Real GameState::getTime() const
+   {
+      return time;
+   }
+
+   int GameState::getTicks() const
+   {
+      return int(time * Real(Timer::ticksPerSec));
+   }
+
+   void GameState::incTime(Real const deltaT)
+   {
+      time += deltaT;
+   }
    
    void GameState::setTagged()
    {
-      lastTagTime = Timer::theTimer().gameTicks();
+      lastTagTime = getTicks();
    }
 
    void GameState::addCharacter(CharacterPtr c)
    {
+      // A character that is already the next entity in the store (see
+      // Shape) is used in place, rather than copied.
+      size_t const id = c->getStore() == &characterStore ? c->getId() : characterStore.add(*c->getStore(), c->getId());
+      TG_ASSERT(id == characters.size());
+      characterStore.getRandoms()[id].seed(seed, id + 1);
+      characterStore.getHandles()[id] = addSlot(true, id);
+      c->bind(&characterStore, id);
       characters.push_back(c);
       obstacles.push_back(c);
+      grid.invalidate();
+      changeCount++;
    }
 
    void GameState::addObstacle(ObstaclePtr o)
    {
+      size_t const id = o->getStore() == &obstacleStore ? o->getId() : obstacleStore.add(*o->getStore(), o->getId());
+      TG_ASSERT(id == nonCharacterObstacles.size());
+      obstacleStore.getHandles()[id] = addSlot(false, id);
+      o->bind(&obstacleStore, id);
       obstacles.push_back(o);
       nonCharacterObstacles.push_back(o);
+      grid.invalidate();
+      changeCount++;
+   }
+
+   void GameState::removeCharacter(Character* c)
+   {
+      TG_ASSERT(c && c->getStore() == &characterStore && &*characters[c->getId()] == c);
+
+      size_t const id = c->getId();
+      size_t const last = characters.size() - 1;
+      Handle const h(c->getHandle());
+
+      // Every object is referred to twice by the game-state (see ~GameState).
+      if (2 < characters[id].use_count()) { c->detach(); }
+      removeFromObstacleList(findSlot(h)->order);
+      characterStore.remove(id);
+      characters[id] = characters[last];
+      characters.pop_back();
+      if (id != last)
+      {
+         characters[id]->bind(&characterStore, id);
+         slots[characters[id]->getHandle().getSlot()].id = id;
+      }
+      removeSlot(h);
+
+      grid.invalidate();
+      changeCount++;
+   }
+
+   void GameState::removeObstacle(Obstacle* o)
+   {
+      TG_ASSERT(o && o->getStore() == &obstacleStore && &*nonCharacterObstacles[o->getId()] == o);
+
+      size_t const id = o->getId();
+      size_t const last = nonCharacterObstacles.size() - 1;
+      Handle const h(o->getHandle());
+
+      if (2 < nonCharacterObstacles[id].use_count()) { o->detach(); }
+      removeFromObstacleList(findSlot(h)->order);
+      obstacleStore.remove(id);
+      nonCharacterObstacles[id] = nonCharacterObstacles[last];
+      nonCharacterObstacles.pop_back();
+      if (id != last)
+      {
+         nonCharacterObstacles[id]->bind(&obstacleStore, id);
+         slots[nonCharacterObstacles[id]->getHandle().getSlot()].id = id;
+      }
+      removeSlot(h);
+
+      grid.invalidate();
+      changeCount++;
+   }
+
+   Character* GameState::getCharacter(Handle const& h) const
+   {
+      Slot const* const s = findSlot(h);
+      return s && s->isCharacter ? &*characters[s->id] : NULL;
+   }
+
+   Obstacle* GameState::getObstacle(Handle const& h) const
+   {
+      Slot const* const s = findSlot(h);
+      if (!s) { return NULL; }
+      return s->isCharacter ? &*characters[s->id] : &*nonCharacterObstacles[s->id];
+   }
+
+   int GameState::getChangeCount() const
+   {
+      return changeCount;
+   }
+
+   void GameState::save(Snapshot& snapshot) const
+   {
+      snapshot.write(characters.size());
+      snapshot.write(nonCharacterObstacles.size());
+      snapshot.write(frame);
+      snapshot.write(time);
+      snapshot.write(lastTagTime);
+      snapshot.write(seed);
+      snapshot.write(random);
+      characterStore.save(snapshot);
+      obstacleStore.save(snapshot);
+      snapshot.writeArray(slots);
+      snapshot.write(freeSlot);
+   }
+
+   void GameState::restore(Snapshot const& snapshot, size_t& offset)
+   {
+      size_t characterCount;
+      size_t obstacleCount;
+      snapshot.read(offset, characterCount);
+      snapshot.read(offset, obstacleCount);
+      if (characterCount != characters.size() || obstacleCount != nonCharacterObstacles.size())
+      {
+         Util::error("GameState: can't restore a snapshot of a different world");
+      }
+
+      snapshot.read(offset, frame);
+      snapshot.read(offset, time);
+      snapshot.read(offset, lastTagTime);
+      snapshot.read(offset, seed);
+      snapshot.read(offset, random);
+      characterStore.restore(snapshot, offset);
+      obstacleStore.restore(snapshot, offset);
+      snapshot.readArray(offset, slots);
+      snapshot.read(offset, freeSlot);
+      if (Handle::nullSlot != freeSlot && slots.size() <= freeSlot)
+      {
+         Util::error("GameState: can't restore a snapshot of a different world");
+      }
+
+      // The list of all obstacles may be in a different order from the
+      // snapshot's world.
+      for (size_t i = 0; i < obstacles.size(); i++)
+      {
+         if (slots.size() <= obstacles[i]->getHandle().getSlot())
+         {
+            Util::error("GameState: can't restore a snapshot of a different world");
+         }
+         slots[obstacles[i]->getHandle().getSlot()].order = i;
+      }
+
+      grid.invalidate();
+      changeCount++;
+   }
+
+   Handle GameState::addSlot(bool const isCharacter, size_t const id)
+   {
+      size_t slot = freeSlot;
+      if (Handle::nullSlot == slot)
+      {
+         slot = slots.size();
+         slots.push_back(Slot());
+         slots[slot].generation = 0;
+      }
+      else
+      {
+         freeSlot = slots[slot].id;
+      }
+
+      Slot& s(slots[slot]);
+      s.isCharacter = isCharacter;
+      s.id = id;
+      // Called before the object is added to the list of all obstacles.
+      s.order = obstacles.size();
+      return Handle(slot, s.generation);
+   }
+
+   void GameState::removeSlot(Handle const& h)
+   {
+      Slot& s(slots[h.getSlot()]);
+      // Any handles to what was in the slot are stale from now on.
+      s.generation++;
+      s.id = freeSlot;
+      freeSlot = h.getSlot();
+   }
+
+   GameState::Slot const* GameState::findSlot(Handle const& h) const
+   {
+      if (slots.size() <= h.getSlot()) { return NULL; }
+      Slot const& s(slots[h.getSlot()]);
+      return s.generation == h.getGeneration() ? &s : NULL;
+   }
+
+   void GameState::removeFromObstacleList(size_t const order)
+   {
+      obstacles[order] = obstacles.back();
+      obstacles.pop_back();
+      if (order < obstacles.size())
+      {
+         slots[obstacles[order]->getHandle().getSlot()].order = order;
+      }
    }
 }
 
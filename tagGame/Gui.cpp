@@ -20,6 +20,7 @@
 #include "Timer.h"
 #include "GameState.h"
 #include "Util2D.h"
+#include "PerfStats.h"
 
 #if defined(_MSC_VER)
 #define NOMINMAX
@@ -29,6 +30,8 @@
 #include <SDL.h>
 #include <SDL_opengl.h>
 
+#include <cstring>
+
 #if defined(TG_USE_TR1)
 #include <tr1/functional>
 #endif
@@ -37,7 +40,14 @@ using namespace tagGame;
 
 using namespace std;
 
-GLUquadric* Gui::q = NULL;
+vector<Gui::Batch> Gui::batches;
+size_t Gui::batchCount = 0;
+Gui::Batch* Gui::current = NULL;
+float Gui::unitCircle[2 * (circleSlices + 1)];
+PerfStats* Gui::stats = NULL;
+bool Gui::isShowStats = false;
+int Gui::width = 0;
+int Gui::height = 0;
 
 RealVec const& Gui::getColorFromName(string const& colorName)
 {
@@ -91,96 +101,203 @@ RealVec const& Gui::getColorFromName(string const& colorName)
    return black;
 }
 
-void Gui::drawCircle(RealVec const& center, RealVec const& orientation, Real const radius)
+void Gui::drawCircle(RealVec2 const& center, RealVec2 const& orientation, Real const radius)
 {
-   glPushMatrix();
-   glTranslatef(GLfloat(center[0]), GLfloat(center[1]), 0.0);
-   glRotatef(GLfloat(MathUtil::radToDeg(Util2D::angle(orientation))), 0, 0, 1);
-   gluPartialDisk(Gui::q, 0.0, radius, 20, 1, 0.0, 360.0);
-   glPopMatrix();
+   if (!current) { setColor(getColorFromName("white")); }
+
+   // The unit circle, turned to face along the orientation and scaled,
+   // as a fan of triangles around the center.
+   GLfloat const cx = GLfloat(center[0]);
+   GLfloat const cy = GLfloat(center[1]);
+   GLfloat const ox = GLfloat(radius * orientation[0]);
+   GLfloat const oy = GLfloat(radius * orientation[1]);
+
+   vector<float>& v(current->triangles);
+   size_t k = v.size();
+   v.resize(k + 6 * circleSlices);
+   GLfloat x0 = cx + unitCircle[0] * ox - unitCircle[1] * oy;
+   GLfloat y0 = cy + unitCircle[0] * oy + unitCircle[1] * ox;
+   for (int i = 1; i <= circleSlices; i++)
+   {
+      GLfloat const x1 = cx + unitCircle[2 * i] * ox - unitCircle[2 * i + 1] * oy;
+      GLfloat const y1 = cy + unitCircle[2 * i] * oy + unitCircle[2 * i + 1] * ox;
+      v[k++] = cx;
+      v[k++] = cy;
+      v[k++] = x0;
+      v[k++] = y0;
+      v[k++] = x1;
+      v[k++] = y1;
+      x0 = x1;
+      y0 = y1;
+   }
 }
 
-void Gui::drawLineSegment(RealVec const& begin, RealVec const& end)
+void Gui::drawLineSegment(RealVec2 const& begin, RealVec2 const& end)
 {
-   glBegin(GL_LINES);
-   glVertex2f(GLfloat(begin[0]), GLfloat(begin[1]));
-   glVertex2f(GLfloat(end[0]), GLfloat(end[1]));
-   glEnd();
+   if (!current) { setColor(getColorFromName("white")); }
+
+   vector<float>& v(current->lines);
+   v.push_back(GLfloat(begin[0]));
+   v.push_back(GLfloat(begin[1]));
+   v.push_back(GLfloat(end[0]));
+   v.push_back(GLfloat(end[1]));
 }
 
-void Gui::drawArrow(RealVec const& begin, RealVec const& direction)
+void Gui::drawArrow(RealVec2 const& begin, RealVec2 const& direction)
 {
-   RealVec lvec(direction);
-
-   Real const lineSize = lvec.length();
-   Real const headSize = 0.5*lineSize;
-   Real const lAngle = 2.5;
-   Real const rAngle = -2.5;
-
-   lvec.normalize();
+   // The head's sides are half as long as the arrow, and turned 2.5
+   // radians either way from it.
+   static Real const headCos = Real(0.5) * cos(Real(2.5));
+   static Real const headSin = Real(0.5) * sin(Real(2.5));
+
+   RealVec2 end(begin);
+   end.add(direction);
+
+   RealVec2 head(Util2D::dim);
+   head[0] = end[0] + headCos * direction[0] - headSin * direction[1];
+   head[1] = end[1] + headSin * direction[0] + headCos * direction[1];
+   drawLineSegment(begin, end);
+   drawLineSegment(end, head);
+
+   head[0] = end[0] + headCos * direction[0] + headSin * direction[1];
+   head[1] = end[1] - headSin * direction[0] + headCos * direction[1];
+   drawLineSegment(end, head);
+}
 
-   RealVec hvec1(Util2D::rotationMatrix(lAngle).multiply(lvec));
-   RealVec hvec2(Util2D::rotationMatrix(rAngle).multiply(lvec));
-   hvec1.scale(headSize);
-   hvec2.scale(headSize);
-   lvec.scale(lineSize);
+void Gui::pause(int const t)
+{
+   SDL_Delay(t);
+}
 
-   bool const rightWay(true);
-   glPushMatrix();
-   if (rightWay)
+void Gui::setColor(RealVec const& color)
+{
+   GLfloat c[colorDim];
+   for (int k = 0; k < colorDim; k++)
    {
-      glTranslatef(GLfloat(begin[0]), GLfloat(begin[1]), 0.0);
+      c[k] = GLfloat(color[k]);
    }
-   else
+
+   // There are only ever a few colors.
+   for (size_t i = 0; i < batchCount; i++)
    {
-      glTranslatef(GLfloat(begin[0] - lvec[0]), GLfloat(begin[1] - lvec[1]), 0.0);
+      if (0 == memcmp(c, batches[i].color, sizeof(c)))
+      {
+         current = &batches[i];
+         return;
+      }
    }
-   glBegin(GL_LINE_STRIP);
-   glVertex2f(0, 0);
-   glVertex2f(GLfloat(lvec[0]), GLfloat(lvec[1]));
-   glVertex2f(GLfloat(lvec[0] + hvec1[0]), GLfloat(lvec[1] + hvec1[1]));
-   glEnd();
-   glPopMatrix();
 
-   glPushMatrix();
-   if (rightWay)
+   if (batches.size() == batchCount) { batches.resize(batchCount + 1); }
+   current = &batches[batchCount++];
+   memcpy(current->color, c, sizeof(c));
+}
+
+void Gui::flush()
+{
+   glEnableClientState(GL_VERTEX_ARRAY);
+
+   // The filled shapes first, so that the lines are drawn over them.
+   for (int pass = 0; pass < 2; pass++)
    {
-      glTranslatef(GLfloat(begin[0] + lvec[0]), GLfloat(begin[1] + lvec[1]), 0.0);
+      for (size_t i = 0; i < batchCount; i++)
+      {
+         vector<float> const& v(0 == pass ? batches[i].triangles : batches[i].lines);
+         if (v.empty()) { continue; }
+         glColor4fv(batches[i].color);
+         glVertexPointer(2, GL_FLOAT, 0, &v[0]);
+         glDrawArrays(0 == pass ? GL_TRIANGLES : GL_LINES, 0, GLsizei(v.size() / 2));
+      }
    }
-   else
+
+   glDisableClientState(GL_VERTEX_ARRAY);
+
+   // Cleared, rather than freed, so the memory is reused.
+   for (size_t i = 0; i < batchCount; i++)
    {
-      glTranslatef(GLfloat(begin[0]), GLfloat(begin[1]), 0.0);
+      batches[i].triangles.clear();
+      batches[i].lines.clear();
    }
-   glBegin(GL_LINES);
-   glVertex2f(0, 0);
-   glVertex2f(GLfloat(hvec2[0]), GLfloat(hvec2[1]));
-   glEnd();
-   glPopMatrix();
+   batchCount = 0;
+   current = NULL;
 }
 
-void Gui::pause(int const t)
-{
-   SDL_Delay(t);
-}
-
-void Gui::setColor(RealVec const& color)
+void Gui::setStats(PerfStats* stats)
 {
-   // TODO: why doesn't next line work properly?  sets color to whatever it was
-   // set to previously! maybe something funny todo with memory addresses?
-   // glColor4fv((GLfloat*) &color[0]);
-   glColor4f(GLfloat(color[0]), GLfloat(color[1]), GLfloat(color[2]), GLfloat(color[3]));
+   Gui::stats = stats;
 }
 
 void Gui::render(GameState* gs)
 {
+   Real const start = Timer::preciseTime();
+
 #if defined(TG_USE_TR1)
    for_each(gs->getObstacleListBegin(), gs->getObstacleListEnd(), std::tr1::mem_fn(&Obstacle::render));
 #else
    for_each(gs->getObstacleListBegin(), gs->getObstacleListEnd(), std::mem_fun(&Obstacle::render));
 #endif
+   flush();
+
+   if (isShowStats && stats) { drawStats(); }
 
    SDL_GL_SwapBuffers();
    glClear(GL_COLOR_BUFFER_BIT |  GL_DEPTH_BUFFER_BIT);
+
+   if (stats) { stats->add(PerfStats::renderTime, Timer::preciseTime() - start); }
+}
+
+void Gui::drawStats()
+{
+   // Everything is drawn in pixels, with pixelsPerMs pixels to a millisecond.
+   Real const pixelsPerMs = 8;
+   Real const budget = Real(1000)/Real(60);
+   Real const margin = 4;
+
+   RealVec2 begin(Util2D::dim);
+   RealVec2 end(Util2D::dim);
+
+   // The recent frame times, newest on the right.
+   RollingHistogram const& frames(stats->getHistogram(PerfStats::frameTime));
+   size_t const frameCount = std::min(frames.getCount(), size_t(std::max(0, width - 2 * int(margin))));
+   for (size_t i = 0; i < frameCount; i++)
+   {
+      Real const ms = Real(1000) * frames.getSample(frames.getCount() - frameCount + i);
+      setColor(getColorFromName(ms <= budget ? "green" : "red"));
+      begin[0] = margin + Real(i);
+      begin[1] = margin;
+      end[0] = begin[0];
+      end[1] = margin + std::min(ms, Real(height)/Real(2)/pixelsPerMs) * pixelsPerMs;
+      drawLineSegment(begin, end);
+   }
+
+   setColor(getColorFromName("white"));
+   begin[0] = margin;
+   begin[1] = margin + budget * pixelsPerMs;
+   end[0] = width - margin;
+   end[1] = begin[1];
+   drawLineSegment(begin, end);
+   flush();
+
+   // One bar per time counter, from the top of the window down.
+   glLineWidth(3);
+   char const* const colors[] = { "red", "yellow", "green" };
+   Real const percentiles[] = { -1, 99, 50 };
+   // Longest first, so that the shorter bars are drawn over them.
+   for (size_t k = 0; k < 3; k++)
+   {
+      setColor(getColorFromName(colors[k]));
+      for (int c = 0; PerfStats::isTime(PerfStats::Counter(c)); c++)
+      {
+         RollingHistogram const& h(stats->getHistogram(PerfStats::Counter(c)));
+         Real const ms = Real(1000) * (percentiles[k] < 0 ? h.getMax() : h.getPercentile(percentiles[k]));
+         begin[0] = margin;
+         begin[1] = height - margin - Real(4 * c);
+         end[0] = margin + std::min(ms * pixelsPerMs, Real(width) - 2 * margin);
+         end[1] = begin[1];
+         drawLineSegment(begin, end);
+      }
+      flush();
+   }
+   glLineWidth(1);
 }
 
 bool Gui::isQuit()
@@ -192,6 +309,9 @@ bool Gui::isQuit()
       {
       case SDL_QUIT:
          return true;
+      case SDL_KEYDOWN:
+         if (SDLK_s == event.key.keysym.sym) { isShowStats = !isShowStats; }
+         break;
       default:
          break;
       }
@@ -209,6 +329,9 @@ void Gui::initGL(int const width, int const height)
 {
    TG_ASSERT(0 != height);
 
+   Gui::width = width;
+   Gui::height = height;
+
    glViewport(0, 0, width, height);
 
    // Set the world to screen coordinate transform
@@ -226,14 +349,17 @@ void Gui::initGL(int const width, int const height)
 
    glClearColor(0.00f, 0.00f, 0.00f, 0.0f);
 
-   q = gluNewQuadric();
+   for (int i = 0; i <= circleSlices; i++)
+   {
+      Real const t = Real(2) * M_PI * Real(i % circleSlices) / Real(circleSlices);
+      unitCircle[2 * i] = GLfloat(cos(t));
+      unitCircle[2 * i + 1] = GLfloat(sin(t));
+   }
 }
 
 
 void Gui::destroyWindow()
 {
-   gluDeleteQuadric(q);
-
    SDL_Quit();
 }
 
@@ -20,11 +20,12 @@
 
 #include "Vec.h"
 
-class GLUquadric;
+#include <vector>
 
 namespace tagGame
 {
    class GameState;
+   class PerfStats;
 
    /// This class is responsible for handling the game's GUI.
    class Gui
@@ -37,9 +38,22 @@ namespace tagGame
       static void render(GameState* gs);
       static bool isQuit();
 
-      static void drawCircle(RealVec const& center, RealVec const& orientation, Real const radius);
-      static void drawArrow(RealVec const& begin, RealVec const& direction);
-      static void drawLineSegment(RealVec const& begin, RealVec const& end);
+      /// Where to record how long rendering takes, and the counters to show
+      /// in the stats overlay.  The overlay is toggled by pressing 's'.  It
+      /// graphs the recent frame times along the bottom of the window, with
+      /// a line at 60 fps, and has one bar per time counter (in the order of
+      /// PerfStats::Counter) down the left.  Each bar shows the median, 99th
+      /// percentile and maximum time in green, yellow and red.
+      static void setStats(PerfStats* stats);
+
+      /// Drawing doesn't go straight to OpenGL.  The shapes are turned into
+      /// vertices, gathered into one array per color, and drawn at the end
+      /// of the frame with a couple of calls per color: all the filled
+      /// shapes, then all the lines.  So shapes are drawn in color order,
+      /// not in the order they were drawn in.
+      static void drawCircle(RealVec2 const& center, RealVec2 const& orientation, Real const radius);
+      static void drawArrow(RealVec2 const& begin, RealVec2 const& direction);
+      static void drawLineSegment(RealVec2 const& begin, RealVec2 const& end);
       static void setColor(RealVec const& color);
 
       /// Pause for t milliseconds.
@@ -50,7 +64,33 @@ namespace tagGame
    protected:
    private:
       static void initGL(int const width, int const height);
-      static GLUquadric* q;
+      static void drawStats();
+      /// Draw everything gathered so far.
+      static void flush();
+
+      // The vertices (as x, y pairs) to draw in one color.
+      struct Batch
+      {
+         float color[colorDim];
+         std::vector<float> triangles;
+         std::vector<float> lines;
+      };
+
+      // The batches in use are the first batchCount, in the order their
+      // colors were first set.  The rest are kept, so that their memory can
+      // be reused next frame.
+      static std::vector<Batch> batches;
+      static size_t batchCount;
+      static Batch* current;
+
+      // A circle of radius 1, as circleSlices + 1 points (the first point
+      // repeated at the end).
+      static int const circleSlices = 20;
+      static float unitCircle[2 * (circleSlices + 1)];
+      static PerfStats* stats;
+      static bool isShowStats;
+      static int width;
+      static int height;
    };
 }
 
@@ -0,0 +1,97 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_HANDLE_H
+#define TG_HANDLE_H
+
+#include "Util.h"
+
+namespace tagGame
+{
+   /// A reference to a character or obstacle in a game-state (see
+   /// GameState::getCharacter).  A handle names a slot and the generation of
+   /// the slot it was made for.  Each time something is removed from the
+   /// game-state, its slot's generation goes up, so a handle to it is
+   /// detected as stale instead of being left dangling like a pointer would.
+   /// The default handle refers to nothing.
+   class Handle
+   {
+   public:
+      inline Handle();
+      inline Handle(size_t const slot, unsigned int const generation);
+
+      inline bool isNull() const;
+      inline size_t getSlot() const;
+      inline unsigned int getGeneration() const;
+
+      inline bool operator==(Handle const& h) const;
+      inline bool operator!=(Handle const& h) const;
+      /// An arbitrary order, e.g. for use as a map key.
+      inline bool operator<(Handle const& h) const;
+
+      static size_t const nullSlot = size_t(-1);
+
+   protected:
+   private:
+      size_t slot;
+      unsigned int generation;
+   };
+
+   Handle::Handle() :
+      slot(nullSlot),
+      generation(0)
+   {
+   }
+
+   Handle::Handle(size_t const slot, unsigned int const generation) :
+      slot(slot),
+      generation(generation)
+   {
+   }
+
+   bool Handle::isNull() const
+   {
+      return nullSlot == slot;
+   }
+
+   size_t Handle::getSlot() const
+   {
+      return slot;
+   }
+
+   unsigned int Handle::getGeneration() const
+   {
+      return generation;
+   }
+
+   bool Handle::operator==(Handle const& h) const
+   {
+      return slot == h.slot && generation == h.generation;
+   }
+
+   bool Handle::operator!=(Handle const& h) const
+   {
+      return !(*this == h);
+   }
+
+   bool Handle::operator<(Handle const& h) const
+   {
+      return slot < h.slot || (slot == h.slot && generation < h.generation);
+   }
+}
+
+#endif
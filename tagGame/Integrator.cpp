@@ -0,0 +1,317 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+
+#include "Integrator.h"
+
+#if !defined(TG_NO_SIMD) && defined(__AVX__)
+#define TG_USE_AVX
+#endif
+
+#if !defined(TG_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && 2 <= _M_IX86_FP))
+#define TG_USE_SSE2
+#endif
+
+#if defined(TG_USE_AVX)
+#include <immintrin.h>
+#elif defined(TG_USE_SSE2)
+#include <emmintrin.h>
+#endif
+
+using namespace tagGame;
+
+using namespace std;
+
+// The scalar versions are exactly the same operations, in the same order, as
+// the simulator used to apply a character at a time.  The SIMD versions below
+// must stay in step with them.
+void Integrator::accelerateScalar(EntityStore& store, vector<RealVec2> const& desiredDirections,
+                                  vector<Real> const& desiredSpeeds, Real const deltaT)
+{
+   for (size_t i = 0; i < store.size(); i++)
+   {
+      Real const mass = store.getMasses()[i];
+      Real const maxSpeed = store.getMaxSpeed(i);
+
+      // calculate character's required acceleration from the desired velocity
+      RealVec2 acceleration(desiredDirections[i]);
+      acceleration.scale(desiredSpeeds[i] * maxSpeed);
+      acceleration.subtract(store.getVelocity(i));
+      // calculate required force from the acceleration
+      RealVec2 force(acceleration.scale(mass));
+      // force can't be greater than the maximum possible force
+      force.clampMaxLength(store.getMaxForces()[i]);
+      // re-calculate acceleration for new (possibly) clamped force
+      acceleration = force.scale(1.0/mass);
+      acceleration.scale(deltaT);
+      // v = character's current velocity
+      RealVec2 v(store.getVelocity(i));
+      v.add(acceleration);
+
+      v.clampMaxLength(maxSpeed);
+
+      store.setVelocity(i, v);
+   }
+}
+
+void Integrator::moveScalar(EntityStore& store, RealVec2 const& worldDim, Real const deltaT)
+{
+   vector<RealVec2>& positions(store.getPositions());
+
+   for (size_t i = 0; i < store.size(); i++)
+   {
+      RealVec2 v(store.getVelocity(i));
+      v.scale(deltaT);
+      positions[i].add(v);
+      positions[i].wrap(worldDim);
+   }
+}
+
+#if defined(TG_USE_SSE2)
+
+// Each SIMD register holds the 2D vectors of one (SSE2) or two (AVX)
+// characters.  Per-character scalars are repeated across both lanes of their
+// character's vector, so that all the arithmetic is lane by lane and rounds
+// exactly like the scalar code.
+namespace
+{
+   struct Sse2
+   {
+      typedef __m128d Type;
+      static size_t const width = 1;
+
+      static inline Type load(Real const* p) { return _mm_loadu_pd(p); }
+      static inline void store(Real* p, Type a) { _mm_storeu_pd(p, a); }
+      static inline Type set1(Real const x) { return _mm_set1_pd(x); }
+      // One scalar per character.
+      static inline Type broadcast(Real const* x) { return _mm_set1_pd(x[0]); }
+      static inline void extract(Real* x, Type a) { x[0] = _mm_cvtsd_f64(a); }
+      // The same 2D vector for every character.
+      static inline Type repeat(Real const* p) { return _mm_loadu_pd(p); }
+      static inline Type zero() { return _mm_setzero_pd(); }
+
+      static inline Type add(Type a, Type b) { return _mm_add_pd(a, b); }
+      static inline Type sub(Type a, Type b) { return _mm_sub_pd(a, b); }
+      static inline Type mul(Type a, Type b) { return _mm_mul_pd(a, b); }
+      static inline Type div(Type a, Type b) { return _mm_div_pd(a, b); }
+
+      // The length of each character's vector, in both its lanes.
+      static inline Type length(Type a)
+      {
+         Type const sq = _mm_mul_pd(a, a);
+         Type l = _mm_add_sd(sq, _mm_unpackhi_pd(sq, sq));
+         l = _mm_sqrt_sd(l, l);
+         return _mm_unpacklo_pd(l, l);
+      }
+
+      static inline Type lessThan(Type a, Type b) { return _mm_cmplt_pd(a, b); }
+      static inline Type lessEqual(Type a, Type b) { return _mm_cmple_pd(a, b); }
+      static inline Type notLessEqual(Type a, Type b) { return _mm_cmpnle_pd(a, b); }
+      static inline Type either(Type m0, Type m1) { return _mm_or_pd(m0, m1); }
+      static inline bool any(Type m) { return 0 != _mm_movemask_pd(m); }
+      // a where m is set, otherwise b.
+      static inline Type select(Type m, Type a, Type b) { return _mm_or_pd(_mm_and_pd(m, a), _mm_andnot_pd(m, b)); }
+   };
+
+#if defined(TG_USE_AVX)
+   struct Avx
+   {
+      typedef __m256d Type;
+      static size_t const width = 2;
+
+      static inline Type load(Real const* p) { return _mm256_loadu_pd(p); }
+      static inline void store(Real* p, Type a) { _mm256_storeu_pd(p, a); }
+      static inline Type set1(Real const x) { return _mm256_set1_pd(x); }
+      static inline Type broadcast(Real const* x) { return _mm256_set_pd(x[1], x[1], x[0], x[0]); }
+      static inline void extract(Real* x, Type a)
+      {
+         Real y[4];
+         _mm256_storeu_pd(y, a);
+         x[0] = y[0];
+         x[1] = y[2];
+      }
+      static inline Type repeat(Real const* p) { return _mm256_set_pd(p[1], p[0], p[1], p[0]); }
+      static inline Type zero() { return _mm256_setzero_pd(); }
+
+      static inline Type add(Type a, Type b) { return _mm256_add_pd(a, b); }
+      static inline Type sub(Type a, Type b) { return _mm256_sub_pd(a, b); }
+      static inline Type mul(Type a, Type b) { return _mm256_mul_pd(a, b); }
+      static inline Type div(Type a, Type b) { return _mm256_div_pd(a, b); }
+
+      static inline Type length(Type a)
+      {
+         Type const sq = _mm256_mul_pd(a, a);
+         return _mm256_sqrt_pd(_mm256_hadd_pd(sq, sq));
+      }
+
+      static inline Type lessThan(Type a, Type b) { return _mm256_cmp_pd(a, b, _CMP_LT_OQ); }
+      static inline Type lessEqual(Type a, Type b) { return _mm256_cmp_pd(a, b, _CMP_LE_OQ); }
+      static inline Type notLessEqual(Type a, Type b) { return _mm256_cmp_pd(a, b, _CMP_NLE_UQ); }
+      static inline Type either(Type m0, Type m1) { return _mm256_or_pd(m0, m1); }
+      static inline bool any(Type m) { return 0 != _mm256_movemask_pd(m); }
+      static inline Type select(Type m, Type a, Type b) { return _mm256_blendv_pd(b, a, m); }
+   };
+#endif
+
+   // Same as Vec::clampMaxLength.
+   template <class P>
+   inline typename P::Type clampMaxLength(typename P::Type v, typename P::Type y)
+   {
+      typedef typename P::Type Type;
+
+      Type const l = P::length(v);
+      Type const isTooLong = P::lessThan(y, l);
+      // See MathUtil::isAlmostZero
+      Type const isZero = P::lessEqual(l, P::set1(Eps));
+      Type const clamped = P::select(isZero, P::zero(), P::mul(P::div(y, l), v));
+
+      return P::select(isTooLong, clamped, v);
+   }
+
+   template <class P>
+   void accelerate(EntityStore& store, vector<RealVec2> const& desiredDirections,
+                   vector<Real> const& desiredSpeeds, Real const deltaT,
+                   size_t const begin, size_t const end)
+   {
+      typedef typename P::Type Type;
+      size_t const w = P::width;
+
+      vector<RealVec2>& orientations(store.getOrientations());
+      vector<Real>& speeds(store.getSpeeds());
+      vector<Real> const& masses(store.getMasses());
+      vector<Real> const& maxForces(store.getMaxForces());
+
+      Type const dt = P::set1(deltaT);
+      Type const eps = P::set1(Eps);
+      Type const one = P::set1(1);
+
+      for (size_t i = begin; i + w <= end; i += w)
+      {
+         Real maxSpeed[w];
+         Real desiredScale[w];
+         Real inverseMass[w];
+         for (size_t k = 0; k < w; k++)
+         {
+            TG_ASSERT(masses[i + k] < Inf); // Infinitely heavy object can't move
+            maxSpeed[k] = store.getMaxSpeed(i + k);
+            desiredScale[k] = desiredSpeeds[i + k] * maxSpeed[k];
+            inverseMass[k] = 1.0/masses[i + k];
+         }
+
+         Type const orientation = P::load(&orientations[i][0]);
+         Type const u = P::mul(P::broadcast(&speeds[i]), orientation);
+
+         Type acceleration = P::mul(P::broadcast(desiredScale), P::load(&desiredDirections[i][0]));
+         acceleration = P::sub(acceleration, u);
+         Type force = P::mul(P::broadcast(&masses[i]), acceleration);
+         force = clampMaxLength<P>(force, P::broadcast(&maxForces[i]));
+         acceleration = P::mul(P::broadcast(inverseMass), force);
+         acceleration = P::mul(dt, acceleration);
+         Type v = P::add(u, acceleration);
+         v = clampMaxLength<P>(v, P::broadcast(maxSpeed));
+
+         // Same as EntityStore::setVelocity.
+         Type const speed = P::length(v);
+         Type const isMoving = P::notLessEqual(speed, eps);
+         P::store(&orientations[i][0], P::select(isMoving, P::mul(P::div(one, speed), v), orientation));
+         P::extract(&speeds[i], P::select(isMoving, speed, P::zero()));
+      }
+   }
+
+   template <class P>
+   void move(EntityStore& store, RealVec2 const& worldDim, Real const deltaT,
+             size_t const begin, size_t const end)
+   {
+      typedef typename P::Type Type;
+      size_t const w = P::width;
+
+      vector<RealVec2>& positions(store.getPositions());
+      vector<RealVec2> const& orientations(store.getOrientations());
+      vector<Real> const& speeds(store.getSpeeds());
+
+      Type const dt = P::set1(deltaT);
+      Type const dim = P::repeat(&worldDim[0]);
+
+      for (size_t i = begin; i + w <= end; i += w)
+      {
+         Type v = P::mul(P::broadcast(&speeds[i]), P::load(&orientations[i][0]));
+         v = P::mul(dt, v);
+         Type p = P::add(P::load(&positions[i][0]), v);
+
+         // Wrap once, which is nearly always enough, and finish off any
+         // stragglers with the scalar version.
+         p = P::select(P::lessThan(p, P::zero()), P::add(p, dim), p);
+         p = P::select(P::lessThan(dim, p), P::sub(p, dim), p);
+         P::store(&positions[i][0], p);
+
+         if (P::any(P::either(P::lessThan(p, P::zero()), P::lessThan(dim, p))))
+         {
+            for (size_t k = 0; k < w; k++)
+            {
+               positions[i + k].wrap(worldDim);
+            }
+         }
+      }
+   }
+}
+
+#endif
+
+void Integrator::accelerate(EntityStore& store, vector<RealVec2> const& desiredDirections,
+                            vector<Real> const& desiredSpeeds, Real const deltaT)
+{
+   size_t const n = store.size();
+   TG_ASSERT(desiredDirections.size() == n && desiredSpeeds.size() == n);
+
+#if defined(TG_USE_AVX)
+   size_t const m = n - n % Avx::width;
+   ::accelerate<Avx>(store, desiredDirections, desiredSpeeds, deltaT, 0, m);
+   ::accelerate<Sse2>(store, desiredDirections, desiredSpeeds, deltaT, m, n);
+#elif defined(TG_USE_SSE2)
+   ::accelerate<Sse2>(store, desiredDirections, desiredSpeeds, deltaT, 0, n);
+#else
+   accelerateScalar(store, desiredDirections, desiredSpeeds, deltaT);
+#endif
+}
+
+void Integrator::move(EntityStore& store, RealVec2 const& worldDim, Real const deltaT)
+{
+   // otherwise wrapping loops forever
+   TG_ASSERT(0 < worldDim[0] && 0 < worldDim[1]);
+
+#if defined(TG_USE_AVX)
+   size_t const n = store.size();
+   size_t const m = n - n % Avx::width;
+   ::move<Avx>(store, worldDim, deltaT, 0, m);
+   ::move<Sse2>(store, worldDim, deltaT, m, n);
+#elif defined(TG_USE_SSE2)
+   ::move<Sse2>(store, worldDim, deltaT, 0, store.size());
+#else
+   moveScalar(store, worldDim, deltaT);
+#endif
+}
+
+char const* Integrator::getInstructionSet()
+{
+#if defined(TG_USE_AVX)
+   return "avx";
+#elif defined(TG_USE_SSE2)
+   return "sse2";
+#else
+   return "scalar";
+#endif
+}
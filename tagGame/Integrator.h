@@ -0,0 +1,54 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_INTEGRATOR_H
+#define TG_INTEGRATOR_H
+
+#include "EntityStore.h"
+
+namespace tagGame
+{
+   /// Batched versions of the simulator's per-character physics steps.
+   /// Each step runs over the contiguous arrays of a whole entity store in
+   /// one pass.  If the compiler targets AVX or SSE2 (and TG_NO_SIMD isn't
+   /// defined) the steps use SIMD instructions, otherwise they fall back to
+   /// scalar code.  All versions give bit-identical results.
+   class Integrator
+   {
+   public:
+      /// Steer every character in store towards its desired velocity
+      /// (direction desiredDirections[id] and a fraction desiredSpeeds[id]
+      /// of its maximum speed), subject to its maximum force and speed.
+      static void accelerate(EntityStore& store, std::vector<RealVec2> const& desiredDirections,
+                             std::vector<Real> const& desiredSpeeds, Real const deltaT);
+
+      /// Move every character in store at its current velocity for deltaT
+      /// and wrap its position to stay inside worldDim.
+      static void move(EntityStore& store, RealVec2 const& worldDim, Real const deltaT);
+
+      /// Scalar versions of the above, used when SIMD isn't available, and as
+      /// a reference to check the SIMD versions against.
+      static void accelerateScalar(EntityStore& store, std::vector<RealVec2> const& desiredDirections,
+                                   std::vector<Real> const& desiredSpeeds, Real const deltaT);
+      static void moveScalar(EntityStore& store, RealVec2 const& worldDim, Real const deltaT);
+
+      /// The instruction set in use: "avx", "sse2" or "scalar".
+      static char const* getInstructionSet();
+   };
+}
+
+#endif
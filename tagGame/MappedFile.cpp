@@ -0,0 +1,69 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#include "MappedFile.h"
+
+#include <cstdio>
+
+#if defined(TG_USE_MMAP)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace tagGame;
+
+using namespace std;
+
+MappedFile::MappedFile(string const& fileName) :
+   data(NULL),
+   size(0)
+{
+#if defined(TG_USE_MMAP)
+   int const fd = open(fileName.c_str(), O_RDONLY);
+   if (fd < 0) { Util::error("MappedFile: can't open " + fileName); }
+   struct stat s;
+   if (0 != fstat(fd, &s)) { Util::error("MappedFile: can't read " + fileName); }
+   size = size_t(s.st_size);
+   if (0 < size)
+   {
+      void* const p = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (MAP_FAILED == p) { Util::error("MappedFile: can't map " + fileName); }
+      data = static_cast<char const*>(p);
+   }
+   // The mapping keeps the file open.
+   close(fd);
+#else
+   FILE* const file = fopen(fileName.c_str(), "rb");
+   if (!file) { Util::error("MappedFile: can't open " + fileName); }
+   fseek(file, 0, SEEK_END);
+   size = size_t(ftell(file));
+   fseek(file, 0, SEEK_SET);
+   buffer.resize(size);
+   if (0 < size && 1 != fread(&buffer[0], size, 1, file)) { Util::error("MappedFile: can't read " + fileName); }
+   fclose(file);
+   data = buffer.empty() ? NULL : &buffer[0];
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#if defined(TG_USE_MMAP)
+   if (data) { munmap(const_cast<char*>(data), size); }
+#endif
+}
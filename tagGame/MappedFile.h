@@ -0,0 +1,67 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_MAPPED_FILE_H
+#define TG_MAPPED_FILE_H
+
+#include "Util.h"
+
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32)
+#define TG_USE_MMAP 1
+#endif
+
+namespace tagGame
+{
+   /// A read-only view of a whole file in memory.  The file is memory
+   /// mapped where that's supported, so nothing is read until it's used,
+   /// otherwise it is read in.
+   class MappedFile
+   {
+   public:
+      explicit MappedFile(std::string const& fileName);
+      ~MappedFile();
+
+      inline char const* getData() const;
+      inline size_t getSize() const;
+   protected:
+   private:
+      // Not copyable.
+      MappedFile(MappedFile const&);
+      MappedFile& operator=(MappedFile const&);
+
+      char const* data;
+      size_t size;
+#if !defined(TG_USE_MMAP)
+      std::vector<char> buffer;
+#endif
+   };
+
+   char const* MappedFile::getData() const
+   {
+      return data;
+   }
+
+   size_t MappedFile::getSize() const
+   {
+      return size;
+   }
+}
+
+#endif
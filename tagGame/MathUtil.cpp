@@ -0,0 +1,38 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#include "MathUtil.h"
+#include "Random.h"
+
+using namespace tagGame;
+
+using namespace std;
+
+Real MathUtil::uniform01()
+{
+   return Random::current().uniform01();
+}
+
+int MathUtil::uniform(int n)
+{
+   return Random::current().uniform(n);
+}
+
+Real MathUtil::normal(Real const mean, Real const std)
+{
+   return Random::current().normal(mean, std);
+}
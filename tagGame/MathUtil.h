@@ -36,6 +36,8 @@ namespace tagGame
    typedef double Real;
 
    Real const Inf = HUGE_VAL;
+   // Tolerance for isAlmostEq.
+   Real const Eps = 0.00001;
 
    /// Some basic math related utility functions. 
    class MathUtil
@@ -68,15 +70,19 @@ namespace tagGame
       /// angle 180 and we only want one representation for an angle.
       inline static Real angleClamp(Real const t);
 
-      /// Uniformly pick a Real in the range [0, 1].
-      inline static Real uniform01();
+      // The random functions draw from the calling thread's current
+      // stream (see Random::current).  Code that draws a lot of numbers in
+      // a loop can save a little by using the stream directly.
+
+      /// Uniformly pick a Real in the range [0, 1).
+      static Real uniform01();
 
       /// Uniformly pick an integer in the range [0, n).
-      inline static int uniform(int n);
+      static int uniform(int n);
 
       /// Pick a Real according to the normal distribution with mean and standard
       /// deviation as provided.
-      inline static Real normal(Real const mean = Real(0), Real const std = Real(1));
+      static Real normal(Real const mean = Real(0), Real const std = Real(1));
 
       /// Pick an angle (in degrees) according to an approximate normal distribution.
       /// The normal distribution is only approximate because there is only finite support
@@ -91,9 +97,7 @@ namespace tagGame
    // TODO: make this relative
    bool MathUtil::isAlmostEq(Real const x, Real const y)
    {
-      Real const eps = 0.00001;
-   
-      return (fabs(x - y) <= eps) || (x == Inf && y == Inf);
+      return (fabs(x - y) <= Eps) || (x == Inf && y == Inf);
    }
    
    bool MathUtil::isAlmostZero(Real const x)
@@ -121,19 +125,6 @@ namespace tagGame
       return x * M_PI / Real(180);
    }
    
-   Real MathUtil::uniform01()
-   {
-      // TODO: use a better random number generator.
-      return Real(rand())/Real(RAND_MAX);
-   }
-   
-   int MathUtil::uniform(int n)
-   {
-      TG_ASSERT_MSG(n <= RAND_MAX, "n: " + Util::itos(n) + " must be <= RAND_MAX: " + Util::itos(RAND_MAX));
-      // TODO: use a better random number generator.
-      return rand() % n;
-   }
-   
    Real MathUtil::clamp(Real x, Real lower, Real upper)
    {
       TG_ASSERT(lower <= upper);
@@ -155,34 +146,6 @@ namespace tagGame
    {
       return angleClamp(normal(mean, std));
    }
-
-   // draw number from a normal random distribution
-   Real MathUtil::normal(Real const mean, Real const std)
-   {
-      // For an explanation of the theory behind this code see:
-      // Eric W. Weisstein. "Box-Muller Transformation." From MathWorld--A Wolfram Web Resource.
-      // http://mathworld.wolfram.com/Box-MullerTransformation.html
-
-      static bool validCache(false);
-      static Real rho(0);
-      static Real r1(0);
-      // Real const pi(3.14159265358979323846);
-
-      if (!validCache)
-      {
-         Real const r0(uniform01());
-         r1 = uniform01();
-         rho = sqrt(-Real(2) * log(Real(1) - r0));
-         validCache = true;
-
-         return rho * cos(Real(2) * M_PI * r1) * std + mean;
-      }
-      else
-      {
-         validCache = false;
-      }
-      return rho * sin(Real(2) * M_PI * r1) * std + mean;
-   }
 }
 
 #endif
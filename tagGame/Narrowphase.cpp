@@ -0,0 +1,166 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#include "Narrowphase.h"
+#include "Util2D.h"
+
+#include <cmath>
+
+#if !defined(TG_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && 2 <= _M_IX86_FP))
+#define TG_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace tagGame;
+
+using namespace std;
+
+namespace
+{
+   // Pairs are done a block at a time: first their state is gathered into
+   // separate arrays, then the arithmetic for all the pairs of circles in the
+   // block is done in a loop without any branches.  If the compiler targets
+   // SSE2 (see Integrator.h), the loop does two pairs at a time.
+   size_t const blockSize = 64;
+}
+
+void Narrowphase::evaluate(EntityStore const& store, EntityStore const& obstacles, vector<Pair> const& pairs,
+                           vector<Real>& distances, vector<RealVec2>& normals, vector<Real>* approachSpeeds)
+{
+   size_t const pairCount = pairs.size();
+   distances.resize(pairCount);
+   normals.resize(pairCount, RealVec2(Util2D::dim));
+   if (approachSpeeds) { approachSpeeds->resize(pairCount); }
+
+   // This code assumes 2D.
+   TG_ASSERT(2 == Util2D::dim);
+
+   // The gathered state of each pair of circles.
+   size_t circles[blockSize];
+   Real dx[blockSize], dy[blockSize], r0[blockSize], r1[blockSize];
+   Real u0[blockSize], u1[blockSize], w0[blockSize], w1[blockSize];
+   // And the results.
+   Real d[blockSize], n0[blockSize], n1[blockSize], a[blockSize];
+
+   for (size_t begin = 0; begin < pairCount; begin += blockSize)
+   {
+      size_t const end = min(begin + blockSize, pairCount);
+      size_t circleCount = 0;
+
+      for (size_t k = begin; k < end; k++)
+      {
+         Pair const& pair(pairs[k]);
+         EntityStore const& other(pair.isObstacle ? obstacles : store);
+         EntityStore::ShapeKind const kind0 = store.getShapeKinds()[pair.i];
+         EntityStore::ShapeKind const kind1 = other.getShapeKinds()[pair.j];
+         RealVec2 const& p0(store.getPositions()[pair.i]);
+         RealVec2 const& p1(other.getPositions()[pair.j]);
+
+         if (EntityStore::circleShape == kind0 && EntityStore::circleShape == kind1)
+         {
+            RealVec2 const& o0(store.getOrientations()[pair.i]);
+            RealVec2 const& o1(other.getOrientations()[pair.j]);
+            Real const s0 = store.getSpeeds()[pair.i];
+            Real const s1 = other.getSpeeds()[pair.j];
+
+            circles[circleCount] = k;
+            dx[circleCount] = p1[0] - p0[0];
+            dy[circleCount] = p1[1] - p0[1];
+            r0[circleCount] = store.getRadii()[pair.i];
+            r1[circleCount] = other.getRadii()[pair.j];
+            u0[circleCount] = o0[0] * s0;
+            u1[circleCount] = o0[1] * s0;
+            w0[circleCount] = o1[0] * s1;
+            w1[circleCount] = o1[1] * s1;
+            circleCount++;
+            continue;
+         }
+
+         // Anything else is rare enough to do one at a time.
+         RealVec2 n(Util2D::dim);
+         Real distance = Inf;
+         if (EntityStore::circleShape == kind0 && EntityStore::sideShape == kind1)
+         {
+            // A side's normal and distance are stored as its orientation and
+            // radius (see Side::setNormal).
+            n = other.getOrientations()[pair.j];
+            n.scale(-1);
+            distance = sideDistance(other.getOrientations()[pair.j], other.getRadii()[pair.j], p0, store.getRadii()[pair.i]);
+         }
+         else if (EntityStore::sideShape == kind0 && EntityStore::circleShape == kind1)
+         {
+            n = store.getOrientations()[pair.i];
+            distance = sideDistance(store.getOrientations()[pair.i], store.getRadii()[pair.i], p1, other.getRadii()[pair.j]);
+         }
+         else
+         {
+            Util::error("Narrowphase::evaluate not implemented for these shapes");
+         }
+
+         distances[k] = distance;
+         normals[k] = n;
+         if (approachSpeeds)
+         {
+            (*approachSpeeds)[k] = approachSpeed(store.getVelocity(pair.i), other.getVelocity(pair.j), n);
+         }
+      }
+
+      // The same arithmetic, in the same order, as circleDistance,
+      // circleNormal and approachSpeed, so the results are identical.
+      size_t c = 0;
+#if defined(TG_USE_SSE2)
+      __m128d const eps = _mm_set1_pd(Eps);
+      __m128d const one = _mm_set1_pd(1);
+      for (; c + 2 <= circleCount; c += 2)
+      {
+         __m128d const x = _mm_loadu_pd(dx + c);
+         __m128d const y = _mm_loadu_pd(dy + c);
+         __m128d const length = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)));
+         // The length can't be negative, so there's no need for the fabs.
+         __m128d const scale = _mm_andnot_pd(_mm_cmple_pd(length, eps), _mm_div_pd(one, length));
+         __m128d const nx = _mm_mul_pd(x, scale);
+         __m128d const ny = _mm_mul_pd(y, scale);
+         __m128d const a0 = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(u0 + c), nx), _mm_mul_pd(_mm_loadu_pd(u1 + c), ny));
+         __m128d const a1 = _mm_add_pd(_mm_mul_pd(_mm_loadu_pd(w0 + c), nx), _mm_mul_pd(_mm_loadu_pd(w1 + c), ny));
+
+         _mm_storeu_pd(d + c, _mm_sub_pd(_mm_sub_pd(length, _mm_loadu_pd(r1 + c)), _mm_loadu_pd(r0 + c)));
+         _mm_storeu_pd(n0 + c, nx);
+         _mm_storeu_pd(n1 + c, ny);
+         _mm_storeu_pd(a + c, _mm_sub_pd(a0, a1));
+      }
+#endif
+      for (; c < circleCount; c++)
+      {
+         Real const length = sqrt(dx[c] * dx[c] + dy[c] * dy[c]);
+         Real const scale = fabs(length) <= Eps ? Real(0) : Real(1) / length;
+
+         d[c] = length - r1[c] - r0[c];
+         n0[c] = dx[c] * scale;
+         n1[c] = dy[c] * scale;
+         a[c] = (u0[c] * n0[c] + u1[c] * n1[c]) - (w0[c] * n0[c] + w1[c] * n1[c]);
+      }
+
+      for (c = 0; c < circleCount; c++)
+      {
+         size_t const k = circles[c];
+         distances[k] = d[c];
+         normals[k][0] = n0[c];
+         normals[k][1] = n1[c];
+         if (approachSpeeds) { (*approachSpeeds)[k] = a[c]; }
+      }
+   }
+}
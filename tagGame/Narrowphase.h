@@ -0,0 +1,88 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_NARROWPHASE_H
+#define TG_NARROWPHASE_H
+
+#include "EntityStore.h"
+
+namespace tagGame
+{
+   /// Batched versions of the shape queries the simulator makes about pairs
+   /// of objects that are close enough to touch.  Rather than asking each
+   /// shape through the virtual functions in Shape (two virtual calls per
+   /// query), the kind of each entity's shape is read from its entity store
+   /// (see EntityStore::getShapeKinds) and a whole array of pairs is done in
+   /// one pass.  The virtual functions give identical results, as they are
+   /// implemented using the same per-pair functions below.
+   class Narrowphase
+   {
+   public:
+      /// Entity i of the first store and entity j of the second store, if
+      /// isObstacle is true, or of the first store otherwise.
+      struct Pair
+      {
+         size_t i;
+         size_t j;
+         bool isObstacle;
+      };
+
+      /// For each pair, calculate the distance from i to j (negative if they
+      /// overlap), the normal from i to j (see Shape::normalTo) and, if
+      /// approachSpeeds isn't NULL, how fast they are moving towards each
+      /// other along the normal (see Obstacle::isColliding).
+      static void evaluate(EntityStore const& store, EntityStore const& obstacles, std::vector<Pair> const& pairs,
+                           std::vector<Real>& distances, std::vector<RealVec2>& normals,
+                           std::vector<Real>* approachSpeeds = NULL);
+
+      /// The distance between circles at p0 and p1.
+      inline static Real circleDistance(RealVec2 const& p0, Real const r0, RealVec2 const& p1, Real const r1);
+      /// The normal from a circle at p0 to a circle at p1.
+      inline static RealVec2 circleNormal(RealVec2 const& p0, RealVec2 const& p1);
+      /// The distance between a side and a circle at p.
+      inline static Real sideDistance(RealVec2 const& normal, Real const distance, RealVec2 const& p, Real const r);
+      /// How fast something moving with velocity v0 is approaching something
+      /// moving with velocity v1 along the normal n.
+      inline static Real approachSpeed(RealVec2 const& v0, RealVec2 const& v1, RealVec2 const& n);
+   };
+
+   Real Narrowphase::circleDistance(RealVec2 const& p0, Real const r0, RealVec2 const& p1, Real const r1)
+   {
+      return (p0.relativeTo(p1)).length() - r0 - r1;
+   }
+
+   RealVec2 Narrowphase::circleNormal(RealVec2 const& p0, RealVec2 const& p1)
+   {
+      return (p1.relativeTo(p0)).normalize();
+   }
+
+   Real Narrowphase::sideDistance(RealVec2 const& normal, Real const distance, RealVec2 const& p, Real const r)
+   {
+      return Inf; // TODO: delete this line to turn collisions with sides back on
+
+      Real const d = normal.dot(p) - distance;
+
+      return d < 0 ? d + r : d - r;
+   }
+
+   Real Narrowphase::approachSpeed(RealVec2 const& v0, RealVec2 const& v1, RealVec2 const& n)
+   {
+      return v0.dot(n) - v1.dot(n);
+   }
+}
+
+#endif
@@ -26,16 +26,32 @@ Obstacle::Obstacle(ShapePtr shape) :
 #if !defined(TG_USE_TR1)
    renderer(NULL),
 #endif
-   shape(shape),
-   speed(0),
-   mass(Inf) // By default objects are too heavy to move
+   store(shape->getStore()),
+   id(shape->getId()),
+   shape(shape)
 {
+   store->getSpeeds()[id] = 0;
+   store->getMasses()[id] = Inf; // By default objects are too heavy to move
 }
 
 Obstacle::~Obstacle()
 {
 }
 
+void Obstacle::bind(EntityStore* store, size_t const id, EntityStorePtr owner)
+{
+   shape->bind(store, id, owner);
+   this->store = store;
+   this->id = id;
+}
+
+void Obstacle::detach()
+{
+   EntityStorePtr owner(new EntityStore());
+   size_t const newId = owner->add(*store, id);
+   bind(owner.get(), newId, owner);
+}
+
 void Obstacle::render()
 {
    if (renderer) { renderer->render(this); }
@@ -44,8 +60,8 @@ void Obstacle::render()
 ostream& Obstacle::output(ostream& out) const
 {
    shape->output(out);
-   out << "mass: " << mass << endl;
-   out << "speed: " << speed << endl;
+   out << "mass: " << getMass() << endl;
+   out << "speed: " << getSpeed() << endl;
 
    return out;
 }
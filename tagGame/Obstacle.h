@@ -20,6 +20,7 @@
 
 #include "Vec.h"
 #include "Shape.h"
+#include "Narrowphase.h"
 
 namespace tagGame
 {
@@ -43,44 +44,67 @@ namespace tagGame
 
       inline Shape const& getShape() const;
 
-      inline RealVec const& getPosition() const;
-      inline void setPosition(RealVec const& position);
+      /// Obstacles are views onto an entity in a store (see EntityStore).
+      /// Binding an obstacle makes it (and its shape) refer to entity id in
+      /// store instead.  It is up to the caller to copy over the obstacle's
+      /// current state first.  If owner is given, the obstacle keeps it alive.
+      void bind(EntityStore* store, size_t const id, EntityStorePtr owner = EntityStorePtr());
+      /// Copy the obstacle's state into a new store of its own, e.g. because
+      /// the store it is bound to is about to be destroyed.
+      void detach();
+      inline EntityStore* getStore() const;
+      inline size_t getId() const;
+      /// The obstacle's handle in the game-state it has been added to, which
+      /// is null if it hasn't been added (or stale if it has been removed).
+      inline Handle getHandle() const;
+
+      inline RealVec2 const& getPosition() const;
+      inline void setPosition(RealVec2 const& position);
       inline Real getSpeed() const;
       inline void setSpeed(Real const Speed);
       inline Real const& getMass() const;
       inline void setMass(Real const mass);
 
-      inline RealVec getVelocity() const;
-      inline void setVelocity(RealVec const& velocity);
+      inline RealVec2 getVelocity() const;
+      inline void setVelocity(RealVec2 const& velocity);
 
-      inline RealVec const& getOrientation() const;
-      inline void setOrientation(RealVec const& orientation);
+      inline RealVec2 const& getOrientation() const;
+      inline void setOrientation(RealVec2 const& orientation);
 
       void render();
 
       virtual std::ostream& output(std::ostream& out) const;
 
+      /// See Shape::getBounds.
+      inline bool getBounds(RealVec2& lower, RealVec2& upper) const;
+
       inline bool isTouching(Obstacle const& o) const;
       inline bool isColliding(Obstacle const& o) const;
 
       /// Calculate the nearest intersection point of a line in the
       /// direction v from the point p.
-      inline RealVec nearestIntersection(RealVec const& p, RealVec const& v) const;
+      inline RealVec2 nearestIntersection(RealVec2 const& p, RealVec2 const& v) const;
 
       /// Return a vector that is normal to o, with respect to this.
-      inline RealVec normalTo(Obstacle const& o) const;
+      inline RealVec2 normalTo(Obstacle const& o) const;
 
       inline Real distanceTo(Obstacle const& o) const;
 
       inline Real distanceSquaredTo(Obstacle const& o) const;
 
+      /// See Shape::timeToImpact.  Both obstacles keep their current velocities.
+      inline Real timeToImpact(Obstacle const& o, Real& leave) const;
+
    protected:
       RendererPtr renderer;
 
+      // Where this obstacle's state is stored.  Same as for the shape, but
+      // kept here too to save following the shape pointer.
+      EntityStore* store;
+      size_t id;
+
    private:
       ShapePtr shape;
-      Real speed;
-      Real mass;
    };
 
    typedef std::vector<ObstaclePtr> ObstacleList;
@@ -89,72 +113,80 @@ namespace tagGame
 
    std::ostream& operator<<(std::ostream& out, Obstacle const& o);
 
-   RealVec const& Obstacle::getPosition() const
+   EntityStore* Obstacle::getStore() const
+   {
+      return store;
+   }
+
+   size_t Obstacle::getId() const
    {
-      return shape->getPosition();
+      return id;
    }
 
-   void Obstacle::setPosition(RealVec const& position)
+   Handle Obstacle::getHandle() const
    {
-      shape->setPosition(position);
+      return store->getHandles()[id];
    }
 
-   void Obstacle::setVelocity(RealVec const& velocity)
+   RealVec2 const& Obstacle::getPosition() const
    {
-      RealVec v(velocity);
-      Real const s = v.length();
-      if (MathUtil::isAlmostZero(s))
-      {
-         setSpeed(0);
-         // Don't change the orientation if the speed is zero.
-      }
-      else
-      {
-         setSpeed(s);
-         setOrientation(v.normalize());
-      }
+      return store->getPositions()[id];
    }
 
-   RealVec Obstacle::getVelocity() const
+   void Obstacle::setPosition(RealVec2 const& position)
+   {
+      store->getPositions()[id] = position;
+   }
+
+   void Obstacle::setVelocity(RealVec2 const& velocity)
+   {
+      store->setVelocity(id, velocity);
+   }
+
+   RealVec2 Obstacle::getVelocity() const
    {
       // TODO: cache v in a class variable and invalidate as appropriate.
       // Then make this return a const reference (remember to change the
       // corresponding percept too).
-      RealVec v(shape->getOrientation());
-      return v.scale(getSpeed());
+      return store->getVelocity(id);
    }
 
    Real Obstacle::getSpeed() const
    {
-      return speed;
+      return store->getSpeeds()[id];
    }
 
    void Obstacle::setSpeed(Real const speed)
    {
-      TG_ASSERT(mass < Inf); // Infinitely heavy object can't move
-      this->speed = speed;
+      TG_ASSERT(getMass() < Inf); // Infinitely heavy object can't move
+      store->getSpeeds()[id] = speed;
    }
 
    Real const& Obstacle::getMass() const
    {
-      return mass;
+      return store->getMasses()[id];
    }
 
    void Obstacle::setMass(Real const mass)
    {
-      this->mass = mass;
+      store->getMasses()[id] = mass;
    }
 
-   RealVec const& Obstacle::getOrientation() const
+   RealVec2 const& Obstacle::getOrientation() const
    {
-      return shape->getOrientation();
+      return store->getOrientations()[id];
    }
 
-   void Obstacle::setOrientation(RealVec const& orientation)
+   void Obstacle::setOrientation(RealVec2 const& orientation)
    {
       TG_ASSERT(MathUtil::isAlmostEq(1, orientation.length()));
 
-      shape->setOrientation(orientation);
+      store->getOrientations()[id] = orientation;
+   }
+
+   bool Obstacle::getBounds(RealVec2& lower, RealVec2& upper) const
+   {
+      return shape->getBounds(lower, upper);
    }
 
    bool Obstacle::isTouching(Obstacle const& o) const
@@ -164,19 +196,15 @@ namespace tagGame
 
    bool Obstacle::isColliding(Obstacle const& o) const
    {
-      RealVec const& v0(getVelocity());
-      RealVec const& v1(o.getVelocity());
-      RealVec const n(normalTo(o));
-
-      return isTouching(o) && v0.dot(n) > v1.dot(n);
+      return isTouching(o) && 0 < Narrowphase::approachSpeed(getVelocity(), o.getVelocity(), normalTo(o));
    }
 
-   RealVec Obstacle::nearestIntersection(RealVec const& p, RealVec const& v) const
+   RealVec2 Obstacle::nearestIntersection(RealVec2 const& p, RealVec2 const& v) const
    {
       return shape->nearestIntersection(p, v);
    }
 
-   RealVec Obstacle::normalTo(Obstacle const& o) const
+   RealVec2 Obstacle::normalTo(Obstacle const& o) const
    {
       return shape->normalTo(*o.shape);
    }
@@ -191,6 +219,11 @@ namespace tagGame
       return shape->distanceSquaredTo(*o.shape);
    }
 
+   Real Obstacle::timeToImpact(Obstacle const& o, Real& leave) const
+   {
+      return shape->timeToImpact(*o.shape, getVelocity().relativeTo(o.getVelocity()), leave);
+   }
+
    void Obstacle::setRenderer(RendererPtr renderer)
    {
       // Not all shapes need renderers
@@ -24,23 +24,127 @@ using namespace std;
 
 Perception::Perception(GameState* gs) :
    gs(gs),
-   me(NULL),
-   tagged(NULL),
-   objectCache(objectCacheSize)
+   tableFrame(-1),
+   tableTime(0),
+   tableChangeCount(0)
 {
-   fill(objectCache.begin(),objectCache.end(), static_cast<Obstacle*>(NULL));
+   setWorkerCount(1);
 }
 
 Perception::~Perception()
 {}
 
+void Perception::setWorkerCount(size_t const workerCount)
+{
+   Context c;
+   c.me = NULL;
+   c.row = noRow;
+   c.scratch.known = 0;
+   c.cacheHits = 0;
+   c.cacheMisses = 0;
+
+   if (contexts.size() < workerCount)
+   {
+      contexts.resize(workerCount, c);
+   }
+}
+
+void Perception::update()
+{
+   EntityStore const& store(gs->getCharacterStore());
+   size_t const characterCount = store.size();
+
+   Percepts unknown;
+   unknown.known = 0;
+   table.assign(characterCount, unknown);
+
+   // The distance and direction from every character to the tagged one, as
+   // batches.
+   Character const* const t(getTagged());
+   if (t && t->getStore() == &store)
+   {
+      Narrowphase::Pair pair;
+      pair.j = t->getId();
+      pair.isObstacle = false;
+      pairs.assign(characterCount, pair);
+      for (size_t i = 0; i < characterCount; i++)
+      {
+         pairs[i].i = i;
+      }
+
+      Narrowphase::evaluate(store, gs->getObstacleStore(), pairs, distances, normals);
+      Steering::evade(store.getPositions(), store.getPositions()[pair.j], directions, speeds);
+
+      for (size_t i = 0; i < characterCount; i++)
+      {
+         table[i].distanceToTagged = distances[i];
+         table[i].directionFromTagged = directions[i];
+         table[i].known = distanceToTaggedKnown | directionFromTaggedKnown;
+      }
+   }
+
+   tableFrame = gs->getFrame();
+   tableTime = gs->getTime();
+   tableChangeCount = gs->getChangeCount();
+}
+
+void Perception::save(Snapshot& snapshot) const
+{
+   snapshot.write(tagged);
+   snapshot.write(lastTagged);
+   snapshot.write(lastTaggedByList.size());
+   for (map<Handle,Handle>::const_iterator i = lastTaggedByList.begin(); i != lastTaggedByList.end(); i++)
+   {
+      snapshot.write(i->first);
+      snapshot.write(i->second);
+   }
+}
+
+void Perception::restore(Snapshot const& snapshot, size_t& offset)
+{
+   snapshot.read(offset, tagged);
+   snapshot.read(offset, lastTagged);
+   size_t n;
+   snapshot.read(offset, n);
+   lastTaggedByList.clear();
+   for (size_t i = 0; i < n; i++)
+   {
+      Handle who;
+      snapshot.read(offset, who);
+      snapshot.read(offset, lastTaggedByList[who]);
+   }
+
+   // The table is for some other state of the world.
+   tableFrame = -1;
+}
+
+void Perception::getCacheCounts(size_t& hits, size_t& misses) const
+{
+   hits = 0;
+   misses = 0;
+   for (vector<Context>::const_iterator i = contexts.begin(); i != contexts.end(); i++)
+   {
+      hits += i->cacheHits;
+      misses += i->cacheMisses;
+   }
+}
+
+void Perception::resetCacheCounts()
+{
+   for (vector<Context>::iterator i = contexts.begin(); i != contexts.end(); i++)
+   {
+      i->cacheHits = 0;
+      i->cacheMisses = 0;
+   }
+}
+
 Character const* Perception::whoLastTaggedMe() const
 {
-   map<Character*,Character*>::const_iterator i(lastTaggedByList.find(me));
+   map<Handle,Handle>::const_iterator i(lastTaggedByList.find(getMe()->getHandle()));
 
    if (i != lastTaggedByList.end())
    {
-      return i->second;
+      return gs->getCharacter(i->second);
    }
    return NULL;
 }
@@ -59,98 +163,68 @@ bool Perception::myselfRecentlyTagged() const
 
 Character* Perception::nearestCharacter() const
 {
-   // If the previous calculation of nearestCharacter is still valid, return the
-   // cached value.
-   if (objectCache[nearestCharacterCache])
+   // If nearestCharacter has already been calculated, return the
+   // remembered value.
+   Context& c(context());
+   Percepts& p(percepts());
+   if (p.known & nearestCharacterKnown)
    {
-      return static_cast<Character*>(objectCache[nearestCharacterCache]);
+      c.cacheHits++;
+      return p.nearestCharacter;
    }
+   c.cacheMisses++;
 
-   Character* who(NULL);
-   Real dMin = Inf;
-   for (CharacterIterator i = gs->getCharacterListBegin(); i != gs->getCharacterListEnd(); i++)
-   {
-      if (me == &**i) { continue; } // Don't include me!
-
-      // TODO: use squaredDistanceTo instead
-      Real const d = distanceTo(**i);
-      if (d < dMin)
-      {
-         dMin = d;
-         who = &**i;
-      }
-   }
+   Character* who(gs->getGrid().nearestCharacter(*getMe()));
    TG_ASSERT(who);
-   // Computing the nearest character is expensive so cache the result in case
-   // it's needed again.
-   // TODO: Could also be worth caching dMin as the distanceToNearestCharacter.
-   objectCache[nearestCharacterCache] = who;
+   // Computing the nearest character is expensive so remember the result in
+   // case it's needed again, along with the distance to it.
+   p.nearestCharacter = who;
+   p.distanceToNearestCharacter = getMe()->distanceTo(*who);
+   p.known |= nearestCharacterKnown;
    return who;
 }
 
 // TODO: factor out common code from nearestObstacle, nearestCharacter, etc.
 Obstacle* Perception::nearestObstacle() const
 {
-   // If the previous calculation of nearestCharacter is still valid, return the
-   // cached value.
-   if (objectCache[nearestObstacleCache])
+   // If nearestObstacle has already been calculated, return the
+   // remembered value.
+   Context& c(context());
+   Percepts& p(percepts());
+   if (p.known & nearestObstacleKnown)
    {
-      return static_cast<Obstacle*>(objectCache[nearestObstacleCache]);
+      c.cacheHits++;
+      return p.nearestObstacle;
    }
+   c.cacheMisses++;
 
-   Obstacle* which(NULL);
-   Real dMin = Inf;
-   for (ObstacleIterator i = gs->getObstacleListBegin(); i != gs->getObstacleListEnd(); i++)
-   {
-      // TODO: cast needed for me?
-      if (me == &**i) { continue; } // Don't include me!
-
-      // TODO: use squaredDistanceTo instead
-      Real const d = distanceTo(**i);
-      if (d < dMin)
-      {
-         dMin = d;
-         which = &**i;
-      }
-   }
+   Obstacle* which(gs->getGrid().nearestObstacle(*getMe()));
    // TODO: support no obstacles?
    TG_ASSERT(which);
-   // Computing the nearest character is expensive so cache the result
-   // in case it's needed again.
-
-   // TODO: Could also be worth caching dMin as the
-   // distanceToNearestCharacter.
-
-   objectCache[nearestObstacleCache] = which;
+   // Computing the nearest obstacle is expensive so remember the result
+   // in case it's needed again, along with the distance to it.
+   p.nearestObstacle = which;
+   p.distanceToNearestObstacle = getMe()->distanceTo(*which);
+   p.known |= nearestObstacleKnown;
    return which;
 }
 
-RealVec Perception::nextCollisionPoint() const
+RealVec2 Perception::nextCollisionPoint() const
 {
-   if (!objectCache[nextColliderCache])
-   {
-      nextCollider();
-   }
+   nextCollider();
 
-   if (!objectCache[nextColliderCache])
-   {
-      RealVec p(Util2D::dim);
-      p.set(Inf);
-      return p;
-   }
-   // TODO: This was already calculated in nextCollider, consider caching.
-   return objectCache[nextColliderCache]->nearestIntersection(myPosition(), myOrientation());
+   return percepts().nextCollisionPoint;
 }
 
 Real Perception::timeToCollision() const
 {
-   RealVec cp(nextCollisionPoint());
+   RealVec2 cp(nextCollisionPoint());
    if (Inf == cp.length())
    {
       return Inf; // No collisions detected.
    }
 
-   RealVec rp(cp.relativeTo(myPosition()));
+   RealVec2 rp(cp.relativeTo(myPosition()));
 
    // With the current set of assumptions, me could not be on a
    // collision course in the first place if the following assert
@@ -168,7 +242,7 @@ Real Perception::timeToCollision() const
    // vein, using a stationary snapshot of the world is OK for now.
    // Especially so as the snapshot is regularly updated when the
    // percept is recalculated every time an action is selected.
-   Real const colliderVel = rp.dot(objectCache[nextColliderCache]);
+   Real const colliderVel = rp.dot(nextCollider()->getVelocity());
    Real const relVel = myVel - colliderVel;
 #endif
 
@@ -177,47 +251,37 @@ Real Perception::timeToCollision() const
 
 Obstacle* Perception::nextCollider() const
 {
-   // If the previous calculation of the next collider is still valid,
-   // return the cached value.
-   if (objectCache[nextColliderCache])
+   // If the next collider has already been calculated, return the
+   // remembered value.
+   Context& c(context());
+   Percepts& p(percepts());
+   if (p.known & nextColliderKnown)
    {
-      return static_cast<Obstacle*>(objectCache[nextColliderCache]);
+      c.cacheHits++;
+      return p.nextCollider;
    }
+   c.cacheMisses++;
 
-   Obstacle* which(NULL);
-   Real dMin = Inf;
-   for (ObstacleIterator i = gs->getObstacleListBegin(); i != gs->getObstacleListEnd(); i++)
-   {
-      // TODO: cast needed for me?
-      if (me == &**i) { continue; } // Don't include me!
-
-      RealVec rp((*i)->nearestIntersection(myPosition(), myOrientation()));
-      // Infinity is used to indicate no intersection.
-      if (rp.length() < Inf)
-      {
-         rp.subtract(myPosition());
-         Real const d = rp.length() - myMaxExtent();
-         if (d < dMin)
-         {
-            dMin = d;
-            which = &**i;
-         }
-      }
-   }
+   Obstacle* which(gs->getGrid().nearestIntersecting(*getMe(), myPosition(), myOrientation()));
    // We must at least be on a collision course with one of the sides.
    // TODO: turn side collisions back on
    if (false && !which)
    {
       cerr << myPosition() << "; " << myOrientation() << endl;
-      char c; cin >> c;
+      char key; cin >> key;
       TG_ASSERT(which);
    }
-   // Computing the nearest collider is expensive so cache the result
-   // in case it's needed again.
-
-   // TODO: Could also be worth caching dMin as the distance to the
-   // nearest collider.
-
-   objectCache[nextColliderCache] = which;
+   // Computing the nearest collider is expensive so remember the result,
+   // and where the collision will be, in case they're needed again.
+   p.nextCollider = which;
+   if (which)
+   {
+      p.nextCollisionPoint = which->nearestIntersection(myPosition(), myOrientation());
+   }
+   else
+   {
+      p.nextCollisionPoint.set(Inf);
+   }
+   p.known |= nextColliderKnown;
    return which;
 }
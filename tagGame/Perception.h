@@ -22,7 +22,11 @@
 #include "Character.h"
 #include "Timer.h"
 #include "Circle.h"
+#include "ThreadPool.h"
+#include "Narrowphase.h"
+#include "Steering.h"
 
+#include <algorithm>
 #include <map>
 
 namespace tagGame
@@ -54,12 +58,12 @@ namespace tagGame
       inline Character* getTagged() const;
 
       /// Some basic information about me.
-      inline RealVec const& myPosition() const;
-      inline RealVec myVelocity() const;
+      inline RealVec2 const& myPosition() const;
+      inline RealVec2 myVelocity() const;
       inline Real mySpeed() const;
-      inline RealVec const& myOrientation() const;
+      inline RealVec2 const& myOrientation() const;
       inline Real myMaxExtent() const;
-      inline Real myExtent(RealVec const& dir) const;
+      inline Real myExtent(RealVec2 const& dir) const;
       inline Real myMaxSpeed(void) const;
       inline bool myselfTagged() const;
 
@@ -74,33 +78,35 @@ namespace tagGame
       bool myselfRecentlyTagged() const;
 
       /// Some basic information about the tagged character.
-      inline RealVec const& taggedPosition() const;
-      inline RealVec taggedVelocity() const;
-      inline RealVec taggedRelativePosition() const;
+      inline RealVec2 const& taggedPosition() const;
+      inline RealVec2 taggedVelocity() const;
+      inline RealVec2 taggedRelativePosition() const;
       inline Real distanceSquaredToTagged() const;
       inline Real distanceToTagged() const;
+      /// The unit direction away from the tagged character (see Steering).
+      inline RealVec2 const& directionFromTagged() const;
 
       /// Predictor percept for tagged character's future position.
-      inline RealVec taggedFuturePosition() const;
+      inline RealVec2 taggedFuturePosition() const;
 
       /// Information about the nearest character.
       Character* nearestCharacter() const;
-      inline RealVec const& nearestCharacterPosition() const;
-      inline RealVec nearestCharacterRelativePosition() const;
+      inline RealVec2 const& nearestCharacterPosition() const;
+      inline RealVec2 nearestCharacterRelativePosition() const;
       inline Real distanceSquaredToNearestCharacter() const;
       inline Real distanceToNearestCharacter() const;
 
       /// Some information about obstacles.
       Obstacle* nearestObstacle() const; 
-      inline RealVec nearestObstaclePosition() const;
-      inline RealVec nearestObstacleRelativePosition() const;
+      inline RealVec2 nearestObstaclePosition() const;
+      inline RealVec2 nearestObstacleRelativePosition() const;
       inline Real distanceSquaredToNearestObstacle() const;
       inline Real distanceToNearestObstacle() const;
 
       /// Information about an arbitary obstacle.  Note that,
       /// characters are also obstacles.
-      inline RealVec const& position(Obstacle const& which) const;
-      inline RealVec relativePosition(Obstacle const& which) const;
+      inline RealVec2 const& position(Obstacle const& which) const;
+      inline RealVec2 relativePosition(Obstacle const& which) const;
       inline Real distanceSquaredTo(Obstacle const& which) const;      
       inline Real distanceTo(Obstacle const& which) const;
 
@@ -115,7 +121,7 @@ namespace tagGame
       /// of the odd collision not being avoided.
       Real timeToCollision() const;
       /// Predictor percept for my next collision point.
-      RealVec nextCollisionPoint() const;
+      RealVec2 nextCollisionPoint() const;
       /// Predictor percept for obstacle for my next collision.
       Obstacle* nextCollider() const;
 
@@ -124,6 +130,37 @@ namespace tagGame
       inline int getTicks();
       inline Real getTime();
 
+      /// Percepts are kept in a table, with a row for each character, so each
+      /// one only has to be calculated once per frame.  Some, like the
+      /// distance to the tagged character, are calculated for all the
+      /// characters at once, in a batch, by update.  The rest are filled in
+      /// the first time they're needed.  This should be called at the start
+      /// of every frame, before any controllers select actions (see
+      /// Simulator::generateActions).  Until it is, percepts are only
+      /// remembered until the next call to setMe.  Anything that moves
+      /// the characters without changing the frame or the game time should
+      /// call it again.
+      void update();
+
+      /// Write who is tagged (and who tagged who) to a snapshot, or read it
+      /// back (see Snapshot).
+      void save(Snapshot& snapshot) const;
+      void restore(Snapshot const& snapshot, size_t& offset);
+
+      /// Percepts can be calculated for several characters at once, one on
+      /// each worker of a thread pool (see Simulator::generateActions).  Each
+      /// worker has its own point of view (see setMe) and cache.  This must
+      /// be called, before any of the workers use the perception object, with
+      /// at least the number of workers in the pool.
+      void setWorkerCount(size_t const workerCount);
+      inline size_t getWorkerCount() const;
+
+      /// How many times a cached percept has been reused, and how many times
+      /// one had to be calculated, over all the workers, since the counts
+      /// were last reset.  Not safe to call while workers are busy.
+      void getCacheCounts(size_t& hits, size_t& misses) const;
+      void resetCacheCounts();
+
       /// Full access to the underlying game-state should be restricted to debugging
       /// use only.
       inline GameState* getGameState();
@@ -134,24 +171,72 @@ namespace tagGame
 
       // Pointer to the game-state object
       GameState* gs;
-      // The character from whose point of view percepts are to be calculated.
-      Character* me;
       // The tagged character.
-      Character* tagged;
+      Handle tagged;
       // The previous tagged character.
-      Character* lastTagged;
+      Handle lastTagged;
+
+      // Held by handle, so that characters can be removed from the game.
+      std::map<Handle,Handle> lastTaggedByList;
+
+      // Bits saying which of a row's percepts have been calculated.
+      enum
+      {
+         distanceToTaggedKnown = 1,
+         nearestCharacterKnown = 2,
+         nearestObstacleKnown = 4,
+         nextColliderKnown = 8,
+         directionFromTaggedKnown = 16
+      };
 
-      std::map<Character*,Character*> lastTaggedByList;
+      // A row of the percept table.
+      struct Percepts
+      {
+         unsigned int known;
+         Real distanceToTagged;
+         RealVec2 directionFromTagged;
+         Character* nearestCharacter;
+         Real distanceToNearestCharacter;
+         Obstacle* nearestObstacle;
+         Real distanceToNearestObstacle;
+         // NULL if there's nothing to collide with.
+         Obstacle* nextCollider;
+         RealVec2 nextCollisionPoint;
+      };
 
-      enum cacheType
+      // Everything that depends on the point of view, one per worker.
+      struct Context
       {
-         nearestCharacterCache,
-         nearestObstacleCache,
-         nextColliderCache,
-         objectCacheSize
+         // The character from whose point of view percepts are to be calculated.
+         Character* me;
+         // Its row in the table, or noRow if it doesn't have one, in which
+         // case its percepts are kept in scratch instead.
+         size_t row;
+         Percepts scratch;
+         size_t cacheHits;
+         size_t cacheMisses;
       };
 
-      mutable std::vector<Obstacle*> objectCache;
+      static size_t const noRow = size_t(-1);
+
+      inline Context& context() const;
+      inline Percepts& percepts() const;
+
+      mutable std::vector<Context> contexts;
+
+      // The percept table, indexed by character id, and the frame and game
+      // time it is for.
+      mutable std::vector<Percepts> table;
+      int tableFrame;
+      Real tableTime;
+      int tableChangeCount;
+
+      // Scratch space for update.
+      std::vector<Narrowphase::Pair> pairs;
+      std::vector<Real> distances;
+      std::vector<RealVec2> normals;
+      std::vector<RealVec2> directions;
+      std::vector<Real> speeds;
    };
 
    typedef bool (Perception::*PerceptBool)() const;
@@ -162,186 +247,224 @@ namespace tagGame
    {
       TG_ASSERT(me);
    
-      this->me = me;
-   
-      // Currently, the cache is only valid so long as the point of view
-      // doesn't change.  That is, when a controller is selecting an
-      // action for a single character, some values don't have to be
-      // recomputed if they have previously already been determined.
-      // Note that, caches could be maintained on a per character basis.
-      // This would mean the cache could still be useful even if actions
-      // were not computed for each character sequentially.  In addition,
-      // caches could only be invalidated after n frames, thus avoiding
-      // additional computation at the expense (as n increases) of less
-      // accurate information.
-      fill(objectCache.begin(),objectCache.end(), static_cast<Obstacle*>(NULL));
+      Context& c(context());
+      c.me = me;
+   
+      // Percepts are kept in me's row of the table, which is valid for the
+      // whole frame, however the characters are spread over the workers.
+      // Characters that aren't in the table (or if the table is out of
+      // date) only keep their percepts until the point of view changes.
+      // Note that, the table could also only be invalidated after n
+      // frames, thus avoiding additional computation at the expense (as n
+      // increases) of less accurate information.
+      if (tableFrame == gs->getFrame() && tableTime == gs->getTime() && tableChangeCount == gs->getChangeCount() &&
+          me->getStore() == &gs->getCharacterStore() && me->getId() < table.size())
+      {
+         c.row = me->getId();
+      }
+      else
+      {
+         c.row = noRow;
+         c.scratch.known = 0;
+      }
    }
    
    void Perception::setTagged(Character* tagged)
    {
       TG_ASSERT(tagged);
       TG_ASSERT(tagged->getIsTagged());
+      TG_ASSERT(!tagged->getHandle().isNull());
    
       lastTagged = this->tagged;
-      this->tagged = tagged;
+      this->tagged = tagged->getHandle();
+      // The table's distances are to the old tagged character.
+      tableFrame = -1;
       // Assume tagged was tagged by last tagged.  The lastTaggedByList will become
       // corrupt if the game ever omits to call setTagged when a new character is
       // tagged.
-      lastTaggedByList[tagged] = lastTagged;
+      lastTaggedByList[this->tagged] = lastTagged;
    }
    
    Character* Perception::getMe(void) const
    {
-      return me;
+      return context().me;
    }
    
    Character* Perception::getTagged(void) const
    {
-      return tagged;
+      // NULL if the tagged character has been removed from the game.
+      return gs->getCharacter(tagged);
    }
    
-   RealVec const& Perception::myPosition() const
+   RealVec2 const& Perception::myPosition() const
    {
-      return me->getPosition();
+      return getMe()->getPosition();
    }
    
    // TODO: add a void for all empty function argument lists
-   RealVec Perception::myVelocity(void) const
+   RealVec2 Perception::myVelocity(void) const
    {
-      return me->getVelocity();
+      return getMe()->getVelocity();
    }
    
    Real Perception::mySpeed() const
    {
-      return me->getSpeed();
+      return getMe()->getSpeed();
    }
    
-   RealVec const& Perception::myOrientation(void) const
+   RealVec2 const& Perception::myOrientation(void) const
    {
-      return me->getOrientation();
+      return getMe()->getOrientation();
    }
    
    Real Perception::myMaxExtent() const
    {
       // TODO: Use more notion of extent in the rest of the game.
-      return static_cast<Circle const&>(me->getShape()).getRadius();
+      return static_cast<Circle const&>(getMe()->getShape()).getRadius();
    }
    
-   Real Perception::myExtent(RealVec const& dir) const
+   Real Perception::myExtent(RealVec2 const& dir) const
    {
       // Use more notion of extent in the rest of the game.
-      return static_cast<Circle const&>(me->getShape()).getRadius();
+      return static_cast<Circle const&>(getMe()->getShape()).getRadius();
    }
    
    Real Perception::myMaxSpeed(void) const
    {
-      return me->getMaxSpeed();
+      return getMe()->getMaxSpeed();
    }
    
    bool Perception::myselfTagged() const
    {
-      return tagged == me;
+      return tagged == getMe()->getHandle();
    }
    
-   RealVec const& Perception::taggedPosition(void) const
+   RealVec2 const& Perception::taggedPosition(void) const
    {
-      TG_ASSERT(tagged);
+      Character const* const t(getTagged());
+      TG_ASSERT(t);
    
-      return tagged->getPosition();
+      return t->getPosition();
    }
    
-   RealVec Perception::taggedVelocity(void) const
+   RealVec2 Perception::taggedVelocity(void) const
    {
-      TG_ASSERT(tagged);
+      Character const* const t(getTagged());
+      TG_ASSERT(t);
    
-      return tagged->getVelocity();
+      return t->getVelocity();
    }
    
-   RealVec Perception::taggedRelativePosition(void) const
+   RealVec2 Perception::taggedRelativePosition(void) const
    {
-      TG_ASSERT(tagged);
-   
       return taggedPosition().relativeTo(myPosition());
    }
    
    Real Perception::distanceSquaredToTagged() const
    {
-      assert(tagged);
-   
-      return me->distanceSquaredTo(*tagged);
+      Real const d(distanceToTagged());
+
+      return d * d;
    }
    
    Real Perception::distanceToTagged() const
    {
-      TG_ASSERT(tagged);
-   
-      return me->distanceTo(*tagged);
+      Percepts& p(percepts());
+      if (!(p.known & distanceToTaggedKnown))
+      {
+         Character const* const t(getTagged());
+         TG_ASSERT(t);
+         p.distanceToTagged = getMe()->distanceTo(*t);
+         p.known |= distanceToTaggedKnown;
+      }
+
+      return p.distanceToTagged;
+   }
+
+   RealVec2 const& Perception::directionFromTagged() const
+   {
+      Percepts& p(percepts());
+      if (!(p.known & directionFromTaggedKnown))
+      {
+         p.directionFromTagged = Steering::evade(myPosition(), taggedPosition());
+         p.known |= directionFromTaggedKnown;
+      }
+
+      return p.directionFromTagged;
    }
    
-   RealVec Perception::taggedFuturePosition() const
+   RealVec2 Perception::taggedFuturePosition() const
    {
-      RealVec p(taggedPosition());
+      RealVec2 p(taggedPosition());
       return p.add(taggedVelocity());
    }
    
-   RealVec const& Perception::nearestCharacterPosition() const
+   RealVec2 const& Perception::nearestCharacterPosition() const
    {
       return nearestCharacter()->getPosition();
    }
    
-   RealVec Perception::nearestCharacterRelativePosition() const
+   RealVec2 Perception::nearestCharacterRelativePosition() const
    {
       return nearestCharacterPosition().relativeTo(myPosition());
    }
    
    Real Perception::distanceSquaredToNearestCharacter() const
    {
-      return me->distanceSquaredTo(*nearestCharacter());
+      Real const d(distanceToNearestCharacter());
+
+      return d * d;
    }
    
    Real Perception::distanceToNearestCharacter() const
    {
-      return me->distanceTo(*nearestCharacter());
+      nearestCharacter();
+
+      return percepts().distanceToNearestCharacter;
    }
    
-   RealVec const& Perception::position(Obstacle const& which) const
+   RealVec2 const& Perception::position(Obstacle const& which) const
    {
       return which.getPosition();
    }
    
-   RealVec Perception::relativePosition(Obstacle const& which) const
+   RealVec2 Perception::relativePosition(Obstacle const& which) const
    {
       return position(which).relativeTo(myPosition());
    }
    
    Real Perception::distanceSquaredTo(Obstacle const& which) const
    {
-      return me->distanceSquaredTo(which);
+      return getMe()->distanceSquaredTo(which);
    }
    
    Real Perception::distanceTo(Obstacle const& which) const
    {
-      return me->distanceTo(which);
+      return getMe()->distanceTo(which);
    }
    
-   RealVec Perception::nearestObstaclePosition() const
+   RealVec2 Perception::nearestObstaclePosition() const
    {
       return nearestObstacle()->getPosition();
    }
    
-   RealVec Perception::nearestObstacleRelativePosition() const
+   RealVec2 Perception::nearestObstacleRelativePosition() const
    {
       return nearestObstaclePosition().relativeTo(myPosition());
    }
    
    Real Perception::distanceSquaredToNearestObstacle() const
    {
-      return me->distanceSquaredTo(*nearestObstacle());
+      Real const d(distanceToNearestObstacle());
+
+      return d * d;
    }
    
    Real Perception::distanceToNearestObstacle() const
    {
-      return me->distanceTo(*nearestObstacle());
+      nearestObstacle();
+
+      return percepts().distanceToNearestObstacle;
    }
    
    int Perception::getFrame()
@@ -352,15 +475,34 @@ namespace tagGame
    int Perception::getTicks()
    {
       // characters only know about game time
-      return Timer::theTimer().gameTicks();
+      return gs->getTicks();
    }
 
    Real Perception::getTime()
    {
       // characters only know about game time
-      return Timer::theTimer().gameTime();
+      return gs->getTime();
    }
    
+   size_t Perception::getWorkerCount() const
+   {
+      return contexts.size();
+   }
+
+   Perception::Context& Perception::context() const
+   {
+      TG_ASSERT(ThreadPool::getWorker() < contexts.size());
+
+      return contexts[ThreadPool::getWorker()];
+   }
+
+   Perception::Percepts& Perception::percepts() const
+   {
+      Context& c(context());
+
+      return noRow == c.row ? c.scratch : table[c.row];
+   }
+
    GameState* Perception::getGameState()
    {
       TG_ASSERT(gs);
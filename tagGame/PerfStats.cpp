@@ -0,0 +1,127 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#include "PerfStats.h"
+
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+
+using namespace tagGame;
+
+using namespace std;
+
+RollingHistogram::RollingHistogram(size_t const capacity) :
+   samples(capacity, Real(0)),
+   next(0),
+   count(0)
+{
+   TG_ASSERT(0 < capacity);
+}
+
+Real RollingHistogram::getPercentile(Real const p) const
+{
+   TG_ASSERT(0 <= p && p <= 100);
+
+   if (0 == count) { return 0; }
+
+   sorted.resize(count);
+   for (size_t i = 0; i < count; i++)
+   {
+      sorted[i] = getSample(i);
+   }
+
+   size_t const k = std::min(count - 1, size_t(ceil(p * Real(count) / Real(100))) - (0 < p ? 1 : 0));
+   nth_element(sorted.begin(), sorted.begin() + k, sorted.end());
+
+   return sorted[k];
+}
+
+Real RollingHistogram::getMax() const
+{
+   if (0 == count) { return 0; }
+
+   Real x = getSample(0);
+   for (size_t i = 1; i < count; i++)
+   {
+      x = std::max(x, getSample(i));
+   }
+
+   return x;
+}
+
+PerfStats::PerfStats(size_t const capacity) :
+   histograms(counterCount, RollingHistogram(capacity))
+{
+}
+
+char const* PerfStats::getName(Counter const counter)
+{
+   static char const* const names[counterCount] =
+   {
+      "generateActions",
+      "processActions",
+      "resolveCollisions",
+      "updateGameState",
+      "forward",
+      "render",
+      "frame",
+      "contacts",
+      "collisionPasses",
+      "substeps",
+      "perceptionCacheHits",
+      "perceptionCacheMisses"
+   };
+
+   TG_ASSERT(counter < counterCount);
+   return names[counter];
+}
+
+bool PerfStats::isTime(Counter const counter)
+{
+   return counter <= frameTime;
+}
+
+ostream& PerfStats::output(ostream& out) const
+{
+   ios::fmtflags const flags(out.flags());
+   streamsize const precision(out.precision());
+   out << fixed << setprecision(3);
+
+   for (int c = 0; c < counterCount; c++)
+   {
+      RollingHistogram const& h(histograms[c]);
+      if (0 == h.getCount()) { continue; }
+
+      Real const scale = isTime(Counter(c)) ? Real(1000) : Real(1);
+      out << setw(22) << left << getName(Counter(c)) << right
+          << " p50 " << setw(10) << h.getPercentile(50) * scale
+          << " p99 " << setw(10) << h.getPercentile(99) * scale
+          << " max " << setw(10) << h.getMax() * scale
+          << (isTime(Counter(c)) ? " ms" : "") << endl;
+   }
+
+   out.flags(flags);
+   out.precision(precision);
+
+   return out;
+}
+
+ostream& tagGame::operator<<(ostream& out, PerfStats const& stats)
+{
+   return stats.output(out);
+}
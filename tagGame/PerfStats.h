@@ -0,0 +1,154 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_PERF_STATS_H
+#define TG_PERF_STATS_H
+
+#include "MathUtil.h"
+
+#include <vector>
+#include <iosfwd>
+
+namespace tagGame
+{
+   /// The distribution of the most recent samples of some quantity, such as
+   /// how long each frame took.  Adding a sample is cheap, so samples can be
+   /// added all the time, and the distribution is only sorted out when it
+   /// is asked for.
+   class RollingHistogram
+   {
+   public:
+      /// Keep the last capacity samples.
+      explicit RollingHistogram(size_t const capacity = 600);
+
+      inline void add(Real const x);
+
+      /// The number of samples kept, at most the capacity.
+      inline size_t getCount() const;
+      inline size_t getCapacity() const;
+
+      /// Sample i, where 0 is the oldest sample kept.
+      inline Real getSample(size_t const i) const;
+      /// The most recent sample (0 if there are none).
+      inline Real getLast() const;
+
+      /// The smallest sample that is at least as big as p percent of the
+      /// samples (0 if there are none).
+      Real getPercentile(Real const p) const;
+      Real getMax() const;
+
+   protected:
+   private:
+      std::vector<Real> samples;
+      // Where the next sample goes.
+      size_t next;
+      size_t count;
+      // Scratch space for calculating percentiles.
+      mutable std::vector<Real> sorted;
+   };
+
+   /// Always-on performance counters.  Each counter keeps a rolling
+   /// histogram of its recent per-frame values, so that spikes show up as
+   /// they happen.  Times are in seconds.
+   class PerfStats
+   {
+   public:
+      enum Counter
+      {
+         // The phases of Simulator::forward, and the whole step.
+         generateActionsTime,
+         processActionsTime,
+         resolveCollisionsTime,
+         updateGameStateTime,
+         forwardTime,
+         // Drawing a frame (see Gui::render), and the time between frames.
+         renderTime,
+         frameTime,
+         // Touching pairs, and passes over them in Simulator::resolveCollisions.
+         contactCount,
+         collisionPassCount,
+         // How many pieces Simulator::updateGameState split a step into.
+         substepCount,
+         // Percepts that were reused from, or had to be added to, a cache.
+         perceptionCacheHits,
+         perceptionCacheMisses,
+         counterCount
+      };
+
+      explicit PerfStats(size_t const capacity = 600);
+
+      inline void add(Counter const counter, Real const x);
+      inline RollingHistogram const& getHistogram(Counter const counter) const;
+
+      static char const* getName(Counter const counter);
+      static bool isTime(Counter const counter);
+
+      /// Write one line per counter (that has any samples) with its
+      /// median, 99th percentile and maximum.  Times are in milliseconds.
+      std::ostream& output(std::ostream& out) const;
+
+   protected:
+   private:
+      std::vector<RollingHistogram> histograms;
+   };
+
+   std::ostream& operator<<(std::ostream& out, PerfStats const& stats);
+
+   void RollingHistogram::add(Real const x)
+   {
+      samples[next] = x;
+      next = next + 1 == samples.size() ? 0 : next + 1;
+      if (count < samples.size()) { count++; }
+   }
+
+   size_t RollingHistogram::getCount() const
+   {
+      return count;
+   }
+
+   size_t RollingHistogram::getCapacity() const
+   {
+      return samples.size();
+   }
+
+   Real RollingHistogram::getSample(size_t const i) const
+   {
+      TG_ASSERT(i < count);
+      // The oldest sample is at next once the buffer has wrapped around.
+      size_t const j = next + samples.size() - count + i;
+      return samples[j < samples.size() ? j : j - samples.size()];
+   }
+
+   Real RollingHistogram::getLast() const
+   {
+      return 0 == count ? Real(0) : getSample(count - 1);
+   }
+
+   void PerfStats::add(Counter const counter, Real const x)
+   {
+      TG_ASSERT(counter < counterCount);
+      histograms[counter].add(x);
+   }
+
+   RollingHistogram const& PerfStats::getHistogram(Counter const counter) const
+   {
+      TG_ASSERT(counter < counterCount);
+      return histograms[counter];
+   }
+}
+
+#endif
@@ -0,0 +1,241 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_POOL_H
+#define TG_POOL_H
+
+#include "Util.h"
+
+#include <new>
+#include <vector>
+
+namespace tagGame
+{
+   /// A pool of objects of type T.  Objects are allocated from chunks of
+   /// chunkSize objects, laid out one after another, so allocating or
+   /// freeing one is O(1) and objects created together end up next to each
+   /// other in memory.  Freed slots are reused before any new chunk is
+   /// allocated.  Chunks are only given back when the pool is destroyed.
+   /// A pool must outlive everything allocated from it: destroying (or
+   /// clearing) a pool destroys any objects still in it.  Pools aren't
+   /// thread safe.
+   template<class T>
+   class Pool
+   {
+   public:
+      explicit Pool(size_t const chunkSize = 256);
+      ~Pool();
+
+      /// Construct a new object in the pool.
+      inline T* create();
+      template<class A0> inline T* create(A0 const& a0);
+      template<class A0, class A1> inline T* create(A0 const& a0, A1 const& a1);
+
+      /// Destroy an object created by this pool, and free its slot.
+      inline void destroy(T* p);
+
+      /// Destroy every object in the pool at once, e.g. at the end of a level.
+      void clear();
+
+      /// Create a new object owned by a shared pointer, which destroys it back
+      /// into this pool once the last reference to it goes.
+      inline typename SharedPtr<T>::type share();
+      template<class A0> inline typename SharedPtr<T>::type share(A0 const& a0);
+      template<class A0, class A1> inline typename SharedPtr<T>::type share(A0 const& a0, A1 const& a1);
+
+      /// The number of objects in the pool.
+      inline size_t size() const;
+      /// The number of objects the pool has room for without allocating.
+      inline size_t getCapacity() const;
+
+   protected:
+   private:
+      // Pools own objects, so can't be copied.
+      Pool(Pool const&);
+      Pool& operator=(Pool const&);
+
+      // An object's storage, which is the next free slot while it is free.
+      // The object is at the start of its slot.
+      struct Slot
+      {
+         union
+         {
+            char object[sizeof(T)];
+            Slot* next;
+            // Make sure the object is suitably aligned.
+            double alignDouble;
+            long alignLong;
+            void* alignPointer;
+         };
+         bool isLive;
+      };
+
+      struct Deleter
+      {
+         Pool* pool;
+         void operator()(T* p) { pool->destroy(p); }
+      };
+
+      inline void* allocate();
+      inline T* created(void* p);
+      inline typename SharedPtr<T>::type shared(T* p);
+
+      size_t chunkSize;
+      std::vector<Slot*> chunks;
+      Slot* freeSlots;
+      size_t count;
+   };
+
+   template<class T>
+   Pool<T>::Pool(size_t const chunkSize) :
+      chunkSize(chunkSize),
+      freeSlots(NULL),
+      count(0)
+   {
+      TG_ASSERT(0 < chunkSize);
+   }
+
+   template<class T>
+   Pool<T>::~Pool()
+   {
+      clear();
+      for (size_t i = 0; i < chunks.size(); i++)
+      {
+         delete[] chunks[i];
+      }
+   }
+
+   template<class T>
+   void* Pool<T>::allocate()
+   {
+      if (!freeSlots)
+      {
+         Slot* const chunk = new Slot[chunkSize];
+         chunks.push_back(chunk);
+         // Thread the new slots onto the free list so the first one is used first.
+         for (size_t i = chunkSize; 0 < i; i--)
+         {
+            chunk[i - 1].next = freeSlots;
+            chunk[i - 1].isLive = false;
+            freeSlots = &chunk[i - 1];
+         }
+      }
+
+      Slot* const s = freeSlots;
+      freeSlots = s->next;
+      return s->object;
+   }
+
+   template<class T>
+   T* Pool<T>::created(void* p)
+   {
+      reinterpret_cast<Slot*>(p)->isLive = true;
+      count++;
+      return static_cast<T*>(p);
+   }
+
+   template<class T>
+   T* Pool<T>::create()
+   {
+      return created(new (allocate()) T());
+   }
+
+   template<class T>
+   template<class A0>
+   T* Pool<T>::create(A0 const& a0)
+   {
+      return created(new (allocate()) T(a0));
+   }
+
+   template<class T>
+   template<class A0, class A1>
+   T* Pool<T>::create(A0 const& a0, A1 const& a1)
+   {
+      return created(new (allocate()) T(a0, a1));
+   }
+
+   template<class T>
+   void Pool<T>::destroy(T* p)
+   {
+      Slot* const s = reinterpret_cast<Slot*>(p);
+      TG_ASSERT(s->isLive);
+
+      p->~T();
+      s->isLive = false;
+      s->next = freeSlots;
+      freeSlots = s;
+      count--;
+   }
+
+   template<class T>
+   void Pool<T>::clear()
+   {
+      for (size_t i = 0; i < chunks.size() && 0 < count; i++)
+      {
+         for (size_t j = 0; j < chunkSize; j++)
+         {
+            if (chunks[i][j].isLive) { destroy(reinterpret_cast<T*>(chunks[i][j].object)); }
+         }
+      }
+   }
+
+   template<class T>
+   typename SharedPtr<T>::type Pool<T>::shared(T* p)
+   {
+#if defined(TG_USE_TR1)
+      Deleter d;
+      d.pool = this;
+      return typename SharedPtr<T>::type(p, d);
+#else
+      return p;
+#endif
+   }
+
+   template<class T>
+   typename SharedPtr<T>::type Pool<T>::share()
+   {
+      return shared(create());
+   }
+
+   template<class T>
+   template<class A0>
+   typename SharedPtr<T>::type Pool<T>::share(A0 const& a0)
+   {
+      return shared(create(a0));
+   }
+
+   template<class T>
+   template<class A0, class A1>
+   typename SharedPtr<T>::type Pool<T>::share(A0 const& a0, A1 const& a1)
+   {
+      return shared(create(a0, a1));
+   }
+
+   template<class T>
+   size_t Pool<T>::size() const
+   {
+      return count;
+   }
+
+   template<class T>
+   size_t Pool<T>::getCapacity() const
+   {
+      return chunks.size() * chunkSize;
+   }
+}
+
+#endif
@@ -0,0 +1,88 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#include "Random.h"
+
+using namespace tagGame;
+
+using namespace std;
+
+TG_THREAD_LOCAL Random* Random::currentStream = NULL;
+Random Random::defaultStream;
+
+// The splitmix64 generator, which is the recommended way to turn a seed
+// into a xoshiro state.
+static Random::Bits splitMix(Random::Bits& x)
+{
+   Random::Bits z = (x += 0x9E3779B97F4A7C15ULL);
+   z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+   z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+   return z ^ (z >> 31);
+}
+
+Random::Random(Bits const seed, Bits const stream)
+{
+   this->seed(seed, stream);
+}
+
+void Random::seed(Bits const seed, Bits const stream)
+{
+   // Mixing the stream number gives a different starting point for each
+   // stream.  The mix is one-to-one, so no two streams start the same.
+   Bits s = stream;
+   Bits x = seed ^ splitMix(s);
+   for (size_t i = 0; i < 4; i++)
+   {
+      state[i] = splitMix(x);
+   }
+
+   hasNormal = false;
+   nextNormal = 0;
+}
+
+void Random::uniform01(vector<Real>& values)
+{
+   for (vector<Real>::iterator i = values.begin(); i != values.end(); i++)
+   {
+      *i = toUniform01(next());
+   }
+}
+
+void Random::normal(vector<Real>& values, Real const mean, Real const std)
+{
+   vector<Real>::iterator i = values.begin();
+
+   // Use up the cached value first, so that a batch gives the same values as
+   // the equivalent number of single draws.
+   if (hasNormal && i != values.end())
+   {
+      *i++ = normal(mean, std);
+   }
+
+   for (; i != values.end() && i + 1 != values.end(); i += 2)
+   {
+      Real x, y;
+      boxMuller(x, y);
+      *i = x * std + mean;
+      *(i + 1) = y * std + mean;
+   }
+
+   if (i != values.end())
+   {
+      *i = normal(mean, std);
+   }
+}
@@ -0,0 +1,196 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_RANDOM_H
+#define TG_RANDOM_H
+
+#include "MathUtil.h"
+
+#include <vector>
+
+namespace tagGame
+{
+   /// A stream of pseudo-random numbers, generated with xoshiro256** (see
+   /// http://prng.di.unimi.it).  It is much faster than rand() and has a
+   /// much longer period.  Every stream has its own state, so that, for
+   /// example, each character can draw from its own stream no matter which
+   /// thread it is run on, and a run can be reproduced from a single seed.
+   ///
+   /// MathUtil's and Util2D's random functions draw from the calling
+   /// thread's current stream (see Scope).
+   class Random
+   {
+   public:
+      /// At least 64 bits.
+      typedef unsigned long long Bits;
+
+      /// Seed the stream with a seed and a stream number.  Different stream
+      /// numbers with the same seed give independent looking streams.
+      explicit Random(Bits const seed = 0, Bits const stream = 0);
+
+      void seed(Bits const seed, Bits const stream = 0);
+
+      /// The next 64 random bits.
+      inline Bits next();
+
+      /// Uniformly pick a Real in the range [0, 1).
+      inline Real uniform01();
+
+      /// Uniformly pick an integer in the range [0, n).
+      inline int uniform(int const n);
+
+      /// Pick a Real according to the normal distribution with mean and
+      /// standard deviation as provided.
+      inline Real normal(Real const mean = Real(0), Real const std = Real(1));
+
+      /// Fill values with uniform values in the range [0, 1).
+      void uniform01(std::vector<Real>& values);
+
+      /// Fill values with normally distributed values.
+      void normal(std::vector<Real>& values, Real const mean = Real(0), Real const std = Real(1));
+
+      /// The calling thread's current stream.  Threads that haven't chosen
+      /// a stream share a default one, which is only safe so long as just
+      /// one of them uses it.
+      inline static Random& current();
+
+      /// Makes a stream the calling thread's current stream for as long
+      /// as the scope lasts.
+      class Scope
+      {
+      public:
+         inline explicit Scope(Random& random);
+         inline ~Scope();
+
+      private:
+         Scope(Scope const&);
+         Scope& operator=(Scope const&);
+
+         Random* previous;
+      };
+
+   protected:
+   private:
+      inline static Bits rotl(Bits const x, int const k);
+      inline static Real toUniform01(Bits const x);
+      inline void boxMuller(Real& x, Real& y);
+
+      Bits state[4];
+
+      // Normal variates come in pairs, so the second one is cached.
+      bool hasNormal;
+      Real nextNormal;
+
+      static TG_THREAD_LOCAL Random* currentStream;
+      static Random defaultStream;
+   };
+
+   Random::Bits Random::rotl(Bits const x, int const k)
+   {
+      return (x << k) | (x >> (64 - k));
+   }
+
+   Random::Bits Random::next()
+   {
+      Bits const result = rotl(state[1] * 5, 7) * 9;
+      Bits const t = state[1] << 17;
+
+      state[2] ^= state[0];
+      state[3] ^= state[1];
+      state[1] ^= state[2];
+      state[0] ^= state[3];
+      state[2] ^= t;
+      state[3] = rotl(state[3], 45);
+
+      return result;
+   }
+
+   Real Random::toUniform01(Bits const x)
+   {
+      // The top 53 bits fill a double's mantissa exactly.
+      return Real(x >> 11) * (Real(1) / Real(9007199254740992.0));
+   }
+
+   Real Random::uniform01()
+   {
+      return toUniform01(next());
+   }
+
+   int Random::uniform(int const n)
+   {
+      TG_ASSERT(0 < n);
+
+      // Reject the last partial run of n values, so that every value is
+      // equally likely.
+      Bits const limit = ~Bits(0) - ~Bits(0) % Bits(n);
+      Bits x;
+      do
+      {
+         x = next();
+      } while (limit <= x);
+
+      return int(x % Bits(n));
+   }
+
+   void Random::boxMuller(Real& x, Real& y)
+   {
+      // For an explanation of the theory behind this code see:
+      // Eric W. Weisstein. "Box-Muller Transformation." From MathWorld--A Wolfram Web Resource.
+      // http://mathworld.wolfram.com/Box-MullerTransformation.html
+      Real const r0(uniform01());
+      Real const r1(uniform01());
+      Real const rho = sqrt(-Real(2) * log(Real(1) - r0));
+
+      x = rho * cos(Real(2) * M_PI * r1);
+      y = rho * sin(Real(2) * M_PI * r1);
+   }
+
+   Real Random::normal(Real const mean, Real const std)
+   {
+      Real x;
+      if (hasNormal)
+      {
+         x = nextNormal;
+         hasNormal = false;
+      }
+      else
+      {
+         boxMuller(x, nextNormal);
+         hasNormal = true;
+      }
+
+      return x * std + mean;
+   }
+
+   Random& Random::current()
+   {
+      return currentStream ? *currentStream : defaultStream;
+   }
+
+   Random::Scope::Scope(Random& random) :
+      previous(currentStream)
+   {
+      currentStream = &random;
+   }
+
+   Random::Scope::~Scope()
+   {
+      currentStream = previous;
+   }
+}
+
+#endif
@@ -0,0 +1,124 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#include "Recorder.h"
+#include "GameState.h"
+#include "Perception.h"
+#include "BehaviorProgram.h"
+
+using namespace tagGame;
+
+using namespace std;
+
+char const Recorder::magic[8] = { 't', 'a', 'g', 'G', 'a', 'm', 'e', 'R' };
+
+Recorder::Recorder(string const& fileName, GameState const& gs, Perception const& perception,
+                   BehaviorProgram const* program, size_t const keyframeInterval) :
+   file(NULL),
+   fileName(fileName),
+   gs(&gs),
+   perception(&perception),
+   program(program),
+   offset(0)
+{
+   TG_ASSERT(0 < keyframeInterval);
+
+   file = fopen(fileName.c_str(), "wb");
+   if (!file) { Util::error("Recorder: can't open " + fileName); }
+
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, magic, sizeof(magic));
+   header.version = version;
+   header.realSize = sizeof(Real);
+   header.characterCount = gs.getCharacterListEnd() - gs.getCharacterListBegin();
+   header.keyframeInterval = keyframeInterval;
+   header.seed = gs.getSeed();
+
+   // The counts are filled in when the file is closed.
+   write(&header, sizeof(header));
+
+   addKeyframe();
+}
+
+Recorder::~Recorder()
+{
+   close();
+}
+
+void Recorder::close()
+{
+   if (!file) { return; }
+
+   header.keyframeCount = index.size();
+   header.indexOffset = offset;
+   if (!index.empty()) { write(&index[0], index.size() * sizeof(index[0])); }
+
+   fseek(file, 0, SEEK_SET);
+   write(&header, sizeof(header));
+
+   if (0 != fclose(file)) { Util::error("Recorder: can't write " + fileName); }
+   file = NULL;
+}
+
+void Recorder::addFrame(Real const deltaT, vector<RealVec2> const& directions, vector<Real> const& speeds)
+{
+   TG_ASSERT_MSG(file, "Recorder: can't record after close");
+   size_t const characterCount = size_t(header.characterCount);
+   TG_ASSERT_MSG(directions.size() == characterCount && speeds.size() == characterCount,
+                 "Recorder: characters can't be added or removed while recording");
+
+   frame.resize(getFrameSize(characterCount)/sizeof(Real));
+   vector<Real>::iterator f(frame.begin());
+   *f++ = deltaT;
+   for (size_t i = 0; i < characterCount; i++)
+   {
+      for (size_t k = 0; k < Util2D::dim; k++)
+      {
+         *f++ = directions[i][k];
+      }
+      *f++ = speeds[i];
+   }
+   write(&frame[0], frame.size() * sizeof(Real));
+
+   header.frameCount++;
+   if (0 == header.frameCount % header.keyframeInterval)
+   {
+      addKeyframe();
+   }
+}
+
+void Recorder::addKeyframe()
+{
+   // Keep the sizes 8 byte aligned, so they can be read straight out of a
+   // mapped file.
+   char const padding[8] = { 0 };
+   write(padding, size_t((8 - offset % 8) % 8));
+
+   index.push_back(offset);
+
+   snapshot.capture(*gs, *perception, program);
+   unsigned long long const size = snapshot.size();
+   write(&size, sizeof(size));
+   write(snapshot.data(), snapshot.size());
+   write(padding, size_t((8 - size % 8) % 8));
+}
+
+void Recorder::write(void const* p, size_t const n)
+{
+   if (0 < n && 1 != fwrite(p, n, 1, file)) { Util::error("Recorder: can't write " + fileName); }
+   offset += n;
+}
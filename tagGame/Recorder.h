@@ -0,0 +1,136 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_RECORDER_H
+#define TG_RECORDER_H
+
+#include "Snapshot.h"
+#include "Util2D.h"
+#include "Random.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace tagGame
+{
+   class GameState;
+   class Perception;
+   class BehaviorProgram;
+
+   /// Records a match to a file, so that it can be replayed exactly, and
+   /// much faster than it was played (see Replay).  Rather than the state
+   /// of the world at every frame, it records what the characters chose to
+   /// do (the desired direction and speed of each one's action) and the
+   /// time step, which is all the simulator needs to step the world forward
+   /// again without asking any controllers.  Every keyframeInterval frames
+   /// it also records a snapshot of the whole world, so that a replay can
+   /// jump to any frame by restoring the keyframe before it and stepping
+   /// forward from there.
+   ///
+   /// Frames are recorded by the simulator (see Simulator::setRecorder),
+   /// one for each call to forward.  The characters and obstacles mustn't
+   /// be added or removed while recording.
+   ///
+   /// The file is written in the machine's own byte order and type sizes,
+   /// so it can only be replayed by a build of the game like the one that
+   /// recorded it (which is also needed for the replay to come out the
+   /// same).
+   class Recorder
+   {
+   public:
+      /// Records the world as it is now as the first keyframe.
+      Recorder(std::string const& fileName, GameState const& gs, Perception const& perception,
+               BehaviorProgram const* program = NULL, size_t const keyframeInterval = 600);
+      /// Closes the file, if it hasn't been already.
+      ~Recorder();
+
+      /// Finishes the file.  Nothing more can be recorded after this.
+      void close();
+
+      /// Called by the simulator after it has stepped forward using the
+      /// given actions.
+      void addFrame(Real const deltaT, std::vector<RealVec2> const& directions, std::vector<Real> const& speeds);
+
+      inline size_t getFrameCount() const;
+      inline size_t getKeyframeInterval() const;
+
+      /// The file starts with a header.  Then each keyframe is followed by
+      /// the frames up to the next one, so that where any frame is can be
+      /// worked out from where its keyframe is.  At the end is the index of
+      /// where the keyframes are.
+      ///
+      /// A keyframe is its size followed by the bytes of a snapshot, padded
+      /// to a multiple of 8 bytes.  A frame is the time step followed by
+      /// the direction and speed for each character, all Reals.  The index
+      /// is an offset from the start of the file for each keyframe.
+      struct Header
+      {
+         char magic[8];
+         unsigned version;
+         unsigned realSize;
+         unsigned long long characterCount;
+         unsigned long long keyframeInterval;
+         Random::Bits seed;
+         unsigned long long frameCount;
+         unsigned long long keyframeCount;
+         unsigned long long indexOffset;
+      };
+
+      static char const magic[8];
+      static unsigned const version = 2;
+
+      /// The size of a frame in bytes.
+      inline static size_t getFrameSize(size_t const characterCount);
+   protected:
+   private:
+      // Not copyable.
+      Recorder(Recorder const&);
+      Recorder& operator=(Recorder const&);
+
+      void addKeyframe();
+      void write(void const* p, size_t const n);
+
+      std::FILE* file;
+      std::string fileName;
+      GameState const* gs;
+      Perception const* perception;
+      BehaviorProgram const* program;
+      Header header;
+      Snapshot snapshot;
+      std::vector<unsigned long long> index;
+      std::vector<Real> frame;
+      unsigned long long offset;
+   };
+
+   size_t Recorder::getFrameCount() const
+   {
+      return size_t(header.frameCount);
+   }
+
+   size_t Recorder::getKeyframeInterval() const
+   {
+      return size_t(header.keyframeInterval);
+   }
+
+   size_t Recorder::getFrameSize(size_t const characterCount)
+   {
+      return (1 + characterCount * (Util2D::dim + 1)) * sizeof(Real);
+   }
+}
+
+#endif
@@ -0,0 +1,132 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#include "Replay.h"
+#include "Simulator.h"
+#include "GameState.h"
+#include "Perception.h"
+#include "BehaviorProgram.h"
+
+using namespace tagGame;
+
+using namespace std;
+
+Replay::Replay(string const& fileName) :
+   file(fileName),
+   fileName(fileName),
+   data(file.getData()),
+   frameSize(0),
+   frame(0)
+{
+   size_t const size = file.getSize();
+
+   if (size < sizeof(header)) { Util::error("Replay: " + fileName + " isn't a recording"); }
+   memcpy(&header, data, sizeof(header));
+   if (0 != memcmp(header.magic, Recorder::magic, sizeof(header.magic)) || Recorder::version != header.version)
+   {
+      Util::error("Replay: " + fileName + " isn't a recording");
+   }
+   if (sizeof(Real) != header.realSize)
+   {
+      Util::error("Replay: " + fileName + " was recorded by a different build");
+   }
+   // The sizes are compared by subtracting from what's left, so a corrupt
+   // header can't overflow them.
+   unsigned long long const indexOffset = header.indexOffset;
+   if (0 == header.keyframeInterval || header.frameCount / header.keyframeInterval + 1 != header.keyframeCount ||
+       size < header.characterCount || indexOffset < sizeof(header) || size < indexOffset || 0 != indexOffset % 8 ||
+       (size - indexOffset) / sizeof(unsigned long long) < header.keyframeCount)
+   {
+      Util::error("Replay: " + fileName + " is incomplete");
+   }
+
+   frameSize = Recorder::getFrameSize(getCharacterCount());
+
+   // Each keyframe's frames follow its snapshot, and they all come before
+   // the index.
+   unsigned long long const* const index = reinterpret_cast<unsigned long long const*>(data + indexOffset);
+   frameStarts.resize(size_t(header.keyframeCount));
+   for (size_t k = 0; k < frameStarts.size(); k++)
+   {
+      if (index[k] < sizeof(header) || indexOffset < index[k] || 0 != index[k] % 8 ||
+          indexOffset - index[k] < sizeof(unsigned long long))
+      {
+         Util::error("Replay: " + fileName + " is incomplete");
+      }
+      unsigned long long const snapshotSize = *reinterpret_cast<unsigned long long const*>(data + index[k]);
+      if (indexOffset - index[k] - sizeof(snapshotSize) < snapshotSize)
+      {
+         Util::error("Replay: " + fileName + " is incomplete");
+      }
+      unsigned long long const start = index[k] + sizeof(snapshotSize) + snapshotSize + (8 - snapshotSize % 8) % 8;
+      unsigned long long const framesInKeyframe = min(header.keyframeInterval, header.frameCount - k * header.keyframeInterval);
+      if (indexOffset < start || (indexOffset - start) / frameSize < framesInKeyframe)
+      {
+         Util::error("Replay: " + fileName + " is incomplete");
+      }
+      frameStarts[k] = size_t(start);
+   }
+}
+
+Replay::~Replay()
+{
+}
+
+void Replay::getActions(vector<RealVec2>& directions, vector<Real>& speeds)
+{
+   size_t const characterCount = getCharacterCount();
+   directions.resize(characterCount, RealVec2(Util2D::dim));
+   speeds.resize(characterCount);
+
+   // The time step comes first.
+   Real const* f = getFrameData(frame) + 1;
+   for (size_t i = 0; i < characterCount; i++)
+   {
+      for (size_t k = 0; k < Util2D::dim; k++)
+      {
+         directions[i][k] = *f++;
+      }
+      speeds[i] = *f++;
+   }
+
+   frame++;
+}
+
+void Replay::seek(size_t const frame, Simulator& sim, GameState& gs, Perception& perception, BehaviorProgram* program)
+{
+   TG_ASSERT(frame <= getFrameCount());
+   TG_ASSERT_MSG(sim.getReplay() == this, "Replay: seek with a simulator that is replaying it");
+
+   size_t const keyframe = frame / getKeyframeInterval();
+   // The keyframe is its snapshot's size followed by the snapshot.
+   size_t const start = size_t(reinterpret_cast<unsigned long long const*>(data + header.indexOffset)[keyframe]);
+   unsigned long long const snapshotSize = *reinterpret_cast<unsigned long long const*>(data + start);
+   snapshot.assign(data + start + sizeof(snapshotSize), size_t(snapshotSize));
+   snapshot.restore(gs, perception, program);
+
+   this->frame = keyframe * getKeyframeInterval();
+   while (this->frame < frame)
+   {
+      step(sim, gs);
+   }
+}
+
+void Replay::step(Simulator& sim, GameState& gs)
+{
+   gs.incFrame();
+   sim.forward(getDeltaT());
+}
@@ -0,0 +1,132 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_REPLAY_H
+#define TG_REPLAY_H
+
+#include "Recorder.h"
+#include "MappedFile.h"
+
+#include <string>
+#include <vector>
+
+namespace tagGame
+{
+   class Simulator;
+
+   /// Plays back a match recorded by a Recorder.  The simulator steps the
+   /// world forward with the recorded actions instead of asking the
+   /// characters' controllers (see Simulator::setReplay), so a replay runs
+   /// as fast as the physics allows, and comes out the same as the match
+   /// did.
+   ///
+   /// The file is memory mapped (see MappedFile), so nothing is copied
+   /// until it's needed.  Finding any frame,
+   /// or the keyframe before it, is just arithmetic, so seeking to a frame
+   /// takes at most keyframeInterval steps no matter how long the match was.
+   ///
+   /// The replay has to be into a world set up the same way as the one
+   /// that was recorded (the same characters, obstacles and seed).
+   class Replay
+   {
+   public:
+      explicit Replay(std::string const& fileName);
+      ~Replay();
+
+      inline size_t getFrameCount() const;
+      inline size_t getCharacterCount() const;
+      inline size_t getKeyframeInterval() const;
+      inline Random::Bits getSeed() const;
+
+      /// The frame the next step replays (getFrameCount() at the end).
+      inline size_t getFrame() const;
+
+      /// The time step of the next frame.
+      inline Real getDeltaT() const;
+
+      /// Called by the simulator instead of generating actions.  Moves on
+      /// to the next frame.
+      void getActions(std::vector<RealVec2>& directions, std::vector<Real>& speeds);
+
+      /// Puts the world back to how it was just before frame was played, by
+      /// restoring the keyframe before it and replaying the frames in
+      /// between.  The simulator has to be replaying this.
+      void seek(size_t const frame, Simulator& sim, GameState& gs, Perception& perception,
+                BehaviorProgram* program = NULL);
+
+      /// Replays the next frame.
+      void step(Simulator& sim, GameState& gs);
+   protected:
+   private:
+      // Not copyable.
+      Replay(Replay const&);
+      Replay& operator=(Replay const&);
+
+      inline Real const* getFrameData(size_t const frame) const;
+
+      MappedFile file;
+      std::string fileName;
+      char const* data;
+      Recorder::Header header;
+      // Where the first frame after each keyframe starts.
+      std::vector<size_t> frameStarts;
+      size_t frameSize;
+      size_t frame;
+      Snapshot snapshot;
+   };
+
+   size_t Replay::getFrameCount() const
+   {
+      return size_t(header.frameCount);
+   }
+
+   size_t Replay::getCharacterCount() const
+   {
+      return size_t(header.characterCount);
+   }
+
+   size_t Replay::getKeyframeInterval() const
+   {
+      return size_t(header.keyframeInterval);
+   }
+
+   Random::Bits Replay::getSeed() const
+   {
+      return header.seed;
+   }
+
+   size_t Replay::getFrame() const
+   {
+      return frame;
+   }
+
+   Real Replay::getDeltaT() const
+   {
+      return getFrameData(frame)[0];
+   }
+
+   Real const* Replay::getFrameData(size_t const frame) const
+   {
+      TG_ASSERT_MSG(frame < getFrameCount(), "Replay: past the end of the recording");
+
+      size_t const keyframeInterval = getKeyframeInterval();
+      return reinterpret_cast<Real const*>(data + frameStarts[frame / keyframeInterval] +
+                                           (frame % keyframeInterval) * frameSize);
+   }
+}
+
+#endif
@@ -0,0 +1,448 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#include "Scenario.h"
+#include "GameState.h"
+#include "Perception.h"
+#include "ControllerWander.h"
+#include "Util2D.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+using namespace tagGame;
+
+using namespace std;
+
+char const Scenario::magic[8] = { 't', 'a', 'g', 'G', 'a', 'm', 'e', 'S' };
+
+Scenario::Scenario(RealVec2 const& worldDim, Random::Bits const seed) :
+   worldDim(worldDim),
+   seed(seed),
+   tagged(-1),
+   random(seed),
+   file(NULL)
+{
+   point();
+}
+
+Scenario::Scenario(string const& fileName) :
+   worldDim(Util2D::dim),
+   seed(0),
+   tagged(-1),
+   file(NULL)
+{
+   // Binary files start with the magic number.
+   {
+      ifstream in(fileName.c_str(), ios::binary);
+      if (!in) { Util::error("Scenario: can't open " + fileName); }
+      char m[sizeof(magic)];
+      in.read(m, sizeof(m));
+      if (in && 0 == memcmp(m, magic, sizeof(magic)))
+      {
+         file = new MappedFile(fileName);
+      }
+   }
+
+   if (file)
+   {
+      loadBinary();
+   }
+   else
+   {
+      loadText(fileName);
+   }
+}
+
+Scenario::~Scenario()
+{
+   delete file;
+}
+
+void Scenario::point()
+{
+   characterCount = ownCharacterPositions.size();
+   characterPositions = characterCount ? &ownCharacterPositions[0] : NULL;
+   characterRadii = characterCount ? &ownCharacterRadii[0] : NULL;
+   characterMasses = characterCount ? &ownCharacterMasses[0] : NULL;
+   characterArchetypes = characterCount ? &ownCharacterArchetypes[0] : NULL;
+   circleCount = ownCirclePositions.size();
+   circlePositions = circleCount ? &ownCirclePositions[0] : NULL;
+   circleRadii = circleCount ? &ownCircleRadii[0] : NULL;
+   sideCount = ownSideBegins.size();
+   sideBegins = sideCount ? &ownSideBegins[0] : NULL;
+   sideEnds = sideCount ? &ownSideEnds[0] : NULL;
+   sideNormals = sideCount ? &ownSideNormals[0] : NULL;
+}
+
+void Scenario::addCharacter(RealVec2 const& position, Archetype const archetype, Real const radius, Real const mass)
+{
+   TG_ASSERT_MSG(!file, "Scenario: can't add to a scenario loaded from a binary file");
+   TG_ASSERT(archetype < archetypeCount && 0 < radius && 0 < mass);
+
+   ownCharacterPositions.push_back(position);
+   ownCharacterArchetypes.push_back((unsigned char)archetype);
+   ownCharacterRadii.push_back(radius);
+   ownCharacterMasses.push_back(mass);
+   point();
+}
+
+void Scenario::addCircle(RealVec2 const& position, Real const radius)
+{
+   TG_ASSERT_MSG(!file, "Scenario: can't add to a scenario loaded from a binary file");
+   TG_ASSERT(0 < radius);
+
+   ownCirclePositions.push_back(position);
+   ownCircleRadii.push_back(radius);
+   point();
+}
+
+void Scenario::addSide(RealVec2 const& begin, RealVec2 const& end, RealVec2 const& normal)
+{
+   TG_ASSERT_MSG(!file, "Scenario: can't add to a scenario loaded from a binary file");
+
+   ownSideBegins.push_back(begin);
+   ownSideEnds.push_back(end);
+   ownSideNormals.push_back(normal);
+   point();
+}
+
+void Scenario::addWalls()
+{
+   // The same sides, in the same order, as GameSetup::setupObstacles.
+   Real const w = worldDim[0];
+   Real const h = worldDim[1];
+   Real const corners[4][6] =
+   {
+      { 0, h, 0, 0, 1, 0 },
+      { w, h, w, 0, -1, 0 },
+      { w, 0, 0, 0, 0, 1 },
+      { w, h, 0, h, 0, -1 }
+   };
+
+   RealVec2 begin(Util2D::dim);
+   RealVec2 end(Util2D::dim);
+   RealVec2 normal(Util2D::dim);
+   for (size_t i = 0; i < 4; i++)
+   {
+      for (size_t k = 0; k < Util2D::dim; k++)
+      {
+         begin[k] = corners[i][k];
+         end[k] = corners[i][2 + k];
+         normal[k] = corners[i][4 + k];
+      }
+      addSide(begin, end, normal);
+   }
+}
+
+void Scenario::setTagged(int const character)
+{
+   TG_ASSERT_MSG(!file, "Scenario: can't add to a scenario loaded from a binary file");
+   TG_ASSERT(-1 <= character);
+
+   tagged = character;
+}
+
+void Scenario::loadText(string const& fileName)
+{
+   ifstream in(fileName.c_str());
+   if (!in) { Util::error("Scenario: can't open " + fileName); }
+
+   bool hasWorld = false;
+   bool hasEntities = false;
+   string line;
+   for (int lineNumber = 1; getline(in, line); lineNumber++)
+   {
+      string const where(fileName + ", line " + Util::itos(lineNumber) + ": ");
+
+      string::size_type const comment = line.find('#');
+      if (string::npos != comment) { line.erase(comment); }
+
+      istringstream words(line);
+      string keyword;
+      if (!(words >> keyword)) { continue; }
+
+      if ("world" == keyword)
+      {
+         if (hasEntities) { Util::error("Scenario: " + where + "world must come first"); }
+         words >> worldDim[0] >> worldDim[1];
+         if (!words || worldDim[0] <= 0 || worldDim[1] <= 0) { Util::error("Scenario: " + where + "expected world <width> <height>"); }
+         hasWorld = true;
+      }
+      else if ("seed" == keyword)
+      {
+         if (hasEntities) { Util::error("Scenario: " + where + "seed must come before anything is added"); }
+         words >> seed;
+         if (!words) { Util::error("Scenario: " + where + "expected seed <n>"); }
+         random.seed(seed);
+      }
+      else if ("character" == keyword || "characters" == keyword || "circle" == keyword || "circles" == keyword)
+      {
+         if (!hasWorld) { Util::error("Scenario: " + where + "world must come first"); }
+         hasEntities = true;
+
+         // Either where it is, or how many to put at random positions.
+         bool const isCount = 's' == keyword[keyword.size() - 1];
+         RealVec2 position(Util2D::dim);
+         size_t count = 1;
+         if (isCount) { words >> count; }
+         else { words >> position[0] >> position[1]; }
+         if (!words) { Util::error("Scenario: " + where + "expected " + keyword + (isCount ? " <count>" : " <x> <y>")); }
+
+         bool const isCharacter = 'h' == keyword[1];
+         Archetype archetype = npcArchetype;
+         Real radius = isCharacter ? GameSetup::characterRadius : Real(10);
+         Real mass = 1;
+         string name;
+         if (isCharacter && words >> name)
+         {
+            int a = 0;
+            while (a < archetypeCount && name != getArchetypeName(Archetype(a))) { a++; }
+            if (archetypeCount == a) { Util::error("Scenario: " + where + "unknown archetype " + name); }
+            archetype = Archetype(a);
+         }
+         // A failed read can overwrite the value, so read into x.
+         Real x;
+         if (words >> x)
+         {
+            radius = x;
+            if (isCharacter && words >> x) { mass = x; }
+         }
+         if (radius <= 0 || mass <= 0) { Util::error("Scenario: " + where + "radius and mass must be positive"); }
+         words.clear();
+         string extra;
+         if (words >> extra) { Util::error("Scenario: " + where + "unexpected " + extra); }
+
+         for (size_t i = 0; i < count; i++)
+         {
+            if (isCount)
+            {
+               Random::Scope scope(random);
+               position = Util2D::randomPosition(worldDim);
+            }
+            if (isCharacter) { addCharacter(position, archetype, radius, mass); }
+            else { addCircle(position, radius); }
+         }
+      }
+      else if ("side" == keyword)
+      {
+         hasEntities = true;
+         RealVec2 begin(Util2D::dim);
+         RealVec2 end(Util2D::dim);
+         RealVec2 normal(Util2D::dim);
+         words >> begin[0] >> begin[1] >> end[0] >> end[1] >> normal[0] >> normal[1];
+         if (!words) { Util::error("Scenario: " + where + "expected side <beginX> <beginY> <endX> <endY> <normalX> <normalY>"); }
+         addSide(begin, end, normal);
+      }
+      else if ("walls" == keyword)
+      {
+         if (!hasWorld) { Util::error("Scenario: " + where + "world must come first"); }
+         hasEntities = true;
+         addWalls();
+      }
+      else if ("tagged" == keyword)
+      {
+         words >> tagged;
+         if (!words || tagged < 0) { Util::error("Scenario: " + where + "expected tagged <character>"); }
+      }
+      else
+      {
+         Util::error("Scenario: " + where + "unknown entry " + keyword);
+      }
+   }
+
+   if (!hasWorld) { Util::error("Scenario: " + fileName + " has no world"); }
+   if (int(characterCount) <= tagged) { Util::error("Scenario: " + fileName + " tags a character it doesn't have"); }
+}
+
+void Scenario::saveText(string const& fileName) const
+{
+   ofstream out(fileName.c_str());
+   if (!out) { Util::error("Scenario: can't open " + fileName); }
+   // Enough digits to read back exactly the same numbers.
+   out << setprecision(numeric_limits<Real>::digits10 + 2);
+
+   out << "world " << worldDim[0] << " " << worldDim[1] << endl;
+   out << "seed " << seed << endl;
+   for (size_t i = 0; i < characterCount; i++)
+   {
+      out << "character " << characterPositions[i][0] << " " << characterPositions[i][1] << " "
+          << getArchetypeName(Archetype(characterArchetypes[i])) << " " << characterRadii[i] << " " << characterMasses[i] << endl;
+   }
+   for (size_t i = 0; i < circleCount; i++)
+   {
+      out << "circle " << circlePositions[i][0] << " " << circlePositions[i][1] << " " << circleRadii[i] << endl;
+   }
+   for (size_t i = 0; i < sideCount; i++)
+   {
+      out << "side " << sideBegins[i][0] << " " << sideBegins[i][1] << " " << sideEnds[i][0] << " " << sideEnds[i][1]
+          << " " << sideNormals[i][0] << " " << sideNormals[i][1] << endl;
+   }
+   if (0 <= tagged) { out << "tagged " << tagged << endl; }
+
+   if (!out) { Util::error("Scenario: can't write " + fileName); }
+}
+
+void Scenario::saveBinary(string const& fileName) const
+{
+   FILE* const out = fopen(fileName.c_str(), "wb");
+   if (!out) { Util::error("Scenario: can't open " + fileName); }
+
+   Header header;
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, magic, sizeof(magic));
+   header.version = version;
+   header.realSize = sizeof(Real);
+   header.worldDim[0] = worldDim[0];
+   header.worldDim[1] = worldDim[1];
+   header.seed = seed;
+   header.characterCount = characterCount;
+   header.circleCount = circleCount;
+   header.sideCount = sideCount;
+   header.tagged = tagged;
+   writeColumn(out, &header, 1);
+
+   writeColumn(out, characterPositions, characterCount);
+   writeColumn(out, characterRadii, characterCount);
+   writeColumn(out, characterMasses, characterCount);
+   writeColumn(out, characterArchetypes, characterCount);
+   writeColumn(out, circlePositions, circleCount);
+   writeColumn(out, circleRadii, circleCount);
+   writeColumn(out, sideBegins, sideCount);
+   writeColumn(out, sideEnds, sideCount);
+   writeColumn(out, sideNormals, sideCount);
+
+   if (0 != fclose(out)) { Util::error("Scenario: can't write " + fileName); }
+}
+
+void Scenario::loadBinary()
+{
+   char const* p = file->getData();
+   char const* const end = p + file->getSize();
+
+   if (file->getSize() < sizeof(Header)) { Util::error("Scenario: not a scenario file"); }
+   Header const& header(*readColumn<Header>(p, end, 1));
+   if (version != header.version) { Util::error("Scenario: not a scenario file"); }
+   if (sizeof(Real) != header.realSize) { Util::error("Scenario: file was written by a different build"); }
+   // The same checks as loadText, since setup trusts what it's given.
+   if (!(0 < header.worldDim[0] && 0 < header.worldDim[1])) { Util::error("Scenario: file has an empty world"); }
+   if (header.tagged < -1 || (0 <= header.tagged && header.characterCount <= (unsigned long long)header.tagged))
+   {
+      Util::error("Scenario: file tags a character it doesn't have");
+   }
+
+   worldDim[0] = Real(header.worldDim[0]);
+   worldDim[1] = Real(header.worldDim[1]);
+   seed = header.seed;
+   tagged = int(header.tagged);
+   characterCount = size_t(header.characterCount);
+   circleCount = size_t(header.circleCount);
+   sideCount = size_t(header.sideCount);
+
+   characterPositions = readColumn<RealVec2>(p, end, characterCount);
+   characterRadii = readColumn<Real>(p, end, characterCount);
+   characterMasses = readColumn<Real>(p, end, characterCount);
+   characterArchetypes = readColumn<unsigned char>(p, end, characterCount);
+   circlePositions = readColumn<RealVec2>(p, end, circleCount);
+   circleRadii = readColumn<Real>(p, end, circleCount);
+   sideBegins = readColumn<RealVec2>(p, end, sideCount);
+   sideEnds = readColumn<RealVec2>(p, end, sideCount);
+   sideNormals = readColumn<RealVec2>(p, end, sideCount);
+
+   for (size_t i = 0; i < characterCount; i++)
+   {
+      if (archetypeCount <= characterArchetypes[i]) { Util::error("Scenario: file has an unknown archetype"); }
+      if (!(0 < characterRadii[i] && 0 < characterMasses[i])) { Util::error("Scenario: radius and mass must be positive"); }
+   }
+   for (size_t i = 0; i < circleCount; i++)
+   {
+      if (!(0 < circleRadii[i])) { Util::error("Scenario: radius and mass must be positive"); }
+   }
+}
+
+BehaviorProgramPtr Scenario::setup(GameState& gs, PerceptionPtr perception, RendererPtr characterRenderer,
+                                   RendererPtr obstacleRenderer, GameSetup::Pools* pools,
+                                   GameSetup::NPCTuning const& tuning) const
+{
+   TG_ASSERT_MSG(gs.getWorldDim() == worldDim, "Scenario: set up a world of the scenario's size");
+
+   BehaviorProgramPtr program(new BehaviorProgram(*GameSetup::createNPCController(perception, GameSetup::characterRadius, tuning)));
+
+   // The characters are made straight in the game-state's store, then
+   // their columns are copied over the defaults.
+   EntityStore& characterStore(gs.getCharacterStore());
+   size_t const firstCharacter = characterStore.add(characterCount);
+   for (size_t i = 0; i < characterCount; i++)
+   {
+      size_t const id = firstCharacter + i;
+      CirclePtr cs(pools ? pools->circles.share(&characterStore, id) : CirclePtr(new Circle(&characterStore, id)));
+      ControllerPtr controller;
+      if (wanderArchetype == characterArchetypes[i]) { controller = ControllerPtr(new ControllerWander(perception)); }
+      else if (pools) { controller = pools->controllers.share(perception, program); }
+      else { controller = ControllerPtr(new ControllerProgram(perception, program)); }
+      CharacterPtr c(pools ? pools->characters.share(cs, controller) : CharacterPtr(new Character(cs, controller)));
+      c->setRenderer(characterRenderer);
+      gs.addCharacter(c);
+   }
+   if (0 < characterCount)
+   {
+      copy(characterPositions, characterPositions + characterCount, characterStore.getPositions().begin() + firstCharacter);
+      copy(characterRadii, characterRadii + characterCount, characterStore.getRadii().begin() + firstCharacter);
+      copy(characterMasses, characterMasses + characterCount, characterStore.getMasses().begin() + firstCharacter);
+   }
+
+   EntityStore& obstacleStore(gs.getObstacleStore());
+   size_t const firstCircle = obstacleStore.add(circleCount);
+   for (size_t i = 0; i < circleCount; i++)
+   {
+      size_t const id = firstCircle + i;
+      CirclePtr cs(pools ? pools->circles.share(&obstacleStore, id) : CirclePtr(new Circle(&obstacleStore, id)));
+      ObstaclePtr o(pools ? pools->obstacles.share(cs) : ObstaclePtr(new Obstacle(cs)));
+      o->setRenderer(obstacleRenderer);
+      gs.addObstacle(o);
+   }
+   if (0 < circleCount)
+   {
+      copy(circlePositions, circlePositions + circleCount, obstacleStore.getPositions().begin() + firstCircle);
+      copy(circleRadii, circleRadii + circleCount, obstacleStore.getRadii().begin() + firstCircle);
+   }
+
+   for (size_t i = 0; i < sideCount; i++)
+   {
+      SidePtr s(pools ? pools->sides.share() : SidePtr(new Side()));
+      s->setBegin(sideBegins[i]);
+      s->setEnd(sideEnds[i]);
+      s->setNormal(sideNormals[i]);
+      s->setDistance(sideNormals[i].dot(sideBegins[i]));
+      ObstaclePtr o(pools ? pools->obstacles.share(s) : ObstaclePtr(new Obstacle(s)));
+      o->setRenderer(obstacleRenderer);
+      gs.addObstacle(o);
+   }
+
+   // Anything that has been moved since the grid was last built.
+   gs.invalidateGrid();
+
+   if (0 <= tagged)
+   {
+      gs.getCharacterListBegin()[firstCharacter + tagged]->setTagged(gs.getTicks());
+   }
+
+   return program;
+}
@@ -0,0 +1,240 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_SCENARIO_H
+#define TG_SCENARIO_H
+
+#include "GameSetup.h"
+#include "MappedFile.h"
+#include "Random.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+namespace tagGame
+{
+   class GameState;
+
+   /// A description of a world to set up: its size and seed, and its
+   /// characters, circular obstacles and sides, so that layouts can be kept
+   /// in files rather than code.
+   ///
+   /// Scenarios have a text form for editing, one entry per line ('#'
+   /// starts a comment):
+   ///
+   ///    world <width> <height>
+   ///    seed <n>
+   ///    character <x> <y> [<archetype> [<radius> [<mass>]]]
+   ///    characters <count> [<archetype> [<radius> [<mass>]]]
+   ///    circle <x> <y> [<radius>]
+   ///    circles <count> [<radius>]
+   ///    side <beginX> <beginY> <endX> <endY> <normalX> <normalY>
+   ///    walls
+   ///    tagged <character>
+   ///
+   /// world and seed must come first.  characters and circles put count
+   /// of them at random positions, drawn from the world's random stream in
+   /// the same order as GameSetup does, so "characters 5", "circles 7" and
+   /// "walls" give the same world as GameSetup::setupCharacters and
+   /// setupObstacles.  walls puts a side along each edge of the world.
+   /// The archetypes are the controllers a character can have (see
+   /// getArchetypeName).  Characters are numbered from 0, in order.
+   ///
+   /// The binary form holds the same columns as the store (see
+   /// EntityStore), so loading it is just copying them in.  It is memory
+   /// mapped (see MappedFile), so a scenario with millions of characters
+   /// loads in a fraction of a second.  Like a snapshot, it is in the
+   /// machine's own byte order and type sizes.
+   class Scenario
+   {
+   public:
+      /// The controllers characters can have.
+      enum Archetype
+      {
+         npcArchetype,    ///< The NPC behavior (see GameSetup::createNPCController).
+         wanderArchetype, ///< Wander around (see ControllerWander).
+         archetypeCount
+      };
+
+      inline static char const* getArchetypeName(Archetype const archetype);
+
+      /// An empty scenario, in a world of worldDim.
+      Scenario(RealVec2 const& worldDim, Random::Bits const seed = 0);
+      /// Loads a scenario from a file, in either form.
+      explicit Scenario(std::string const& fileName);
+      ~Scenario();
+
+      inline RealVec2 const& getWorldDim() const;
+      inline Random::Bits getSeed() const;
+      inline size_t getCharacterCount() const;
+      inline size_t getCircleCount() const;
+      inline size_t getSideCount() const;
+      /// The character that starts off tagged, or -1 if none does.
+      inline int getTagged() const;
+
+      /// Scenarios loaded from binary files can't be added to.
+      void addCharacter(RealVec2 const& position, Archetype const archetype = npcArchetype,
+                        Real const radius = GameSetup::characterRadius, Real const mass = 1);
+      void addCircle(RealVec2 const& position, Real const radius = 10);
+      void addSide(RealVec2 const& begin, RealVec2 const& end, RealVec2 const& normal);
+      void addWalls();
+      void setTagged(int const character);
+
+      void saveText(std::string const& fileName) const;
+      void saveBinary(std::string const& fileName) const;
+
+      /// Adds everything to a game-state made with the scenario's world size
+      /// and seed.  NPCs all run one compiled program, which is returned
+      /// (see GameSetup::setupCharacters).  If pools are given, the objects
+      /// are allocated from them.
+      BehaviorProgramPtr setup(GameState& gs, PerceptionPtr perception, RendererPtr characterRenderer,
+                               RendererPtr obstacleRenderer, GameSetup::Pools* pools = NULL,
+                               GameSetup::NPCTuning const& tuning = GameSetup::NPCTuning()) const;
+
+      /// The binary form starts with a header, followed by each column in
+      /// the order the accessors are declared in, each padded to a multiple
+      /// of 8 bytes.
+      struct Header
+      {
+         char magic[8];
+         unsigned version;
+         unsigned realSize;
+         double worldDim[2];
+         Random::Bits seed;
+         unsigned long long characterCount;
+         unsigned long long circleCount;
+         unsigned long long sideCount;
+         long long tagged;
+      };
+
+      static char const magic[8];
+      static unsigned const version = 1;
+   protected:
+   private:
+      // Not copyable.
+      Scenario(Scenario const&);
+      Scenario& operator=(Scenario const&);
+
+      void loadText(std::string const& fileName);
+      void loadBinary();
+      void point();
+      template<class T> inline static void writeColumn(std::FILE* file, T const* column, size_t const n);
+      template<class T> inline static T const* readColumn(char const*& p, char const* const end, size_t const n);
+
+      RealVec2 worldDim;
+      Random::Bits seed;
+      int tagged;
+      // Draws the random positions.
+      Random random;
+
+      // Set if loaded from a binary file.
+      MappedFile* file;
+
+      // The columns, either in the vectors below or in the file.
+      size_t characterCount;
+      RealVec2 const* characterPositions;
+      Real const* characterRadii;
+      Real const* characterMasses;
+      unsigned char const* characterArchetypes;
+      size_t circleCount;
+      RealVec2 const* circlePositions;
+      Real const* circleRadii;
+      size_t sideCount;
+      RealVec2 const* sideBegins;
+      RealVec2 const* sideEnds;
+      RealVec2 const* sideNormals;
+
+      std::vector<RealVec2> ownCharacterPositions;
+      std::vector<Real> ownCharacterRadii;
+      std::vector<Real> ownCharacterMasses;
+      std::vector<unsigned char> ownCharacterArchetypes;
+      std::vector<RealVec2> ownCirclePositions;
+      std::vector<Real> ownCircleRadii;
+      std::vector<RealVec2> ownSideBegins;
+      std::vector<RealVec2> ownSideEnds;
+      std::vector<RealVec2> ownSideNormals;
+   };
+
+   char const* Scenario::getArchetypeName(Archetype const archetype)
+   {
+      static char const* const names[archetypeCount] =
+      {
+         "npc",
+         "wander"
+      };
+
+      TG_ASSERT(archetype < archetypeCount);
+      return names[archetype];
+   }
+
+   RealVec2 const& Scenario::getWorldDim() const
+   {
+      return worldDim;
+   }
+
+   Random::Bits Scenario::getSeed() const
+   {
+      return seed;
+   }
+
+   size_t Scenario::getCharacterCount() const
+   {
+      return characterCount;
+   }
+
+   size_t Scenario::getCircleCount() const
+   {
+      return circleCount;
+   }
+
+   size_t Scenario::getSideCount() const
+   {
+      return sideCount;
+   }
+
+   int Scenario::getTagged() const
+   {
+      return tagged;
+   }
+
+   template<class T>
+   void Scenario::writeColumn(std::FILE* file, T const* column, size_t const n)
+   {
+      char const padding[8] = { 0 };
+      size_t const size = n * sizeof(T);
+      if ((0 < n && 1 != fwrite(column, size, 1, file)) ||
+          (0 < size % 8 && 1 != fwrite(padding, 8 - size % 8, 1, file)))
+      {
+         Util::error("Scenario: can't write");
+      }
+   }
+
+   template<class T>
+   T const* Scenario::readColumn(char const*& p, char const* const end, size_t const n)
+   {
+      // Compared against what's left, so a corrupt count can't overflow.
+      size_t const left = size_t(end - p);
+      if (left / sizeof(T) < n) { Util::error("Scenario: file is incomplete"); }
+      T const* const column = reinterpret_cast<T const*>(p);
+      size_t const size = n * sizeof(T);
+      p += std::min(left, size + (8 - size % 8) % 8);
+      return column;
+   }
+}
+
+#endif
@@ -19,6 +19,7 @@
 #define TG_SHAPE_H
 
 #include "Util2D.h"
+#include "EntityStore.h"
 
 namespace tagGame
 {
@@ -38,25 +39,41 @@ namespace tagGame
    {
    public:
       inline Shape();
+      /// A shape that is a view onto entity id of store from the start,
+      /// without a store of its own, e.g. for filling in a game-state's
+      /// store directly (see Scenario).
+      inline Shape(EntityStore* store, size_t const id);
       inline virtual ~Shape();
 
-      inline RealVec const& getPosition() const;
-      inline void setPosition(RealVec const& position);
+      inline RealVec2 const& getPosition() const;
+      inline void setPosition(RealVec2 const& position);
 
-      inline RealVec const& getOrientation() const;
-      inline void setOrientation(RealVec const& orientation);
+      inline RealVec2 const& getOrientation() const;
+      inline void setOrientation(RealVec2 const& orientation);
+
+      /// A shape's position and orientation (and any other per-shape
+      /// fields) are stored in an entity store.  A new shape has a store of
+      /// its own, until it is bound to an entity in some other store (see
+      /// Obstacle::bind).  If owner is given, the shape keeps it alive.
+      inline void bind(EntityStore* store, size_t const id, EntityStorePtr owner = EntityStorePtr());
+      inline EntityStore* getStore() const;
+      inline size_t getId() const;
 
       virtual std::ostream& output(std::ostream& out) const = 0;
 
+      /// Calculate an axis aligned box that contains the shape.  Returns false
+      /// if the shape is unbounded, in which case lower and upper are unchanged.
+      virtual bool getBounds(RealVec2& lower, RealVec2& upper) const = 0;
+
       inline bool isTouching(Shape const& o) const;
 
       /// Calculate the nearest intersection point of a line in the
       /// direction v from the point p.
-      virtual RealVec nearestIntersection(RealVec const& p, RealVec const& v) const = 0;
+      virtual RealVec2 nearestIntersection(RealVec2 const& p, RealVec2 const& v) const = 0;
 
       /// Return a vector that is normal to o, with respect to this.
-      virtual RealVec normalTo(Shape const& o) const = 0;
-      virtual RealVec normalTo(Circle const& c) const = 0;
+      virtual RealVec2 normalTo(Shape const& o) const = 0;
+      virtual RealVec2 normalTo(Circle const& c) const = 0;
 
       // Multiple dispatch is implemented using virtual functions
       // only, as described in "Item 31: Making functions virtual with
@@ -70,10 +87,24 @@ namespace tagGame
 
       inline Real distanceSquaredTo(Shape const& o) const;
 
+      /// If this moved with velocity v relative to o, the earliest time from
+      /// now at which it would touch o (0 if it already does), or Inf if it
+      /// never would.  The time at which they would stop touching again, e.g.
+      /// by passing right through each other, is returned in leave (Inf if
+      /// they never would).
+      virtual Real timeToImpact(Shape const& o, RealVec2 const& v, Real& leave) const = 0;
+      virtual Real timeToImpact(Circle const& c, RealVec2 const& v, Real& leave) const = 0;
+      virtual Real timeToImpact(Side const& s, RealVec2 const& v, Real& leave) const = 0;
+
    protected:
    private:
-      RealVec position;
-      RealVec orientation;
+      // Shapes are views, so copying one would be ambiguous.
+      Shape(Shape const&);
+      Shape& operator=(Shape const&);
+
+      EntityStorePtr localStore;
+      EntityStore* store;
+      size_t id;
    };
 
    typedef std::vector<ShapePtr> ShapeList;
@@ -81,10 +112,17 @@ namespace tagGame
    typedef ShapeList::iterator ShapeIterator;
 
    Shape::Shape() :
-      position(Util2D::dim),
-      orientation(Util2D::dim)
+      localStore(new EntityStore()),
+      store(localStore.get()),
+      id(localStore->add())
    {
-      orientation[0] = 1;
+   }
+
+   Shape::Shape(EntityStore* store, size_t const id) :
+      store(store),
+      id(id)
+   {
+      TG_ASSERT(id < store->size());
    }
 
    Shape::~Shape()
@@ -96,26 +134,45 @@ namespace tagGame
       return o.output(out);
    }
 
-   RealVec const& Shape::getPosition() const
+   RealVec2 const& Shape::getPosition() const
    {
-      return position;
+      return store->getPositions()[id];
    }
 
-   void Shape::setPosition(RealVec const& position)
+   void Shape::setPosition(RealVec2 const& position)
    {
-      this->position = position;
+      store->getPositions()[id] = position;
    }
 
-   RealVec const& Shape::getOrientation() const
+   RealVec2 const& Shape::getOrientation() const
    {
-      return orientation;
+      return store->getOrientations()[id];
    }
 
-   void Shape::setOrientation(RealVec const& orientation)
+   void Shape::setOrientation(RealVec2 const& orientation)
    {
       TG_ASSERT(MathUtil::isAlmostEq(1, orientation.length()));
 
-      this->orientation = orientation;
+      store->getOrientations()[id] = orientation;
+   }
+
+   void Shape::bind(EntityStore* store, size_t const id, EntityStorePtr owner)
+   {
+      TG_ASSERT(store && id < store->size());
+
+      this->store = store;
+      this->id = id;
+      localStore = owner;
+   }
+
+   EntityStore* Shape::getStore() const
+   {
+      return store;
+   }
+
+   size_t Shape::getId() const
+   {
+      return id;
    }
 
    bool Shape::isTouching(Shape const& o) const
@@ -18,6 +18,7 @@
 #include "Side.h"
 #include "Circle.h"
 #include "Util2D.h"
+#include "Narrowphase.h"
 
 using namespace tagGame;
 
@@ -25,10 +26,9 @@ using namespace std;
 
 // TODO: pass normal and distance into constructor (analogously for circle)
 Side::Side() :
-   Shape(),
-   normal(Util2D::dim),
-   distance(Real(0))
+   Shape()
 {
+   getStore()->getShapeKinds()[getId()] = EntityStore::sideShape;
    // TODO: setPosition to something appropriate
 }
 
@@ -44,10 +44,17 @@ ostream& Side::output(ostream& out) const
    return out;
 }
 
-RealVec Side::nearestIntersection(RealVec const& p, RealVec const& v) const
+bool Side::getBounds(RealVec2& lower, RealVec2& upper) const
 {
-   RealVec u(end.relativeTo(begin));
-   RealVec r(Util2D::dim);
+   // Distances are measured to the whole line (see distanceTo), not just
+   // the segment from begin to end.
+   return false;
+}
+
+RealVec2 Side::nearestIntersection(RealVec2 const& p, RealVec2 const& v) const
+{
+   RealVec2 u(end.relativeTo(begin));
+   RealVec2 r(Util2D::dim);
 
    // Following code assumes 2D.
    TG_ASSERT(2 == Util2D::dim);
@@ -88,14 +95,14 @@ RealVec Side::nearestIntersection(RealVec const& p, RealVec const& v) const
    return r;
 }
 
-RealVec Side::normalTo(Shape const& o) const
+RealVec2 Side::normalTo(Shape const& o) const
 {
-   return normal;
+   return getNormal();
 }
 
-RealVec Side::normalTo(Circle const& o) const
+RealVec2 Side::normalTo(Circle const& o) const
 {  
-   return normal;
+   return getNormal();
 }  
 
 Real Side::distanceTo(Shape const& o) const
@@ -105,11 +112,7 @@ Real Side::distanceTo(Shape const& o) const
 
 Real Side::distanceTo(Circle const& c) const
 {
-   return Inf; // TODO: delete this line to turn collisions with sides back on
-
-   Real const d = normal.dot(c.getPosition()) - distance;
-
-   return d < 0 ? d + c.getRadius() : d - c.getRadius();
+   return Narrowphase::sideDistance(getNormal(), getDistance(), c.getPosition(), c.getRadius());
 }
 
 Real Side::distanceTo(Side const& s) const
@@ -119,4 +122,35 @@ Real Side::distanceTo(Side const& s) const
    return 0;
 }
 
+Real Side::timeToImpact(Shape const& o, RealVec2 const& v, Real& leave) const
+{
+   RealVec2 u(v);
+   return o.timeToImpact(*this, u.scale(-1), leave);
+}
+
+Real Side::timeToImpact(Circle const& c, RealVec2 const& v, Real& leave) const
+{
+   leave = Inf;
+   return Inf; // TODO: delete this line to turn collisions with sides back on (see distanceTo)
+
+   // Like distanceTo, everything behind the line counts as touching it, so
+   // once a circle touches a side it never stops.  The circle moves with
+   // velocity -v relative to the side.
+   Real const d = getNormal().dot(c.getPosition()) - getDistance() - c.getRadius();
+   if (d <= 0) { return 0; }
+
+   Real const speed = getNormal().dot(v);
+   if (speed <= 0) { return Inf; } // Not moving towards the side.
+
+   return d / speed;
+}
+
+Real Side::timeToImpact(Side const& s, RealVec2 const& v, Real& leave) const
+{
+   Util::error("Side::timeToImpact not implemented for side obstacles");
+
+   leave = Inf;
+   return Inf;
+}
+
 
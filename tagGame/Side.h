@@ -32,75 +32,81 @@ namespace tagGame
 
       virtual std::ostream& output(std::ostream& out) const;
 
-      inline void setNormal(RealVec const& normal);
+      inline void setNormal(RealVec2 const& normal);
 
       inline void setDistance(Real const distance);
 
-      inline RealVec const& getNormal() const;
+      inline RealVec2 const& getNormal() const;
 
       inline Real getDistance() const;
 
-      inline RealVec const& getBegin() const;
-      inline RealVec const& getEnd() const;
+      inline RealVec2 const& getBegin() const;
+      inline RealVec2 const& getEnd() const;
 
-      inline void setBegin(RealVec const& begin);
-      inline void setEnd(RealVec const& end);
+      inline void setBegin(RealVec2 const& begin);
+      inline void setEnd(RealVec2 const& end);
 
-      virtual RealVec nearestIntersection(RealVec const& p, RealVec const& v) const;
+      virtual bool getBounds(RealVec2& lower, RealVec2& upper) const;
 
-      virtual RealVec normalTo(Shape const& o) const;
-      virtual RealVec normalTo(Circle const& c) const;
+      virtual RealVec2 nearestIntersection(RealVec2 const& p, RealVec2 const& v) const;
+
+      virtual RealVec2 normalTo(Shape const& o) const;
+      virtual RealVec2 normalTo(Circle const& c) const;
 
       virtual Real distanceTo(Shape const& o) const;
       virtual Real distanceTo(Circle const& c) const;
       virtual Real distanceTo(Side const& s) const;
 
+      virtual Real timeToImpact(Shape const& o, RealVec2 const& v, Real& leave) const;
+      virtual Real timeToImpact(Circle const& c, RealVec2 const& v, Real& leave) const;
+      virtual Real timeToImpact(Side const& s, RealVec2 const& v, Real& leave) const;
+
    protected:
    private:
-      RealVec normal;
-      Real distance;
-      RealVec begin;
-      RealVec end;
+      // The normal and distance are kept in the entity store, as the side's
+      // orientation and radius (see EntityStore).
+      RealVec2 begin;
+      RealVec2 end;
    };
 
-   RealVec const& Side::getNormal() const
+   RealVec2 const& Side::getNormal() const
    {
-      return normal;
+      return getStore()->getOrientations()[getId()];
    }
 
    Real Side::getDistance() const
    {
-      return distance;
+      return getStore()->getRadii()[getId()];
    }
 
-   RealVec const& Side::getBegin() const
+   RealVec2 const& Side::getBegin() const
    {
       return begin;
    }
 
-   RealVec const& Side::getEnd() const
+   RealVec2 const& Side::getEnd() const
    {
       return end;
    }
 
-   void Side::setNormal(RealVec const& normal)
+   void Side::setNormal(RealVec2 const& normal)
    {
       // TG_ASSERT_MSG(1 == normal.length() && 2 == normal.size() && (normal[0] = 0 || normal[2] = 0),
       //              string("Only 2D axis aligned side obstacles are currently supported"));
-      this->normal = normal;
+      getStore()->getOrientations()[getId()] = normal;
    }
 
    void Side::setDistance(Real const distance)
    {
-      this->distance = distance;
+      getStore()->getRadii()[getId()] = distance;
    }
 
-   void Side::setBegin(RealVec const& begin)
+   void Side::setBegin(RealVec2 const& begin)
    {
       this->begin = begin;
    }
 
-   void Side::setEnd(RealVec const& end)
+   void Side::setEnd(RealVec2 const& end)
    {
       this->end = end;
    }
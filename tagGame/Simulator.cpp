@@ -18,15 +18,84 @@
 #include "Simulator.h"
 #include "Character.h"
 #include "GameState.h"
-#include "Timer.h"
 #include "Controller.h"
 #include "Perception.h"
 #include "Util2D.h"
+#include "Integrator.h"
+#include "Random.h"
+#include "Timer.h"
+#include "Recorder.h"
+#include "Replay.h"
+#include "Telemetry.h"
+
+#include <algorithm>
+#include <limits>
 
 using namespace tagGame;
 
-Simulator::Simulator(GameState* gs) :
-   gs(gs)
+using namespace std;
+
+// Generates the actions for a range of characters.
+class Simulator::GenerateActionsJob : public ThreadPool::Job
+{
+public:
+   GenerateActionsJob(Simulator& simulator) :
+      simulator(simulator)
+   {
+   }
+
+   virtual void run(size_t const begin, size_t const end, size_t const worker)
+   {
+      simulator.generateActions(begin, end);
+   }
+
+private:
+   Simulator& simulator;
+};
+
+// Orders contacts by their keys, so that duplicates end up together.
+static bool isContactBefore(Narrowphase::Pair const& a, Narrowphase::Pair const& b)
+{
+   return Telemetry::getKey(a) < Telemetry::getKey(b);
+}
+
+static bool isSameContact(Narrowphase::Pair const& a, Narrowphase::Pair const& b)
+{
+   return Telemetry::getKey(a) == Telemetry::getKey(b);
+}
+
+// Resolves the collisions in a range of islands.
+class Simulator::ResolveCollisionsJob : public ThreadPool::Job
+{
+public:
+   ResolveCollisionsJob(Simulator& simulator, int const now) :
+      simulator(simulator),
+      now(now)
+   {
+   }
+
+   virtual void run(size_t const begin, size_t const end, size_t const worker)
+   {
+      simulator.resolveCollisions(begin, end, now);
+   }
+
+private:
+   Simulator& simulator;
+   int const now;
+};
+
+Simulator::Simulator(GameState* gs, size_t const threadCount) :
+   gs(gs),
+   pool(threadCount),
+   collisionPassCount(0),
+   maxCollisionPasses(20),
+   substepCount(0),
+   maxSubsteps(8),
+   restitution(0.75),
+   minTagInterval(3000),
+   recorder(NULL),
+   replay(NULL),
+   telemetry(NULL)
 {
 }
 
@@ -38,70 +107,238 @@ void Simulator::forward(Real const deltaT)
    // This avoids any of the problems that are described in the book with one
    // character continually "going first".
 
-   generateActions();
+   // Anything random outside of a character's controller comes from the
+   // world's own stream.
+   Random::Scope scope(gs->getRandom());
+
+   // Timing each phase only costs a few clock reads per step.
+   Real const start = Timer::preciseTime();
+   if (replay)
+   {
+      TG_ASSERT_MSG(deltaT == replay->getDeltaT(), "Simulator: replay with the recorded time step");
+      replay->getActions(desiredDirections, desiredSpeeds);
+   }
+   else
+   {
+      generateActions();
+   }
+   Real t0 = Timer::preciseTime();
+   stats.add(PerfStats::generateActionsTime, t0 - start);
+
    processActions(deltaT);
+   Real t1 = Timer::preciseTime();
+   stats.add(PerfStats::processActionsTime, t1 - t0);
+
+   stepContacts.clear();
    resolveCollisions();
+   t0 = Timer::preciseTime();
+   stats.add(PerfStats::resolveCollisionsTime, t0 - t1);
+
    updateGameState(deltaT);
+   t1 = Timer::preciseTime();
+   stats.add(PerfStats::updateGameStateTime, t1 - t0);
+
+   // Each sub-step finds its own contacts, and pairs that stay touching are
+   // found again, so they only count once.
+   sort(stepContacts.begin(), stepContacts.end(), isContactBefore);
+   stepContacts.erase(unique(stepContacts.begin(), stepContacts.end(), isSameContact), stepContacts.end());
+
+   // The step is recorded once it's over, so that a keyframe is taken
+   // between steps.
+   if (recorder) { recorder->addFrame(deltaT, desiredDirections, desiredSpeeds); }
+   if (telemetry) { telemetry->addFrame(*gs, stepContacts); }
+
+   stats.add(PerfStats::forwardTime, t1 - start);
+   stats.add(PerfStats::contactCount, Real(stepContacts.size()));
+   stats.add(PerfStats::collisionPassCount, Real(collisionPassCount));
 }
 
 void Simulator::generateActions()
 {
+   size_t const characterCount = gs->getCharacterListEnd() - gs->getCharacterListBegin();
+   desiredDirections.resize(characterCount, RealVec2(Util2D::dim));
+   desiredSpeeds.resize(characterCount);
+
+   // Everything the workers share has to be ready before they start.
+   gs->getGrid();
+   perceptions.clear();
    for (CharacterIterator i = gs->getCharacterListBegin(); i != gs->getCharacterListEnd(); i++)
    {
-      // IMPORTANT: Make all percepts be computed from character i's point of view.
-      (*i)->getController()->getPerception()->setMe(&**i);
-      (*i)->calcAction();
+      Perception* perception((*i)->getController()->getPerception().get());
+      if (perception->getWorkerCount() < pool.getThreadCount())
+      {
+         perception->setWorkerCount(pool.getThreadCount());
+      }
+      // Characters usually share a perception object, so this only has to
+      // weed out a few duplicates.
+      if (perceptions.empty() || perceptions.back() != perception)
+      {
+         perceptions.push_back(perception);
+      }
+   }
+   sort(perceptions.begin(), perceptions.end());
+   perceptions.erase(unique(perceptions.begin(), perceptions.end()), perceptions.end());
+   for (vector<Perception*>::const_iterator i = perceptions.begin(); i != perceptions.end(); i++)
+   {
+      (*i)->update();
    }
-}
 
-void Simulator::processActions(Real const deltaT)
-{
-   for (CharacterIterator i = gs->getCharacterListBegin(); i != gs->getCharacterListEnd(); i++)
+   GenerateActionsJob job(*this);
+   // Characters are handed out a few at a time, as controllers are
+   // expensive enough that there's little to gain from bigger chunks.
+   pool.run(job, characterCount, 8);
+
+   size_t hitCount = 0;
+   size_t missCount = 0;
+   for (vector<Perception*>::const_iterator i = perceptions.begin(); i != perceptions.end(); i++)
    {
-      // calculate character's required acceleration from the desired velocity
-      RealVec acceleration((*i)->getAction().getDesiredDirection());
-      acceleration.scale((*i)->getAction().getDesiredSpeed() * (*i)->getMaxSpeed());
-      acceleration.subtract((*i)->getVelocity());
-      // calculate required force from the acceleration
-      RealVec force(acceleration.scale((*i)->getMass()));
-      // force can't be greater than the maximum possible force
-      force.clampMaxLength((*i)->getMaxForce());
-      // re-calculate acceleration for new (possibly) clamped force
-      acceleration = force.scale(1.0/(*i)->getMass());
-      acceleration.scale(deltaT);
-      // v = character's current velocity
-      RealVec v((*i)->getVelocity());
-      v.add(acceleration);
+      size_t hits, misses;
+      (*i)->getCacheCounts(hits, misses);
+      (*i)->resetCacheCounts();
+      hitCount += hits;
+      missCount += misses;
+   }
+   stats.add(PerfStats::perceptionCacheHits, Real(hitCount));
+   stats.add(PerfStats::perceptionCacheMisses, Real(missCount));
+}
 
-      v.clampMaxLength((*i)->getMaxSpeed());
+void Simulator::generateActions(size_t const begin, size_t const end)
+{
+   CharacterIterator const characters = gs->getCharacterListBegin();
+   vector<Random>& randoms(gs->getCharacterStore().getRandoms());
 
-      (*i)->setVelocity(v);
+   for (size_t id = begin; id < end; id++)
+   {
+      Character& c(*characters[id]);
+      // Each character draws from its own stream, so its choices don't
+      // depend on which thread it's run on (or what else is run there).
+      Random::Scope scope(randoms[id]);
+      // IMPORTANT: Make all percepts be computed from character c's point of view.
+      c.getController()->getPerception()->setMe(&c);
+      c.calcAction();
+
+      Action const& action(c.getAction());
+      desiredDirections[id] = action.getDesiredDirection();
+      desiredSpeeds[id] = action.getDesiredSpeed();
    }
 }
 
-void Simulator::updateCharacter(Real const deltaT, Character* c)
+void Simulator::processActions(Real const deltaT)
 {
-   RealVec p(c->getPosition());
-   RealVec v(c->getVelocity());
-   v.scale(deltaT);
-   p.add(v);
-   p.wrap(gs->getWorldDim());
-   c->setPosition(p);
+   Integrator::accelerate(gs->getCharacterStore(), desiredDirections, desiredSpeeds, deltaT);
 }
 
 void Simulator::updateGameState(Real const deltaT)
 {
-   for (CharacterIterator i = gs->getCharacterListBegin(); i != gs->getCharacterListEnd(); i++)
+   Real remaining = deltaT;
+   substepCount = 0;
+
+   while (true)
    {
-      updateCharacter(deltaT, &**i);
+      substepCount++;
+      Real const t = substepCount < maxSubsteps ? findFirstImpact(remaining) : remaining;
+
+      Integrator::move(gs->getCharacterStore(), gs->getWorldDim(), t);
+      gs->invalidateGrid();
+
+      if (remaining <= t) { break; }
+      remaining -= t;
+
+      // Something has just hit something else, so its collision has to be
+      // resolved before it can go any further.
+      resolveCollisions();
+   }
+
+   stats.add(PerfStats::substepCount, Real(substepCount));
+
+   gs->incTime(deltaT);
+}
+
+Real Simulator::findFirstImpact(Real const deltaT)
+{
+   EntityStore const& store(gs->getCharacterStore());
+   std::vector<Real> const& speeds(store.getSpeeds());
+   std::vector<Real> const& radii(store.getRadii());
+
+   if (speeds.empty()) { return deltaT; }
+
+   // Two objects can't travel further into each other than the sum of
+   // their speeds times deltaT, so most of the time there's no need to
+   // look any closer.
+   Real const maxSpeed = *max_element(speeds.begin(), speeds.end());
+   std::vector<Real> const& obstacleSpeeds(gs->getObstacleStore().getSpeeds());
+   Real const maxObstacleSpeed = obstacleSpeeds.empty() ? Real(0) : *max_element(obstacleSpeeds.begin(), obstacleSpeeds.end());
+   Real const minRadius = *min_element(radii.begin(), radii.end());
+   if ((maxSpeed + std::max(maxSpeed, maxObstacleSpeed)) * deltaT <= Real(0.5) * minRadius)
+   {
+      return deltaT;
+   }
+
+   SpatialGrid const& grid(gs->getGrid());
+   CharacterIterator const characters = gs->getCharacterListBegin();
+   ObstacleIterator const obstacles = gs->getNonCharacterObstacleListBegin();
+   size_t const characterCount = gs->getCharacterListEnd() - characters;
+
+   RealVec2 lower(Util2D::dim);
+   RealVec2 upper(Util2D::dim);
+   Real first = deltaT;
+
+   for (size_t i = 0; i < characterCount; i++)
+   {
+      Character const& c = *characters[i];
+      Real const tolerance = Real(0.5) * radii[i];
+
+      // Anything c could hit is within its bounds, stretched by the
+      // furthest anything could travel towards it.
+      if (!c.getBounds(lower, upper))
+      {
+         lower.set(-numeric_limits<Real>::max());
+         upper.set(numeric_limits<Real>::max());
+      }
+      Real const reach = (speeds[i] + std::max(maxSpeed, maxObstacleSpeed)) * first;
+      for (size_t k = 0; k < Util2D::dim; k++)
+      {
+         lower[k] -= reach;
+         upper[k] += reach;
+      }
+
+      nearby.clear();
+      grid.queryCharacters(lower, upper, nearby);
+      size_t const nearbyCharacterCount = nearby.size();
+      grid.queryObstacles(lower, upper, nearby);
+
+      for (size_t n = 0; n < nearby.size(); n++)
+      {
+         bool const isObstacle = nearbyCharacterCount <= n;
+         // Each pair of characters only needs checking once.
+         if (!isObstacle && nearby[n] <= i) { continue; }
+         Obstacle const& o = isObstacle ? *obstacles[nearby[n]] : *characters[nearby[n]];
+
+         Real leave;
+         Real const enter = c.timeToImpact(o, leave);
+         // Pairs that are already touching are left to resolveCollisions.
+         if (enter <= 0 || first <= enter) { continue; }
+
+         // Only split the step if the pair would get too far into each other
+         // before the end of it.  If it is, the sub-step ends just after they
+         // touch, so that they are sure to be found touching (rounding could
+         // leave them a hair apart at the exact time of impact).
+         Real const speed = c.getVelocity().relativeTo(o.getVelocity()).length();
+         if (speed * (std::min(leave, first) - enter) > tolerance)
+         {
+            first = std::min(first, enter + Real(0.01) * tolerance / speed);
+         }
+      }
    }
+
+   return first;
 }
 
-static RealVec scaleAndAdd(RealVec const& v0, Real s0, RealVec const& v1, Real s1)
+static RealVec2 scaleAndAdd(RealVec2 const& v0, Real s0, RealVec2 const& v1, Real s1)
 {
-   RealVec v(v0);
+   RealVec2 v(v0);
    v.scale(s0);
-   RealVec tmp(v1);
+   RealVec2 tmp(v1);
    tmp.scale(s1);
    v.add(tmp);
 
@@ -110,91 +347,255 @@ static RealVec scaleAndAdd(RealVec const& v0, Real s0, RealVec const& v1, Real s
 
 void Simulator::resolveCollisions()
 {
-   Real const e = 0.75;           // coefficient of restitution
-   int const minTagInterval = 3000; // minimum time allowed between re-tagging
+   // Nothing moves while collisions are being resolved so the pairs that are
+   // touching can be found once, using the grid, rather than testing every
+   // pair on every pass.  The contacts are found in the same order that the
+   // pairs would be visited by looping over all of them.
+   findContacts();
+   findIslands();
+   stepContacts.insert(stepContacts.end(), contacts.begin(), contacts.end());
+
+   size_t const islandCount = getIslandCount();
+   islandPassCounts.resize(islandCount);
+
+   ResolveCollisionsJob job(*this, gs->getTicks());
+   // Most islands are just a pair of characters, so hand them out in bunches.
+   pool.run(job, islandCount, 32);
+
+   collisionPassCount = islandPassCounts.empty() ? 0 : *max_element(islandPassCounts.begin(), islandPassCounts.end());
+}
 
-   int const now = Timer::theTimer().gameTicks();
-   int loopCount = 0;
+void Simulator::resolveCollisions(size_t const beginIsland, size_t const endIsland, int const now)
+{
+   CharacterIterator const characters = gs->getCharacterListBegin();
+   ObstacleIterator const obstacles = gs->getNonCharacterObstacleListBegin();
 
-   while (true)
+   for (size_t island = beginIsland; island < endIsland; island++)
    {
-      bool isCollision = false;
+      std::vector<size_t>::const_iterator const begin = islandContacts.begin() + islandStarts[island];
+      std::vector<size_t>::const_iterator const end = islandContacts.begin() + islandStarts[island + 1];
 
-      for (CharacterIterator i = gs->getCharacterListBegin(); i != gs->getCharacterListEnd(); i++)
+      int passCount = 0;
+      bool isCollision = true;
+      while (isCollision && passCount < maxCollisionPasses)
       {
-         for (CharacterIterator j = gs->getCharacterListBegin(); j != gs->getCharacterListEnd(); j++)
+         isCollision = false;
+         passCount++;
+
+         for (std::vector<size_t>::const_iterator k = begin; k != end; k++)
          {
-            if (*i == *j) { continue; }
-   
-            if (!(*i)->isColliding(**j)) { continue; }
+            Contact const& contact(contacts[*k]);
+            Character& c = *characters[contact.i];
 
-            isCollision = true;
+            if (contact.isObstacle)
+            {
+               isCollision |= resolveCollision(c, *obstacles[contact.j], contactNormals[*k]);
+            }
+            else
+            {
+               isCollision |= resolveCollision(c, *characters[contact.j], contactNormals[*k], now);
+            }
+         }
+      }
 
-            // We have to keep computing these in case they changed in a previous collision
-            RealVec const& uc((*i)->getVelocity());
-            Real const mc = (*i)->getMass();
+      islandPassCounts[island] = passCount;
+   }
+}
 
-            RealVec t((*i)->normalTo(**j));
-            RealVec n(Util2D::perpendicularTo(t).getRow(0));
+void Simulator::findContacts()
+{
+   SpatialGrid const& grid(gs->getGrid());
+   candidates.clear();
 
-            Real const uct = uc.dot(t);
-            Real const ucn = uc.dot(n);
+   CharacterIterator const characters = gs->getCharacterListBegin();
+   size_t const characterCount = gs->getCharacterListEnd() - characters;
 
-            Real const mo = (*j)->getMass();
+   RealVec2 lower(Util2D::dim);
+   RealVec2 upper(Util2D::dim);
 
-            RealVec const& uo((*j)->getVelocity());
+   // The grid gives the pairs that are close enough that they might be
+   // touching, then they are all checked at once.
+   for (size_t i = 0; i < characterCount; i++)
+   {
+      Character const& c = *characters[i];
+      if (!c.getBounds(lower, upper))
+      {
+         // Something without bounds could be touching anything.
+         lower.set(-numeric_limits<Real>::max());
+         upper.set(numeric_limits<Real>::max());
+      }
 
-            Real const uot = uo.dot(t);
-            Real const uon = uo.dot(n);
+      Contact candidate;
+      candidate.i = i;
 
-            Real const k = (uct - uot)/(mc + mo);
-            Real const vct = uct - (1 + e) * mo * k;
-            Real const vot = uot + (1 + e) * mc * k;
+      nearby.clear();
+      grid.queryCharacters(lower, upper, nearby);
+      candidate.isObstacle = false;
+      for (std::vector<size_t>::const_iterator j = nearby.begin(); j != nearby.end(); j++)
+      {
+         if (*j == i) { continue; }
+         candidate.j = *j;
+         candidates.push_back(candidate);
+      }
 
-            (*i)->setVelocity(scaleAndAdd(t, vct, n, ucn));
+      nearby.clear();
+      grid.queryObstacles(lower, upper, nearby);
+      candidate.isObstacle = true;
+      for (std::vector<size_t>::const_iterator j = nearby.begin(); j != nearby.end(); j++)
+      {
+         candidate.j = *j;
+         candidates.push_back(candidate);
+      }
+   }
 
-            (*j)->setVelocity(scaleAndAdd(t, vot, n, uon));
+   Narrowphase::evaluate(gs->getCharacterStore(), gs->getObstacleStore(), candidates,
+                         candidateDistances, candidateNormals);
 
-            // TODO: re-factor to remove duplicated code
-            if ((*j)->getIsTagged() && (now - gs->getLastTaggedTime() > minTagInterval))
-            {
-               setTagged(**i, **j);
-            }
-            else if ((*i)->getIsTagged() && (now - gs->getLastTaggedTime() > minTagInterval))
-            {
-               setTagged(**j, **i);
-            }
-         }
+   contacts.clear();
+   contactNormals.clear();
+   for (size_t k = 0; k < candidates.size(); k++)
+   {
+      // Same test as Obstacle::isTouching.
+      if (0 < candidateDistances[k]) { continue; }
+      contacts.push_back(candidates[k]);
+      contactNormals.push_back(candidateNormals[k]);
+   }
+}
 
-         for (ObstacleIterator j = gs->getNonCharacterObstacleListBegin(); j != gs->getNonCharacterObstacleListEnd(); j++)
-         {
-            if (!(*i)->isColliding(**j)) { continue; }
+size_t Simulator::findIslandRoot(size_t i)
+{
+   while (islandRoots[i] != i)
+   {
+      // Path halving keeps the trees flat.
+      islandRoots[i] = islandRoots[islandRoots[i]];
+      i = islandRoots[i];
+   }
 
-            isCollision = true;
+   return i;
+}
 
-            RealVec const& uc((*i)->getVelocity());
+void Simulator::findIslands()
+{
+   size_t const characterCount = gs->getCharacterListEnd() - gs->getCharacterListBegin();
+   size_t const none = characterCount;
 
-            RealVec t((*i)->normalTo(**j));
-            RealVec n(Util2D::perpendicularTo(t).getRow(0));
+   // Characters touching each other are in the same island.  Obstacles
+   // aren't moved by collisions, so they don't join islands together.
+   islandRoots.resize(characterCount);
+   for (size_t i = 0; i < characterCount; i++)
+   {
+      islandRoots[i] = i;
+   }
+   for (std::vector<Contact>::const_iterator k = contacts.begin(); k != contacts.end(); k++)
+   {
+      if (k->isObstacle) { continue; }
 
-            Real const uct = uc.dot(t);
-            Real const ucn = uc.dot(n);
+      size_t const i = findIslandRoot(k->i);
+      size_t const j = findIslandRoot(k->j);
+      if (i != j) { islandRoots[max(i, j)] = min(i, j); }
+   }
 
-            Real const vct = -e * uct;
-            (*i)->setVelocity(scaleAndAdd(t, vct, n, ucn));
-         }
+   // Number the islands in the order their first contacts were found, and
+   // count the contacts in each.
+   islandIds.assign(characterCount, none);
+   islandStarts.clear();
+   islandStarts.push_back(0);
+   for (std::vector<Contact>::const_iterator k = contacts.begin(); k != contacts.end(); k++)
+   {
+      size_t& island(islandIds[findIslandRoot(k->i)]);
+      if (none == island)
+      {
+         island = islandStarts.size() - 1;
+         islandStarts.push_back(0);
       }
+      islandStarts[island + 1]++;
+   }
 
-      if (!isCollision) { break; }
+   for (size_t k = 1; k < islandStarts.size(); k++)
+   {
+      islandStarts[k] += islandStarts[k - 1];
+   }
 
-      TG_ASSERT_MSG(loopCount < 1000, "something probably went wrong");
-      loopCount++;
+   // Fill in each island's contacts, keeping them in order.
+   islandContacts.resize(contacts.size());
+   std::vector<size_t> next(islandStarts.begin(), islandStarts.end() - 1);
+   for (size_t k = 0; k < contacts.size(); k++)
+   {
+      islandContacts[next[islandIds[findIslandRoot(contacts[k].i)]]++] = k;
    }
 }
 
+bool Simulator::resolveCollision(Character& c, Character& o, RealVec2 const& t, int const now)
+{
+   Real const e = restitution;
+
+   // We have to keep computing these in case they changed in a previous collision
+   RealVec2 const& uc(c.getVelocity());
+   RealVec2 const& uo(o.getVelocity());
+
+   // The pair is known to be touching, and t is c's normal to o, so this
+   // is the rest of Obstacle::isColliding.
+   if (Narrowphase::approachSpeed(uc, uo, t) <= 0) { return false; }
+
+   Real const mc = c.getMass();
+
+   RealVec2 n(Util2D::perpendicular(t));
+
+   Real const uct = uc.dot(t);
+   Real const ucn = uc.dot(n);
+
+   Real const mo = o.getMass();
+
+   Real const uot = uo.dot(t);
+   Real const uon = uo.dot(n);
+
+   Real const k = (uct - uot)/(mc + mo);
+   Real const vct = uct - (1 + e) * mo * k;
+   Real const vot = uot + (1 + e) * mc * k;
+
+   c.setVelocity(scaleAndAdd(t, vct, n, ucn));
+
+   o.setVelocity(scaleAndAdd(t, vot, n, uon));
+
+   // Only the tagged character's island can tag anyone, so islands being
+   // resolved in parallel don't touch the game-state's tag time.
+   if ((o.getIsTagged() || c.getIsTagged()) && now - gs->getLastTaggedTime() > minTagInterval)
+   {
+      if (o.getIsTagged())
+      {
+         setTagged(c, o);
+      }
+      else if (c.getIsTagged())
+      {
+         setTagged(o, c);
+      }
+   }
+
+   return true;
+}
+
+bool Simulator::resolveCollision(Character& c, Obstacle& o, RealVec2 const& t)
+{
+   Real const e = restitution;
+
+   RealVec2 const& uc(c.getVelocity());
+
+   if (Narrowphase::approachSpeed(uc, o.getVelocity(), t) <= 0) { return false; }
+
+   RealVec2 n(Util2D::perpendicular(t));
+
+   Real const uct = uc.dot(t);
+   Real const ucn = uc.dot(n);
+
+   Real const vct = -e * uct;
+   c.setVelocity(scaleAndAdd(t, vct, n, ucn));
+
+   return true;
+}
+
 void Simulator::setTagged(Character& newTagged, Character& oldTagged)
 {
-   int const now = Timer::theTimer().gameTicks();
+   int const now = gs->getTicks();
 
    newTagged.setTagged(now);
    oldTagged.setTagged(-1);
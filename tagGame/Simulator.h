@@ -20,27 +20,314 @@
 
 #include "Action.h"
 #include "GameState.h"
+#include "ThreadPool.h"
+#include "PerfStats.h"
+#include "Narrowphase.h"
 
 namespace tagGame
 {
+   class Recorder;
+   class Replay;
+   class Telemetry;
+
    /// This class is responsible for implementing the game's physics and
    /// updating the game-state accordingly.
    class Simulator
    {
    public:
-      Simulator(GameState* gs);
+      /// Characters' actions are generated in parallel on a pool of
+      /// threadCount threads (0 for one per processor).
+      Simulator(GameState* gs, size_t const threadCount = 1);
       void forward(Real const deltaT);
+
+      inline size_t getThreadCount() const;
+
+      /// The phases of a step forward, in the order they are run.
+      enum Phase
+      {
+         generateActionsPhase,
+         processActionsPhase,
+         resolveCollisionsPhase,
+         updateGameStatePhase,
+         phaseCount
+      };
+
+      inline static char const* getPhaseName(Phase const phase);
+
+      /// Wall clock time (in seconds) spent on a phase of the last step.
+      inline Real getPhaseTime(Phase const phase) const;
+
+      /// Counters for the recent steps.  Anything that isn't part of a step,
+      /// like drawing, can add its own counts too.
+      inline PerfStats& getStats();
+      inline PerfStats const& getStats() const;
+
+      /// The number of pairs of objects that were touching in the last step,
+      /// in any of its sub-steps.
+      inline size_t getContactCount() const;
+
+      /// The number of passes over the contacts it took to resolve the last
+      /// step's collisions (at least one, unless nothing was touching).
+      /// This is the most passes taken by any island (see below).
+      inline int getCollisionPassCount() const;
+
+      /// Collisions are resolved by applying an impulse to each pair of
+      /// colliding objects in turn, and repeating until a pass finds nothing
+      /// colliding.  Characters that touch each other, directly or through
+      /// other characters, form an island whose contacts are resolved
+      /// independently of (and in parallel with) those of other islands.
+      /// Each island gets at most maxPasses passes, so dense crowds can't
+      /// make a step take arbitrarily long.  Anything still colliding after
+      /// that is left to be resolved in the next step.
+      inline int getMaxCollisionPasses() const;
+      inline void setMaxCollisionPasses(int const maxPasses);
+
+      /// The number of islands in the last step.
+      inline size_t getIslandCount() const;
+
+      /// Collisions are found from where things are at the end of a step,
+      /// so with a big enough time step fast objects could pass right
+      /// through each other, or end up deep inside each other.  To prevent
+      /// that, a step is split into sub-steps that end at the first time any
+      /// two objects would travel more than half the character's radius
+      /// into each other, where their collision is resolved before going on.
+      /// Each step is split into at most maxSubsteps sub-steps.  At ordinary
+      /// time steps, nothing moves fast enough to need splitting.
+      inline int getMaxSubsteps() const;
+      inline void setMaxSubsteps(int const maxSubsteps);
+
+      /// The number of sub-steps in the last step.
+      inline int getSubstepCount() const;
+
+      /// The coefficient of restitution of every collision: 1 for
+      /// perfectly bouncy, 0 for not bouncy at all.
+      inline Real getRestitution() const;
+      inline void setRestitution(Real const restitution);
+
+      /// The least time (in ticks, see Timer) allowed between one tag and
+      /// the next, so the newly tagged character can't tag straight back.
+      inline int getMinTagInterval() const;
+      inline void setMinTagInterval(int const minTagInterval);
+
+      /// While recording, the actions used in every step are recorded,
+      /// along with a keyframe every so often (see Recorder).  NULL stops
+      /// recording.
+      inline Recorder* getRecorder() const;
+      inline void setRecorder(Recorder* recorder);
+
+      /// While replaying, each step uses the recorded actions of the
+      /// replay's next frame, instead of asking the characters' controllers,
+      /// and has to use the recorded time step (see Replay).  NULL stops
+      /// replaying.
+      inline Replay* getReplay() const;
+      inline void setReplay(Replay* replay);
+
+      /// The state of the world at the end of every step is streamed to
+      /// telemetry (see Telemetry).  NULL stops it.
+      inline Telemetry* getTelemetry() const;
+      inline void setTelemetry(Telemetry* telemetry);
    protected:
    private:
+      class GenerateActionsJob;
+      friend class GenerateActionsJob;
+
       void generateActions();
+      void generateActions(size_t const begin, size_t const end);
       void processActions(Real const deltaT);
-      void updateCharacter(Real const deltaT, Character* c);
+
+      class ResolveCollisionsJob;
+      friend class ResolveCollisionsJob;
+
       void resolveCollisions();
+      void resolveCollisions(size_t const beginIsland, size_t const endIsland, int const now);
+      void findContacts();
+      void findIslands();
+      size_t findIslandRoot(size_t i);
+      Real findFirstImpact(Real const deltaT);
+      bool resolveCollision(Character& c, Character& o, RealVec2 const& t, int const now);
+      bool resolveCollision(Character& c, Obstacle& o, RealVec2 const& t);
       void updateGameState(Real const deltaT);
       void setTagged(Character& newTagged, Character& oldTagged);
 
+      // A pair of objects that are touching.  The second object is a
+      // character, or a non-character obstacle if isObstacle is true.
+      typedef Narrowphase::Pair Contact;
+
       GameState* gs;
+      ThreadPool pool;
+
+      // The actions selected by each character, ready for processActions.
+      std::vector<RealVec2> desiredDirections;
+      std::vector<Real> desiredSpeeds;
+      std::vector<Contact> contacts;
+      // The normal from the first object of each contact to the second.
+      // Nothing moves while collisions are resolved, so it doesn't change.
+      std::vector<RealVec2> contactNormals;
+      // The contacts found in every sub-step of the current step, each pair
+      // once, in order of their keys (see Telemetry::getKey).
+      std::vector<Contact> stepContacts;
+      std::vector<size_t> nearby;
+      // Pairs that might be touching, and the distances between them.
+      std::vector<Contact> candidates;
+      std::vector<Real> candidateDistances;
+      std::vector<RealVec2> candidateNormals;
+
+      // The perception objects used by the characters.
+      std::vector<Perception*> perceptions;
+
+      // Islands of contacts, in compressed sparse row form: the contacts in
+      // island k are islandContacts[islandStarts[k]] up to (but not
+      // including) islandContacts[islandStarts[k + 1]], in contact order.
+      std::vector<size_t> islandStarts;
+      std::vector<size_t> islandContacts;
+      // For each character, its parent in a union-find forest of islands.
+      std::vector<size_t> islandRoots;
+      // For each root character, its island's number.
+      std::vector<size_t> islandIds;
+      std::vector<int> islandPassCounts;
+
+      PerfStats stats;
+      int collisionPassCount;
+      int maxCollisionPasses;
+      int substepCount;
+      int maxSubsteps;
+      Real restitution;
+      int minTagInterval;
+
+      Recorder* recorder;
+      Replay* replay;
+      Telemetry* telemetry;
    };
+
+   size_t Simulator::getThreadCount() const
+   {
+      return pool.getThreadCount();
+   }
+
+   char const* Simulator::getPhaseName(Phase const phase)
+   {
+      static char const* const names[phaseCount] =
+      {
+         "generateActions",
+         "processActions",
+         "resolveCollisions",
+         "updateGameState"
+      };
+
+      TG_ASSERT(phase < phaseCount);
+      return names[phase];
+   }
+
+   Real Simulator::getPhaseTime(Phase const phase) const
+   {
+      TG_ASSERT(phase < phaseCount);
+      // The phases are the first of the counters, in the same order.
+      return stats.getHistogram(PerfStats::Counter(PerfStats::generateActionsTime + phase)).getLast();
+   }
+
+   PerfStats& Simulator::getStats()
+   {
+      return stats;
+   }
+
+   PerfStats const& Simulator::getStats() const
+   {
+      return stats;
+   }
+
+   size_t Simulator::getContactCount() const
+   {
+      return stepContacts.size();
+   }
+
+   int Simulator::getCollisionPassCount() const
+   {
+      return collisionPassCount;
+   }
+
+   int Simulator::getMaxCollisionPasses() const
+   {
+      return maxCollisionPasses;
+   }
+
+   void Simulator::setMaxCollisionPasses(int const maxPasses)
+   {
+      TG_ASSERT(0 < maxPasses);
+      maxCollisionPasses = maxPasses;
+   }
+
+   size_t Simulator::getIslandCount() const
+   {
+      return islandStarts.empty() ? 0 : islandStarts.size() - 1;
+   }
+
+   int Simulator::getMaxSubsteps() const
+   {
+      return maxSubsteps;
+   }
+
+   void Simulator::setMaxSubsteps(int const maxSubsteps)
+   {
+      TG_ASSERT(0 < maxSubsteps);
+      this->maxSubsteps = maxSubsteps;
+   }
+
+   int Simulator::getSubstepCount() const
+   {
+      return substepCount;
+   }
+
+   Real Simulator::getRestitution() const
+   {
+      return restitution;
+   }
+
+   void Simulator::setRestitution(Real const restitution)
+   {
+      TG_ASSERT(0 <= restitution && restitution <= 1);
+      this->restitution = restitution;
+   }
+
+   int Simulator::getMinTagInterval() const
+   {
+      return minTagInterval;
+   }
+
+   void Simulator::setMinTagInterval(int const minTagInterval)
+   {
+      TG_ASSERT(0 <= minTagInterval);
+      this->minTagInterval = minTagInterval;
+   }
+
+   Recorder* Simulator::getRecorder() const
+   {
+      return recorder;
+   }
+
+   void Simulator::setRecorder(Recorder* recorder)
+   {
+      this->recorder = recorder;
+   }
+
+   Replay* Simulator::getReplay() const
+   {
+      return replay;
+   }
+
+   void Simulator::setReplay(Replay* replay)
+   {
+      this->replay = replay;
+   }
+
+   Telemetry* Simulator::getTelemetry() const
+   {
+      return telemetry;
+   }
+
+   void Simulator::setTelemetry(Telemetry* telemetry)
+   {
+      this->telemetry = telemetry;
+   }
 }
 
 #endif
@@ -0,0 +1,54 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#include "Snapshot.h"
+#include "GameState.h"
+#include "Perception.h"
+#include "BehaviorProgram.h"
+
+using namespace tagGame;
+
+using namespace std;
+
+Snapshot::Snapshot()
+{
+}
+
+void Snapshot::capture(GameState const& gs, Perception const& perception, BehaviorProgram const* program)
+{
+   // Keep the buffer's memory for next time.
+   buffer.clear();
+
+   gs.save(*this);
+   perception.save(*this);
+   write(bool(program));
+   if (program) { program->save(*this); }
+}
+
+void Snapshot::restore(GameState& gs, Perception& perception, BehaviorProgram* program) const
+{
+   size_t offset = 0;
+
+   gs.restore(*this, offset);
+   perception.restore(*this, offset);
+   bool hasProgram;
+   read(offset, hasProgram);
+   TG_ASSERT_MSG(hasProgram == bool(program), "Snapshot: restore with the same program as capture");
+   if (program) { program->restore(*this, offset); }
+
+   TG_ASSERT(offset == buffer.size());
+}
@@ -0,0 +1,167 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_SNAPSHOT_H
+#define TG_SNAPSHOT_H
+
+#include "Util.h"
+
+#include <cstring>
+#include <vector>
+
+namespace tagGame
+{
+   class GameState;
+   class Perception;
+   class BehaviorProgram;
+
+   /// The complete state of a world at a frame boundary, in one contiguous
+   /// buffer, e.g. for rolling back, trying out what-ifs, or resetting a
+   /// world between runs without setting it up again.  The state is copied
+   /// an array at a time (see EntityStore), rather than by visiting each
+   /// character and obstacle, and a snapshot that is captured again re-uses
+   /// its buffer, so capturing and restoring are about as fast as copying
+   /// the memory.
+   ///
+   /// A snapshot holds state, not objects, so it can only be restored into
+   /// a world with the same characters and obstacles as the one it was
+   /// captured from: the same world, or a replica of it (see
+   /// ControllerLookahead).  Characters that run a compiled program (see
+   /// BehaviorProgram) keep their controllers' state (e.g. when they last
+   /// made a decision) in the program, so it is captured too if the program
+   /// is given.  The state of controller trees isn't captured.
+   class Snapshot
+   {
+   public:
+      Snapshot();
+
+      void capture(GameState const& gs, Perception const& perception, BehaviorProgram const* program = NULL);
+      void restore(GameState& gs, Perception& perception, BehaviorProgram* program = NULL) const;
+
+      /// The size of the snapshot in bytes.
+      inline size_t size() const;
+
+      /// The snapshot's bytes, e.g. for saving it to a file (see Recorder),
+      /// and setting them, e.g. from a file (see Replay).
+      inline char const* data() const;
+      inline void assign(void const* p, size_t const n);
+
+      /// Used by the classes whose state is captured to write their fields
+      /// into the buffer, and read them back in the same order starting from
+      /// offset.  Only for types that can be copied byte by byte.  The bytes
+      /// may come from a file, so reading past the end is an error, and an
+      /// array can be required to have n elements.
+      inline void write(void const* p, size_t const n);
+      template<class T> inline void write(T const& x);
+      template<class T> inline void writeArray(std::vector<T> const& v);
+
+      inline void read(size_t& offset, void* p, size_t const n) const;
+      template<class T> inline void read(size_t& offset, T& x) const;
+      template<class T> inline void readArray(size_t& offset, std::vector<T>& v) const;
+      template<class T> inline void readArray(size_t& offset, std::vector<T>& v, size_t const n) const;
+      /// Whether the array at offset is the same as v, without reading it.
+      template<class T> inline bool isArrayEqual(size_t const offset, std::vector<T> const& v) const;
+
+   protected:
+   private:
+      std::vector<char> buffer;
+   };
+
+   size_t Snapshot::size() const
+   {
+      return buffer.size();
+   }
+
+   char const* Snapshot::data() const
+   {
+      return buffer.empty() ? NULL : &buffer[0];
+   }
+
+   void Snapshot::assign(void const* p, size_t const n)
+   {
+      char const* const bytes = static_cast<char const*>(p);
+      buffer.assign(bytes, bytes + n);
+   }
+
+   void Snapshot::write(void const* p, size_t const n)
+   {
+      size_t const offset = buffer.size();
+      buffer.resize(offset + n);
+      if (0 < n) { memcpy(&buffer[offset], p, n); }
+   }
+
+   template<class T>
+   void Snapshot::write(T const& x)
+   {
+      write(&x, sizeof(T));
+   }
+
+   template<class T>
+   void Snapshot::writeArray(std::vector<T> const& v)
+   {
+      write(v.size());
+      if (!v.empty()) { write(&v[0], v.size() * sizeof(T)); }
+   }
+
+   void Snapshot::read(size_t& offset, void* p, size_t const n) const
+   {
+      if (buffer.size() < offset || buffer.size() - offset < n) { Util::error("Snapshot: is incomplete"); }
+
+      if (0 < n) { memcpy(p, &buffer[offset], n); }
+      offset += n;
+   }
+
+   template<class T>
+   void Snapshot::read(size_t& offset, T& x) const
+   {
+      read(offset, &x, sizeof(T));
+   }
+
+   template<class T>
+   void Snapshot::readArray(size_t& offset, std::vector<T>& v) const
+   {
+      size_t n;
+      read(offset, n);
+      // Checked before resizing, so a corrupt count can't allocate or overflow.
+      if ((buffer.size() - offset) / sizeof(T) < n) { Util::error("Snapshot: is incomplete"); }
+      v.resize(n);
+      if (0 < n) { read(offset, &v[0], n * sizeof(T)); }
+   }
+
+   template<class T>
+   void Snapshot::readArray(size_t& offset, std::vector<T>& v, size_t const n) const
+   {
+      size_t m;
+      read(offset, m);
+      if (n != m) { Util::error("Snapshot: an array has the wrong number of elements"); }
+      if ((buffer.size() - offset) / sizeof(T) < n) { Util::error("Snapshot: is incomplete"); }
+      v.resize(n);
+      if (0 < n) { read(offset, &v[0], n * sizeof(T)); }
+   }
+
+   template<class T>
+   bool Snapshot::isArrayEqual(size_t const offset, std::vector<T> const& v) const
+   {
+      size_t n;
+      size_t end = offset;
+      read(end, n);
+      if (n != v.size() || buffer.size() < end + n * sizeof(T)) { return false; }
+      return 0 == n || 0 == memcmp(&buffer[end], &v[0], n * sizeof(T));
+   }
+}
+
+#endif
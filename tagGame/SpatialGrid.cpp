@@ -0,0 +1,421 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+
+#include "SpatialGrid.h"
+#include "GameState.h"
+#include "Util2D.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace tagGame;
+
+using namespace std;
+
+SpatialGrid::SpatialGrid() :
+   gs(NULL),
+   cellSize(1),
+   colCount(1),
+   rowCount(1)
+{
+}
+
+void SpatialGrid::build(GameState const& gs)
+{
+   this->gs = &gs;
+
+   RealVec2 const& worldDim(gs.getWorldDim());
+   size_t const characterCount = gs.getCharacterListEnd() - gs.getCharacterListBegin();
+
+   lower.resize(characterCount, RealVec2(Util2D::dim));
+   upper.resize(characterCount, RealVec2(Util2D::dim));
+   isBounded.resize(characterCount);
+
+   Real maxSize = 0;
+   size_t i = 0;
+   for (CharacterIteratorConst c = gs.getCharacterListBegin(); c != gs.getCharacterListEnd(); c++, i++)
+   {
+      isBounded[i] = (*c)->getBounds(lower[i], upper[i]);
+      if (isBounded[i])
+      {
+         maxSize = max(maxSize, upper[i].relativeTo(lower[i]).maxElement());
+      }
+   }
+
+   // Aim for about one character per cell, but make the cells at least as
+   // big as the biggest character so that no character is in more than
+   // four cells.
+   Real const area = worldDim[0] * worldDim[1];
+   cellSize = 0 < characterCount ? sqrt(area/Real(characterCount)) : worldDim.maxElement();
+   cellSize = max(cellSize, maxSize);
+   TG_ASSERT(0 < cellSize);
+   colCount = max(size_t(1), size_t(ceil(worldDim[0]/cellSize)));
+   rowCount = max(size_t(1), size_t(ceil(worldDim[1]/cellSize)));
+
+   insert(lower, upper, isBounded, characters);
+
+   size_t const obstacleCount = gs.getNonCharacterObstacleListEnd() - gs.getNonCharacterObstacleListBegin();
+   lower.resize(obstacleCount, RealVec2(Util2D::dim));
+   upper.resize(obstacleCount, RealVec2(Util2D::dim));
+   isBounded.resize(obstacleCount);
+
+   i = 0;
+   for (ObstacleIteratorConst o = gs.getNonCharacterObstacleListBegin(); o != gs.getNonCharacterObstacleListEnd(); o++, i++)
+   {
+      isBounded[i] = (*o)->getBounds(lower[i], upper[i]);
+   }
+
+   insert(lower, upper, isBounded, obstacles);
+
+   // Where each character and non-character obstacle is in the list of all
+   // obstacles.
+   characterOrder.resize(characterCount);
+   obstacleOrder.resize(obstacleCount);
+   EntityStore const* const characterStore = &gs.getCharacterStore();
+   i = 0;
+   for (ObstacleIteratorConst j = gs.getObstacleListBegin(); j != gs.getObstacleListEnd(); j++, i++)
+   {
+      if ((*j)->getStore() == characterStore)
+      {
+         characterOrder[(*j)->getId()] = i;
+      }
+      else
+      {
+         TG_ASSERT((*j)->getStore() == &gs.getObstacleStore());
+         obstacleOrder[(*j)->getId()] = i;
+      }
+   }
+}
+
+void SpatialGrid::insert(vector<RealVec2> const& lower, vector<RealVec2> const& upper,
+                         vector<bool> const& isBounded, CellLists& lists)
+{
+   // First count how many items are in each cell, then work out where each
+   // cell's list starts, then fill in the lists.
+   lists.start.assign(colCount * rowCount + 1, 0);
+   lists.unbounded.clear();
+   lists.outside.clear();
+
+   Real const width = Real(colCount) * cellSize;
+   Real const height = Real(rowCount) * cellSize;
+
+   for (size_t i = 0; i < isBounded.size(); i++)
+   {
+      if (!isBounded[i])
+      {
+         lists.unbounded.push_back(i);
+         continue;
+      }
+
+      if (lower[i][0] < 0 || lower[i][1] < 0 || width <= upper[i][0] || height <= upper[i][1])
+      {
+         lists.outside.push_back(i);
+      }
+
+      for (size_t r = row(lower[i][1]); r <= row(upper[i][1]); r++)
+      {
+         for (size_t c = col(lower[i][0]); c <= col(upper[i][0]); c++)
+         {
+            lists.start[r * colCount + c + 1]++;
+         }
+      }
+   }
+
+   for (size_t k = 1; k < lists.start.size(); k++)
+   {
+      lists.start[k] += lists.start[k - 1];
+   }
+
+   lists.items.resize(lists.start.back());
+   cursor.assign(lists.start.begin(), lists.start.end() - 1);
+
+   for (size_t i = 0; i < isBounded.size(); i++)
+   {
+      if (!isBounded[i]) { continue; }
+
+      for (size_t r = row(lower[i][1]); r <= row(upper[i][1]); r++)
+      {
+         for (size_t c = col(lower[i][0]); c <= col(upper[i][0]); c++)
+         {
+            lists.items[cursor[r * colCount + c]++] = i;
+         }
+      }
+   }
+}
+
+void SpatialGrid::queryCharacters(RealVec2 const& lower, RealVec2 const& upper, vector<size_t>& result) const
+{
+   query(characters, lower, upper, result);
+}
+
+void SpatialGrid::queryObstacles(RealVec2 const& lower, RealVec2 const& upper, vector<size_t>& result) const
+{
+   query(obstacles, lower, upper, result);
+}
+
+void SpatialGrid::query(CellLists const& lists, RealVec2 const& lower, RealVec2 const& upper, vector<size_t>& result) const
+{
+   size_t const first = result.size();
+
+   for (size_t r = row(lower[1]); r <= row(upper[1]); r++)
+   {
+      for (size_t c = col(lower[0]); c <= col(upper[0]); c++)
+      {
+         size_t const k = r * colCount + c;
+         result.insert(result.end(), lists.items.begin() + lists.start[k], lists.items.begin() + lists.start[k + 1]);
+      }
+   }
+   result.insert(result.end(), lists.unbounded.begin(), lists.unbounded.end());
+
+   // Objects that overlap more than one cell are found more than once.
+   sort(result.begin() + first, result.end());
+   result.erase(unique(result.begin() + first, result.end()), result.end());
+}
+
+Character* SpatialGrid::nearestCharacter(Obstacle const& from) const
+{
+   return static_cast<Character*>(nearest(from, false));
+}
+
+Obstacle* SpatialGrid::nearestObstacle(Obstacle const& from) const
+{
+   return nearest(from, true);
+}
+
+Obstacle* SpatialGrid::nearest(Obstacle const& from, bool const isObstacles) const
+{
+   TG_ASSERT(isValid());
+
+   Nearest best = { Inf, 0, NULL };
+
+   for (size_t i = 0; i < characters.unbounded.size(); i++)
+   {
+      considerNearest(from, characters.unbounded[i], false, best);
+   }
+   for (size_t i = 0; isObstacles && i < obstacles.unbounded.size(); i++)
+   {
+      considerNearest(from, obstacles.unbounded[i], true, best);
+   }
+
+   // Anything not yet found is outside the cells searched so far, so it is
+   // at least as far away as the edge of those cells, less the furthest that
+   // from's surface can be from its position.
+   RealVec2 const& p(from.getPosition());
+   Real extent = Inf;
+   RealVec2 lower(Util2D::dim);
+   RealVec2 upper(Util2D::dim);
+   if (from.getBounds(lower, upper))
+   {
+      RealVec2 corner(Util2D::dim);
+      for (size_t d = 0; d < Util2D::dim; d++)
+      {
+         corner[d] = max(upper[d] - p[d], p[d] - lower[d]);
+      }
+      extent = corner.length();
+   }
+
+   // Search the cells in square rings of increasing size around p.
+   long const cx = long(col(p[0]));
+   long const cy = long(row(p[1]));
+   long const cols = long(colCount);
+   long const rows = long(rowCount);
+
+   for (long ring = 0; ; ring++)
+   {
+      long const c0 = max(cx - ring, 0L);
+      long const c1 = min(cx + ring, cols - 1);
+      long const r0 = max(cy - ring, 0L);
+      long const r1 = min(cy + ring, rows - 1);
+
+      for (long r = r0; r <= r1; r++)
+      {
+         if (r == cy - ring || r == cy + ring)
+         {
+            for (long c = c0; c <= c1; c++)
+            {
+               considerNearestCell(from, size_t(r * cols + c), isObstacles, best);
+            }
+         }
+         else
+         {
+            if (0 <= cx - ring) { considerNearestCell(from, size_t(r * cols + cx - ring), isObstacles, best); }
+            if (cx + ring < cols) { considerNearestCell(from, size_t(r * cols + cx + ring), isObstacles, best); }
+         }
+      }
+
+      Real edge = Inf;
+      if (0 < cx - ring) { edge = min(edge, p[0] - Real(cx - ring) * cellSize); }
+      if (cx + ring < cols - 1) { edge = min(edge, Real(cx + ring + 1) * cellSize - p[0]); }
+      if (0 < cy - ring) { edge = min(edge, p[1] - Real(cy - ring) * cellSize); }
+      if (cy + ring < rows - 1) { edge = min(edge, Real(cy + ring + 1) * cellSize - p[1]); }
+
+      // Every cell has been searched.
+      if (Inf == edge) { break; }
+
+      if (best.which && best.distance < edge - extent) { break; }
+   }
+
+   return best.which;
+}
+
+void SpatialGrid::considerNearestCell(Obstacle const& from, size_t const k, bool const isObstacles, Nearest& best) const
+{
+   for (size_t i = characters.start[k]; i < characters.start[k + 1]; i++)
+   {
+      considerNearest(from, characters.items[i], false, best);
+   }
+   for (size_t i = obstacles.start[k]; isObstacles && i < obstacles.start[k + 1]; i++)
+   {
+      considerNearest(from, obstacles.items[i], true, best);
+   }
+}
+
+void SpatialGrid::considerNearest(Obstacle const& from, size_t const k, bool const isObstacles, Nearest& best) const
+{
+   Obstacle* o = isObstacles ? obstacle(k) : character(k);
+   if (&from == o) { return; }
+
+   size_t const order = isObstacles ? obstacleOrder[k] : characterOrder[k];
+   Real const d = from.distanceTo(*o);
+   if (d < best.distance || (best.which && d == best.distance && order < best.order))
+   {
+      best.distance = d;
+      best.order = order;
+      best.which = o;
+   }
+}
+
+Obstacle* SpatialGrid::nearestIntersecting(Obstacle const& from, RealVec2 const& p, RealVec2 const& v) const
+{
+   TG_ASSERT(isValid());
+
+   Nearest best = { Inf, 0, NULL };
+
+   considerIntersecting(from, p, v, characters.unbounded.begin(), characters.unbounded.end(), false, best);
+   considerIntersecting(from, p, v, obstacles.unbounded.begin(), obstacles.unbounded.end(), true, best);
+
+   Real const width = Real(colCount) * cellSize;
+   Real const height = Real(rowCount) * cellSize;
+   if (p[0] < 0 || p[1] < 0 || width <= p[0] || height <= p[1])
+   {
+      // Rays that start outside the grid are rare enough to not be worth
+      // walking, so just test everything.
+      for (size_t k = 0; k < colCount * rowCount; k++)
+      {
+         considerIntersectingCell(from, p, v, k, best);
+      }
+      considerIntersecting(from, p, v, characters.outside.begin(), characters.outside.end(), false, best);
+      considerIntersecting(from, p, v, obstacles.outside.begin(), obstacles.outside.end(), true, best);
+      return best.which;
+   }
+
+   long const cols = long(colCount);
+   long const rows = long(rowCount);
+   long c = long(col(p[0]));
+   long r = long(row(p[1]));
+
+   // Intersections just behind p count as hits, so start with the cells
+   // around p, not just the one it is in.
+   for (long j = max(r - 1, 0L); j <= min(r + 1, rows - 1); j++)
+   {
+      for (long i = max(c - 1, 0L); i <= min(c + 1, cols - 1); i++)
+      {
+         considerIntersectingCell(from, p, v, size_t(j * cols + i), best);
+      }
+   }
+
+   // Walk the cells along the ray.  Any intersection not yet found is in a
+   // cell further along the ray, so the walk can stop once the nearest found
+   // is closer than where the ray leaves the current cell.
+   long const stepC = 0 <= v[0] ? 1 : -1;
+   long const stepR = 0 <= v[1] ? 1 : -1;
+   Real const deltaC = 0 != v[0] ? cellSize/fabs(v[0]) : Inf;
+   Real const deltaR = 0 != v[1] ? cellSize/fabs(v[1]) : Inf;
+   Real exitC = 0 != v[0] ? (Real(0 < stepC ? c + 1 : c) * cellSize - p[0])/v[0] : Inf;
+   Real exitR = 0 != v[1] ? (Real(0 < stepR ? r + 1 : r) * cellSize - p[1])/v[1] : Inf;
+
+   while (true)
+   {
+      Real const exit = min(exitC, exitR);
+      if (best.which && best.distance < exit) { return best.which; }
+
+      if (exitC < exitR)
+      {
+         c += stepC;
+         exitC += deltaC;
+      }
+      else
+      {
+         r += stepR;
+         exitR += deltaR;
+      }
+
+      if (c < 0 || cols <= c || r < 0 || rows <= r || Inf == exit) { break; }
+
+      considerIntersectingCell(from, p, v, size_t(r * cols + c), best);
+   }
+
+   // The ray left the grid, but could still hit something that sticks out.
+   considerIntersecting(from, p, v, characters.outside.begin(), characters.outside.end(), false, best);
+   considerIntersecting(from, p, v, obstacles.outside.begin(), obstacles.outside.end(), true, best);
+
+   return best.which;
+}
+
+void SpatialGrid::considerIntersectingCell(Obstacle const& from, RealVec2 const& p, RealVec2 const& v,
+                                           size_t const k, Nearest& best) const
+{
+   considerIntersecting(from, p, v, characters.items.begin() + characters.start[k],
+                        characters.items.begin() + characters.start[k + 1], false, best);
+   considerIntersecting(from, p, v, obstacles.items.begin() + obstacles.start[k],
+                        obstacles.items.begin() + obstacles.start[k + 1], true, best);
+}
+
+void SpatialGrid::considerIntersecting(Obstacle const& from, RealVec2 const& p, RealVec2 const& v,
+                                       IndexIterator begin, IndexIterator end, bool const isObstacles,
+                                       Nearest& best) const
+{
+   for (IndexIterator i = begin; i != end; i++)
+   {
+      Obstacle* o = isObstacles ? obstacle(*i) : character(*i);
+      if (&from == o) { continue; }
+
+      RealVec2 q(o->nearestIntersection(p, v));
+      // Infinity is used to indicate no intersection.
+      if (!(q.length() < Inf)) { continue; }
+
+      size_t const order = isObstacles ? obstacleOrder[*i] : characterOrder[*i];
+      Real const d = q.relativeTo(p).length();
+      if (d < best.distance || (best.which && d == best.distance && order < best.order))
+      {
+         best.distance = d;
+         best.order = order;
+         best.which = o;
+      }
+   }
+}
+
+Obstacle* SpatialGrid::character(size_t const i) const
+{
+   return gs->getCharacterListBegin()[i].get();
+}
+
+Obstacle* SpatialGrid::obstacle(size_t const i) const
+{
+   return gs->getNonCharacterObstacleListBegin()[i].get();
+}
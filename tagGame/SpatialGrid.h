@@ -0,0 +1,169 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+
+#ifndef TG_SPATIAL_GRID_H
+#define TG_SPATIAL_GRID_H
+
+#include "Vec.h"
+
+namespace tagGame
+{
+   class GameState;
+   class Character;
+   class Obstacle;
+
+   /// A uniform grid over the game world that is used to quickly find the
+   /// characters and obstacles near some region, or some point or ray.
+   /// The grid only stores indices into the game-state's character and
+   /// non-character obstacle lists, so it has to be re-built whenever the
+   /// characters move (see GameState::getGrid).  Each object is stored in every
+   /// cell that its bounding box overlaps.  Obstacles without bounds (e.g.
+   /// sides) aren't stored in any cell and are instead returned by, or
+   /// tested in, every query.
+   class SpatialGrid
+   {
+   public:
+      SpatialGrid();
+
+      /// Re-build the grid from the current positions of everything in gs.
+      /// The grid refers to gs until it is next re-built or invalidated.
+      void build(GameState const& gs);
+
+      /// Mark the grid as out of date, e.g. because something was added.
+      inline void invalidate();
+      inline bool isValid() const;
+
+      /// Append the (sorted) indices of the characters whose bounding boxes
+      /// might overlap the box from lower to upper.
+      void queryCharacters(RealVec2 const& lower, RealVec2 const& upper, std::vector<size_t>& result) const;
+
+      /// Append the (sorted) indices of the non-character obstacles whose
+      /// bounding boxes might overlap the box from lower to upper.
+      void queryObstacles(RealVec2 const& lower, RealVec2 const& upper, std::vector<size_t>& result) const;
+
+      /// The character (other than from) that is the shortest distance
+      /// from from, or NULL if there are no other characters.
+      /// Ties are broken in favor of the first in the game-state's list, so
+      /// the result is the same as checking every character in turn.
+      Character* nearestCharacter(Obstacle const& from) const;
+
+      /// The obstacle (other than from and including characters) that is
+      /// the shortest distance from from, or NULL if there are none.
+      Obstacle* nearestObstacle(Obstacle const& from) const;
+
+      /// The obstacle (other than from and including characters) whose nearest
+      /// intersection with the ray from p in the (unit) direction v is closest
+      /// to p, or NULL if the ray doesn't hit anything.
+      Obstacle* nearestIntersecting(Obstacle const& from, RealVec2 const& p, RealVec2 const& v) const;
+
+      inline Real getCellSize() const;
+
+   protected:
+   private:
+      // The items in each cell stored contiguously, cell by cell.  The items
+      // in cell k are items[start[k]] to items[start[k + 1] - 1].
+      // Items whose bounding boxes stick out of the grid are also listed in
+      // outside, as they can be hit by a ray after it has left the grid.
+      struct CellLists
+      {
+         std::vector<size_t> start;
+         std::vector<size_t> items;
+         std::vector<size_t> unbounded;
+         std::vector<size_t> outside;
+      };
+
+      // The best candidate found so far by a nearest query.  Candidates are
+      // ordered by distance, then by their position in the obstacle list.
+      struct Nearest
+      {
+         Real distance;
+         size_t order;
+         Obstacle* which;
+      };
+
+      void insert(std::vector<RealVec2> const& lower, std::vector<RealVec2> const& upper,
+                  std::vector<bool> const& isBounded, CellLists& lists);
+      void query(CellLists const& lists, RealVec2 const& lower, RealVec2 const& upper, std::vector<size_t>& result) const;
+      typedef std::vector<size_t>::const_iterator IndexIterator;
+
+      Obstacle* nearest(Obstacle const& from, bool const isObstacles) const;
+      void considerNearestCell(Obstacle const& from, size_t const k, bool const isObstacles, Nearest& best) const;
+      void considerNearest(Obstacle const& from, size_t const k, bool const isObstacles, Nearest& best) const;
+      void considerIntersectingCell(Obstacle const& from, RealVec2 const& p, RealVec2 const& v,
+                                    size_t const k, Nearest& best) const;
+      void considerIntersecting(Obstacle const& from, RealVec2 const& p, RealVec2 const& v,
+                                IndexIterator begin, IndexIterator end, bool const isObstacles,
+                                Nearest& best) const;
+      Obstacle* character(size_t const i) const;
+      Obstacle* obstacle(size_t const i) const;
+      inline size_t col(Real const x) const;
+      inline size_t row(Real const y) const;
+
+      GameState const* gs;
+
+      Real cellSize;
+      size_t colCount;
+      size_t rowCount;
+
+      CellLists characters;
+      CellLists obstacles;
+
+      // The position of each character and non-character obstacle in the
+      // game-state's list of all obstacles.
+      std::vector<size_t> characterOrder;
+      std::vector<size_t> obstacleOrder;
+
+      // Scratch space re-used between builds to avoid re-allocating.
+      std::vector<RealVec2> lower;
+      std::vector<RealVec2> upper;
+      std::vector<bool> isBounded;
+      std::vector<size_t> cursor;
+   };
+
+   void SpatialGrid::invalidate()
+   {
+      gs = NULL;
+   }
+
+   bool SpatialGrid::isValid() const
+   {
+      return NULL != gs;
+   }
+
+   Real SpatialGrid::getCellSize() const
+   {
+      return cellSize;
+   }
+
+   size_t SpatialGrid::col(Real const x) const
+   {
+      // Anything outside the world is put in the nearest cell.
+      if (x <= 0) { return 0; }
+      if (Real(colCount) * cellSize <= x) { return colCount - 1; }
+      return size_t(x / cellSize);
+   }
+
+   size_t SpatialGrid::row(Real const y) const
+   {
+      if (y <= 0) { return 0; }
+      if (Real(rowCount) * cellSize <= y) { return rowCount - 1; }
+      return size_t(y / cellSize);
+   }
+}
+
+#endif
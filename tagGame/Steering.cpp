@@ -0,0 +1,129 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#include "Steering.h"
+#include "Util2D.h"
+
+#include <cmath>
+
+#if !defined(TG_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && 2 <= _M_IX86_FP))
+#define TG_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace tagGame;
+
+using namespace std;
+
+void Steering::wander(Random& random, RealVec2& direction, Real& speed)
+{
+   direction = Util2D::dir(random.uniform01() * Real(360) - Real(180));
+   // Speed is clamped to at least 0.25 because slow movement is boring!
+   speed = MathUtil::clamp(random.uniform01(), 0.25, 1);
+}
+
+void Steering::evade(vector<RealVec2> const& positions, vector<RealVec2> const& targets,
+                     vector<RealVec2>& directions, vector<Real>& speeds)
+{
+   TG_ASSERT(positions.size() == targets.size());
+
+   directions.resize(positions.size(), RealVec2(Util2D::dim));
+   speeds.resize(positions.size());
+   if (positions.empty()) { return; }
+   seek(&positions[0], &targets[0], 1, positions.size(), true, &directions[0], &speeds[0]);
+}
+
+void Steering::evade(vector<RealVec2> const& positions, RealVec2 const& target,
+                     vector<RealVec2>& directions, vector<Real>& speeds)
+{
+   directions.resize(positions.size(), RealVec2(Util2D::dim));
+   speeds.resize(positions.size());
+   if (positions.empty()) { return; }
+   seek(&positions[0], &target, 0, positions.size(), true, &directions[0], &speeds[0]);
+}
+
+void Steering::pursue(vector<RealVec2> const& positions, vector<RealVec2> const& targets,
+                      vector<RealVec2>& directions, vector<Real>& speeds)
+{
+   TG_ASSERT(positions.size() == targets.size());
+
+   directions.resize(positions.size(), RealVec2(Util2D::dim));
+   speeds.resize(positions.size());
+   if (positions.empty()) { return; }
+   seek(&positions[0], &targets[0], 1, positions.size(), false, &directions[0], &speeds[0]);
+}
+
+void Steering::pursue(vector<RealVec2> const& positions, RealVec2 const& target,
+                      vector<RealVec2>& directions, vector<Real>& speeds)
+{
+   directions.resize(positions.size(), RealVec2(Util2D::dim));
+   speeds.resize(positions.size());
+   if (positions.empty()) { return; }
+   seek(&positions[0], &target, 0, positions.size(), false, &directions[0], &speeds[0]);
+}
+
+void Steering::wander(vector<Random>& randoms, vector<RealVec2>& directions, vector<Real>& speeds)
+{
+   directions.resize(randoms.size(), RealVec2(Util2D::dim));
+   speeds.resize(randoms.size());
+
+   for (size_t i = 0; i < randoms.size(); i++)
+   {
+      wander(randoms[i], directions[i], speeds[i]);
+   }
+}
+
+void Steering::seek(RealVec2 const* positions, RealVec2 const* targets, size_t const targetStep, size_t const n,
+                    bool const isAway, RealVec2* directions, Real* speeds)
+{
+   // This code assumes 2D.
+   TG_ASSERT(2 == Util2D::dim);
+
+   size_t i = 0;
+#if defined(TG_USE_SSE2)
+   // Two characters at a time, with their x and y coordinates split into
+   // separate registers.  The same arithmetic as normalize.
+   __m128d const eps = _mm_set1_pd(Eps);
+   __m128d const one = _mm_set1_pd(1);
+   for (; i + 2 <= n; i += 2)
+   {
+      __m128d const p0 = _mm_loadu_pd(&positions[i][0]);
+      __m128d const p1 = _mm_loadu_pd(&positions[i + 1][0]);
+      __m128d const t0 = _mm_loadu_pd(&targets[i * targetStep][0]);
+      __m128d const t1 = _mm_loadu_pd(&targets[(i + 1) * targetStep][0]);
+      __m128d const v0 = isAway ? _mm_sub_pd(p0, t0) : _mm_sub_pd(t0, p0);
+      __m128d const v1 = isAway ? _mm_sub_pd(p1, t1) : _mm_sub_pd(t1, p1);
+      __m128d const x = _mm_unpacklo_pd(v0, v1);
+      __m128d const y = _mm_unpackhi_pd(v0, v1);
+
+      __m128d const length = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(x, x), _mm_mul_pd(y, y)));
+      // The length can't be negative, so there's no need for the fabs.
+      __m128d const scale = _mm_andnot_pd(_mm_cmple_pd(length, eps), _mm_div_pd(one, length));
+      __m128d const dx = _mm_mul_pd(x, scale);
+      __m128d const dy = _mm_mul_pd(y, scale);
+
+      _mm_storeu_pd(&directions[i][0], _mm_unpacklo_pd(dx, dy));
+      _mm_storeu_pd(&directions[i + 1][0], _mm_unpackhi_pd(dx, dy));
+      _mm_storeu_pd(speeds + i, one);
+   }
+#endif
+   for (; i < n; i++)
+   {
+      directions[i] = isAway ? evade(positions[i], targets[i * targetStep]) : pursue(positions[i], targets[i * targetStep]);
+      speeds[i] = 1;
+   }
+}
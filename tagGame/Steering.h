@@ -0,0 +1,76 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_STEERING_H
+#define TG_STEERING_H
+
+#include "Vec.h"
+#include "Random.h"
+
+namespace tagGame
+{
+   /// The steering used by the evade, pursue and wander controllers, for
+   /// one character at a time, or batched for many characters at once.  The
+   /// batched versions of evade and pursue use SIMD instructions if the
+   /// compiler targets SSE2 (see Integrator.h).  All versions give identical
+   /// results.
+   class Steering
+   {
+   public:
+      /// The direction away from target, at full speed (see ControllerEvade).
+      /// The direction is 0 if position and target are (almost) the same.
+      inline static RealVec2 evade(RealVec2 const& position, RealVec2 const& target);
+      /// The direction towards target, at full speed (see ControllerPursue).
+      inline static RealVec2 pursue(RealVec2 const& position, RealVec2 const& target);
+      /// A random direction and speed drawn from random (see ControllerWander).
+      static void wander(Random& random, RealVec2& direction, Real& speed);
+
+      /// For each i, the direction from positions[i] away from (or towards)
+      /// targets[i], or a single target, and its speed.
+      static void evade(std::vector<RealVec2> const& positions, std::vector<RealVec2> const& targets,
+                        std::vector<RealVec2>& directions, std::vector<Real>& speeds);
+      static void evade(std::vector<RealVec2> const& positions, RealVec2 const& target,
+                        std::vector<RealVec2>& directions, std::vector<Real>& speeds);
+      static void pursue(std::vector<RealVec2> const& positions, std::vector<RealVec2> const& targets,
+                         std::vector<RealVec2>& directions, std::vector<Real>& speeds);
+      static void pursue(std::vector<RealVec2> const& positions, RealVec2 const& target,
+                         std::vector<RealVec2>& directions, std::vector<Real>& speeds);
+
+      /// For each i, a random direction and speed drawn from randoms[i].
+      static void wander(std::vector<Random>& randoms, std::vector<RealVec2>& directions, std::vector<Real>& speeds);
+
+   private:
+      // The batched versions of evade and pursue.  The targets are targets[0]
+      // up to targets[(n - 1) * targetStep].
+      static void seek(RealVec2 const* positions, RealVec2 const* targets, size_t const targetStep, size_t const n,
+                       bool const isAway, RealVec2* directions, Real* speeds);
+   };
+
+   RealVec2 Steering::evade(RealVec2 const& position, RealVec2 const& target)
+   {
+      RealVec2 v(position.relativeTo(target));
+      return v.normalize();
+   }
+
+   RealVec2 Steering::pursue(RealVec2 const& position, RealVec2 const& target)
+   {
+      RealVec2 v(target.relativeTo(position));
+      return v.normalize();
+   }
+}
+
+#endif
@@ -0,0 +1,325 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#include "Telemetry.h"
+#include "GameState.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+using namespace tagGame;
+
+using namespace std;
+
+char const Telemetry::magic[8] = { 't', 'a', 'g', 'G', 'a', 'm', 'e', 'T' };
+
+Telemetry::Telemetry(string const& fileName, Real const resolution, size_t const chunkSize) :
+   file(NULL),
+   fileName(fileName),
+   resolution(resolution),
+   chunkSize(chunkSize),
+   frameCount(0),
+   current(NULL)
+{
+   TG_ASSERT(0 < resolution && 0 < chunkSize);
+
+   file = fopen(fileName.c_str(), "wb");
+   if (!file) { Util::error("Telemetry: can't open " + fileName); }
+
+   Header header;
+   memset(&header, 0, sizeof(header));
+   memcpy(header.magic, magic, sizeof(magic));
+   header.version = version;
+   header.realSize = sizeof(Real);
+   header.resolution = resolution;
+   write(&header, sizeof(header));
+
+   // One being filled, one being written, and a couple to spare in case
+   // the writer is slow for a while.
+   chunks.resize(4);
+   for (size_t i = 0; i < chunks.size(); i++)
+   {
+      spare.push_back(&chunks[i]);
+   }
+
+#if defined(TG_USE_PTHREADS)
+   isClosing = false;
+   pthread_mutex_init(&mutex, NULL);
+   pthread_cond_init(&ready, NULL);
+   pthread_cond_init(&written, NULL);
+   if (0 != pthread_create(&thread, NULL, threadMain, this))
+   {
+      Util::error("Telemetry: unable to create thread");
+   }
+#endif
+}
+
+Telemetry::~Telemetry()
+{
+   close();
+}
+
+void Telemetry::close()
+{
+   if (!file) { return; }
+
+   if (current) { finishChunk(); }
+
+#if defined(TG_USE_PTHREADS)
+   pthread_mutex_lock(&mutex);
+   isClosing = true;
+   pthread_cond_signal(&ready);
+   pthread_mutex_unlock(&mutex);
+
+   pthread_join(thread, NULL);
+
+   pthread_cond_destroy(&written);
+   pthread_cond_destroy(&ready);
+   pthread_mutex_destroy(&mutex);
+#endif
+
+   if (0 != fclose(file)) { Util::error("Telemetry: can't write " + fileName); }
+   file = NULL;
+}
+
+void Telemetry::addFrame(GameState const& gs, vector<Narrowphase::Pair> const& contacts)
+{
+   TG_ASSERT_MSG(file, "Telemetry: can't add frames after close");
+
+   EntityStore const& store(gs.getCharacterStore());
+   size_t const characterCount = store.size();
+
+   // A chunk has the same characters all the way through.
+   if (current && current->characterCount != characterCount) { finishChunk(); }
+
+   if (!current)
+   {
+#if defined(TG_USE_PTHREADS)
+      pthread_mutex_lock(&mutex);
+      while (spare.empty())
+      {
+         pthread_cond_wait(&written, &mutex);
+      }
+#endif
+      current = spare.back();
+      spare.pop_back();
+#if defined(TG_USE_PTHREADS)
+      pthread_mutex_unlock(&mutex);
+#endif
+
+      // Clearing keeps the memory from last time.
+      current->frameCount = 0;
+      current->characterCount = characterCount;
+      current->frames.clear();
+      current->times.clear();
+      current->positions.clear();
+      current->orientations.clear();
+      current->speeds.clear();
+      current->tagTimes.clear();
+      current->contacts.clear();
+      current->contactEnds.clear();
+   }
+
+   current->frames.push_back(gs.getFrame());
+   current->times.push_back(gs.getTime());
+   current->positions.insert(current->positions.end(), store.getPositions().begin(), store.getPositions().end());
+   // Velocities are worked out by the writer.
+   current->orientations.insert(current->orientations.end(), store.getOrientations().begin(), store.getOrientations().end());
+   current->speeds.insert(current->speeds.end(), store.getSpeeds().begin(), store.getSpeeds().end());
+   current->tagTimes.insert(current->tagTimes.end(), store.getTagTimes().begin(), store.getTagTimes().end());
+   current->contacts.insert(current->contacts.end(), contacts.begin(), contacts.end());
+   current->contactEnds.push_back(current->contacts.size());
+
+   current->frameCount++;
+   frameCount++;
+   if (chunkSize == current->frameCount) { finishChunk(); }
+}
+
+void Telemetry::finishChunk()
+{
+#if defined(TG_USE_PTHREADS)
+   pthread_mutex_lock(&mutex);
+   full.push_back(current);
+   pthread_cond_signal(&ready);
+   pthread_mutex_unlock(&mutex);
+#else
+   writeChunk(*current);
+   spare.push_back(current);
+#endif
+   current = NULL;
+}
+
+#if defined(TG_USE_PTHREADS)
+void* Telemetry::threadMain(void* telemetry)
+{
+   Telemetry& t(*static_cast<Telemetry*>(telemetry));
+
+   pthread_mutex_lock(&t.mutex);
+   while (true)
+   {
+      while (t.full.empty() && !t.isClosing)
+      {
+         pthread_cond_wait(&t.ready, &t.mutex);
+      }
+      // Everything is written before closing.
+      if (t.full.empty()) { break; }
+      Chunk* const chunk = t.full.front();
+      t.full.erase(t.full.begin());
+      pthread_mutex_unlock(&t.mutex);
+
+      t.writeChunk(*chunk);
+
+      pthread_mutex_lock(&t.mutex);
+      t.spare.push_back(chunk);
+      pthread_cond_signal(&t.written);
+   }
+   pthread_mutex_unlock(&t.mutex);
+
+   return NULL;
+}
+#endif
+
+void Telemetry::writeChunk(Chunk const& chunk)
+{
+   size_t const n = chunk.characterCount;
+   size_t const frames = chunk.frameCount;
+
+   for (size_t k = 0; k < columnCount; k++)
+   {
+      columns[k].clear();
+   }
+
+   int previous = chunk.frames[0];
+   for (size_t f = 0; f < frames; f++)
+   {
+      putVarint(zigzag(chunk.frames[f] - previous), columns[frameColumn]);
+      previous = chunk.frames[f];
+   }
+
+   unsigned char const* const times = reinterpret_cast<unsigned char const*>(&chunk.times[0]);
+   columns[timeColumn].assign(times, times + frames * sizeof(Real));
+
+   putDeltas(chunk.positions, 0, chunk, columns[positionXColumn]);
+   putDeltas(chunk.positions, 1, chunk, columns[positionYColumn]);
+   // The same as EntityStore::getVelocity.
+   velocities.resize(chunk.orientations.size(), RealVec2(Util2D::dim));
+   for (size_t k = 0; k < velocities.size(); k++)
+   {
+      velocities[k] = chunk.orientations[k];
+      velocities[k].scale(chunk.speeds[k]);
+   }
+   putDeltas(velocities, 0, chunk, columns[velocityXColumn]);
+   putDeltas(velocities, 1, chunk, columns[velocityYColumn]);
+
+   for (size_t i = 0; i < n; i++)
+   {
+      int last = 0;
+      for (size_t f = 0; f < frames; f++)
+      {
+         int const tagTime = chunk.tagTimes[f * n + i];
+         putVarint(zigzag(tagTime - last), columns[tagTimeColumn]);
+         last = tagTime;
+      }
+   }
+
+   // Most pairs stay touching for many frames, so each frame only stores
+   // the pairs that started and stopped touching since the frame before
+   // (the first frame of a chunk stores them all).
+   previousKeys.clear();
+   size_t begin = 0;
+   for (size_t f = 0; f < frames; f++)
+   {
+      size_t const end = chunk.contactEnds[f];
+      keys.clear();
+      for (size_t k = begin; k < end; k++)
+      {
+         keys.push_back(getKey(chunk.contacts[k]));
+      }
+      sort(keys.begin(), keys.end());
+      begin = end;
+
+      changedKeys.clear();
+      set_difference(previousKeys.begin(), previousKeys.end(), keys.begin(), keys.end(), back_inserter(changedKeys));
+      putKeys(changedKeys, columns[contactColumn]);
+      changedKeys.clear();
+      set_difference(keys.begin(), keys.end(), previousKeys.begin(), previousKeys.end(), back_inserter(changedKeys));
+      putKeys(changedKeys, columns[contactColumn]);
+
+      previousKeys.swap(keys);
+   }
+
+   chunkHeader.clear();
+   putVarint(zigzag(chunk.frames[0]), chunkHeader);
+   putVarint(frames, chunkHeader);
+   putVarint(n, chunkHeader);
+   unsigned long long size = 0;
+   for (size_t k = 0; k < columnCount; k++)
+   {
+      putVarint(columns[k].size(), chunkHeader);
+      size += columns[k].size();
+   }
+   size += chunkHeader.size();
+
+   write(&size, sizeof(size));
+   write(&chunkHeader[0], chunkHeader.size());
+   for (size_t k = 0; k < columnCount; k++)
+   {
+      if (!columns[k].empty()) { write(&columns[k][0], columns[k].size()); }
+   }
+}
+
+void Telemetry::putDeltas(vector<RealVec2> const& values, size_t const k, Chunk const& chunk, vector<unsigned char>& out) const
+{
+   size_t const n = chunk.characterCount;
+
+   for (size_t i = 0; i < n; i++)
+   {
+      long long last = 0;
+      for (size_t f = 0; f < chunk.frameCount; f++)
+      {
+         long long const q = (long long)floor(values[f * n + i][k] / resolution + Real(0.5));
+         putVarint(zigzag(q - last), out);
+         last = q;
+      }
+   }
+}
+
+void Telemetry::putKeys(vector<unsigned long long> const& keys, vector<unsigned char>& out)
+{
+   putVarint(keys.size(), out);
+
+   // The keys are in order, so the first characters are stored as the
+   // difference from the one before, and so are the second characters of
+   // pairs with the same first character.
+   unsigned long long lastI = 0;
+   unsigned long long lastJ = 0;
+   for (vector<unsigned long long>::const_iterator k = keys.begin(); k != keys.end(); k++)
+   {
+      unsigned long long const i = *k >> 32;
+      unsigned long long const j = *k & 0xffffffffULL;
+      putVarint(i - lastI, out);
+      putVarint(i == lastI && k != keys.begin() ? j - lastJ : j, out);
+      lastI = i;
+      lastJ = j;
+   }
+}
+
+void Telemetry::write(void const* p, size_t const n)
+{
+   if (1 != fwrite(p, n, 1, file)) { Util::error("Telemetry: can't write " + fileName); }
+}
@@ -0,0 +1,237 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_TELEMETRY_H
+#define TG_TELEMETRY_H
+
+#include "Narrowphase.h"
+#include "Util2D.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if !defined(TG_NO_THREADS) && !defined(_WIN32)
+#define TG_USE_PTHREADS 1
+#include <pthread.h>
+#endif
+
+namespace tagGame
+{
+   class GameState;
+
+   /// Streams the state of the world at every frame to a file, for
+   /// analysing offline (see TelemetryReader): each character's position,
+   /// velocity and tag time, and the pairs of objects that were touching
+   /// when the frame's collisions were resolved.
+   ///
+   /// Frames are gathered into chunks of chunkSize frames, and each chunk is
+   /// stored a column at a time (e.g. all the characters' x positions, then
+   /// all their y positions), with each character's values over the chunk
+   /// together.  Positions and velocities are rounded to a multiple of
+   /// resolution, and every value is stored as the difference from the one
+   /// before it, in a variable number of bytes, so that values that change
+   /// by little from one frame to the next take only a byte or two.
+   /// Touching pairs are stored as the pairs that started and stopped
+   /// touching since the frame before.  A chunk can be decoded on its own.
+   ///
+   /// All addFrame does is copy the columns into the current chunk.  Full
+   /// chunks are encoded and written on a thread of their own, so that the
+   /// simulation hardly slows down (where there are no threads, they are
+   /// written straight away).  If the writer falls more than a few chunks
+   /// behind, addFrame waits for it.
+   ///
+   /// Frames are added by the simulator (see Simulator::setTelemetry), one
+   /// for each call to forward.
+   class Telemetry
+   {
+   public:
+      Telemetry(std::string const& fileName, Real const resolution = Real(1)/Real(1024), size_t const chunkSize = 256);
+      /// Closes the file, if it hasn't been already.
+      ~Telemetry();
+
+      /// Writes out what's left and finishes the file.  Nothing more can be
+      /// added after this.
+      void close();
+
+      /// Called by the simulator at the end of each step.
+      void addFrame(GameState const& gs, std::vector<Narrowphase::Pair> const& contacts);
+
+      inline size_t getFrameCount() const;
+
+      /// The file starts with a header, followed by the chunks.  Each chunk
+      /// starts with its size in bytes (so that it can be skipped), then its
+      /// first frame number, frame count, character count, and the size of
+      /// each column in bytes, then the columns in the order below.  Other
+      /// than the header, the chunk sizes and the times, everything is a
+      /// variable length integer (see putVarint), in the order the
+      /// frames were added.
+      enum Column
+      {
+         frameColumn,     ///< Frame numbers.
+         timeColumn,      ///< Game times, as Reals.
+         positionXColumn, ///< For each character, over the chunk.
+         positionYColumn,
+         velocityXColumn,
+         velocityYColumn,
+         tagTimeColumn,
+         contactColumn,   ///< For each frame, the pairs that stopped touching, then the ones that started (see getKey).
+         columnCount
+      };
+
+      struct Header
+      {
+         char magic[8];
+         unsigned version;
+         unsigned realSize;
+         double resolution;
+      };
+
+      static char const magic[8];
+      static unsigned const version = 1;
+
+      /// Integers are stored 7 bits to a byte, least significant first,
+      /// with the top bit set on every byte but the last.  Signed integers
+      /// are zig-zag encoded first, so that small negative numbers are small
+      /// too.  Reading one that runs up to end, or is too long, is an error.
+      inline static void putVarint(unsigned long long x, std::vector<unsigned char>& out);
+      inline static unsigned long long getVarint(unsigned char const*& p, unsigned char const* const end);
+      inline static unsigned long long zigzag(long long const x);
+      inline static long long unzigzag(unsigned long long const x);
+
+      /// Contacts are stored as keys that sort them by their first
+      /// character, then their second character or obstacle.  A list of
+      /// keys is stored as its length followed by the keys in order (see
+      /// putKeys).
+      inline static unsigned long long getKey(Narrowphase::Pair const& contact);
+      inline static Narrowphase::Pair getContact(unsigned long long const key);
+   protected:
+   private:
+      // Not copyable.
+      Telemetry(Telemetry const&);
+      Telemetry& operator=(Telemetry const&);
+
+      // The frames of a chunk as they were added.
+      struct Chunk
+      {
+         size_t frameCount;
+         size_t characterCount;
+         std::vector<int> frames;
+         std::vector<Real> times;
+         // For each frame, for each character.
+         std::vector<RealVec2> positions;
+         std::vector<RealVec2> orientations;
+         std::vector<Real> speeds;
+         std::vector<int> tagTimes;
+         // The contacts, and where each frame's end.
+         std::vector<Narrowphase::Pair> contacts;
+         std::vector<size_t> contactEnds;
+      };
+
+      void finishChunk();
+      void writeChunk(Chunk const& chunk);
+      static void putKeys(std::vector<unsigned long long> const& keys, std::vector<unsigned char>& out);
+      void putDeltas(std::vector<RealVec2> const& values, size_t const k, Chunk const& chunk, std::vector<unsigned char>& out) const;
+      void write(void const* p, size_t const n);
+
+      std::FILE* file;
+      std::string fileName;
+      Real resolution;
+      size_t chunkSize;
+      size_t frameCount;
+
+      // Chunks being filled, waiting to be written, and ready for re-use.
+      // Only a few are ever allocated.
+      std::vector<Chunk> chunks;
+      Chunk* current;
+      std::vector<Chunk*> full;
+      std::vector<Chunk*> spare;
+
+      // Used by the writer.
+      std::vector<unsigned char> columns[columnCount];
+      std::vector<unsigned char> chunkHeader;
+      std::vector<RealVec2> velocities;
+      std::vector<unsigned long long> keys;
+      std::vector<unsigned long long> previousKeys;
+      std::vector<unsigned long long> changedKeys;
+
+#if defined(TG_USE_PTHREADS)
+      static void* threadMain(void* telemetry);
+
+      pthread_t thread;
+      pthread_mutex_t mutex;
+      // Signalled when a chunk is full (or the file is being closed).
+      pthread_cond_t ready;
+      // Signalled when a chunk has been written.
+      pthread_cond_t written;
+      bool isClosing;
+#endif
+   };
+
+   size_t Telemetry::getFrameCount() const
+   {
+      return frameCount;
+   }
+
+   void Telemetry::putVarint(unsigned long long x, std::vector<unsigned char>& out)
+   {
+      while (0x80 <= x)
+      {
+         out.push_back((unsigned char)(x | 0x80));
+         x >>= 7;
+      }
+      out.push_back((unsigned char)x);
+   }
+
+   unsigned long long Telemetry::getVarint(unsigned char const*& p, unsigned char const* const end)
+   {
+      unsigned long long x = 0;
+      for (int shift = 0; ; shift += 7)
+      {
+         if (end <= p || 64 <= shift) { Util::error("Telemetry: corrupt variable length integer"); }
+         unsigned char const b = *p++;
+         x |= (unsigned long long)(b & 0x7f) << shift;
+         if (!(b & 0x80)) { return x; }
+      }
+   }
+
+   unsigned long long Telemetry::zigzag(long long const x)
+   {
+      return ((unsigned long long)x << 1) ^ (unsigned long long)(x >> 63);
+   }
+
+   long long Telemetry::unzigzag(unsigned long long const x)
+   {
+      return (long long)(x >> 1) ^ -(long long)(x & 1);
+   }
+
+   unsigned long long Telemetry::getKey(Narrowphase::Pair const& contact)
+   {
+      return (unsigned long long)contact.i << 32 | (unsigned long long)contact.j << 1 | (contact.isObstacle ? 1 : 0);
+   }
+
+   Narrowphase::Pair Telemetry::getContact(unsigned long long const key)
+   {
+      Narrowphase::Pair contact;
+      contact.i = size_t(key >> 32);
+      contact.j = size_t((key & 0xffffffffULL) >> 1);
+      contact.isObstacle = 0 != (key & 1);
+      return contact;
+   }
+}
+
+#endif
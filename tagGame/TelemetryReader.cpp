@@ -0,0 +1,210 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#include "TelemetryReader.h"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace tagGame;
+
+using namespace std;
+
+TelemetryReader::TelemetryReader(string const& fileName) :
+   file(NULL),
+   fileName(fileName),
+   frameCount(0),
+   characterCount(0)
+{
+   file = fopen(fileName.c_str(), "rb");
+   if (!file) { Util::error("TelemetryReader: can't open " + fileName); }
+
+   if (1 != fread(&header, sizeof(header), 1, file) ||
+       0 != memcmp(header.magic, Telemetry::magic, sizeof(header.magic)) || Telemetry::version != header.version)
+   {
+      Util::error("TelemetryReader: " + fileName + " isn't a telemetry file");
+   }
+   if (sizeof(Real) != header.realSize)
+   {
+      Util::error("TelemetryReader: " + fileName + " was written by a different build");
+   }
+}
+
+TelemetryReader::~TelemetryReader()
+{
+   fclose(file);
+}
+
+bool TelemetryReader::nextChunk()
+{
+   frameCount = 0;
+   characterCount = 0;
+
+   unsigned long long size;
+   if (1 != fread(&size, sizeof(size), 1, file)) { return false; }
+   // A chunk's header alone takes a byte for each number, and the chunk
+   // has to be in the file before anything is allocated for it.
+   if (size < 3 + Telemetry::columnCount) { corrupt(); }
+   long const start = ftell(file);
+   fseek(file, 0, SEEK_END);
+   long const fileSize = ftell(file);
+   fseek(file, start, SEEK_SET);
+   if (start < 0 || fileSize < start || (unsigned long long)(fileSize - start) < size)
+   {
+      Util::error("TelemetryReader: " + fileName + " is incomplete");
+   }
+   bytes.resize(size_t(size));
+   if (1 != fread(&bytes[0], bytes.size(), 1, file))
+   {
+      Util::error("TelemetryReader: " + fileName + " is incomplete");
+   }
+
+   // Nothing is trusted until it has been checked against the chunk's size.
+   unsigned char const* p = &bytes[0];
+   unsigned char const* const end = p + bytes.size();
+   int const firstFrame = int(Telemetry::unzigzag(Telemetry::getVarint(p, end)));
+   unsigned long long const frameCountIn = Telemetry::getVarint(p, end);
+   unsigned long long const characterCountIn = Telemetry::getVarint(p, end);
+   unsigned long long columnSizes[Telemetry::columnCount];
+   for (size_t k = 0; k < Telemetry::columnCount; k++)
+   {
+      columnSizes[k] = Telemetry::getVarint(p, end);
+   }
+   // The columns follow the chunk's header, and fill the rest of it.
+   unsigned char const* columns[Telemetry::columnCount + 1];
+   for (size_t k = 0; k < Telemetry::columnCount; k++)
+   {
+      if (size_t(end - p) < columnSizes[k]) { corrupt(); }
+      columns[k] = p;
+      p += size_t(columnSizes[k]);
+   }
+   if (end != p) { corrupt(); }
+   columns[Telemetry::columnCount] = end;
+
+   // Every value takes at least a byte, each frame's contacts at least two
+   // (the counts of removed and added keys), and the times exactly a Real.
+   if (0 == frameCountIn || columnSizes[Telemetry::frameColumn] < frameCountIn ||
+       columnSizes[Telemetry::contactColumn] / 2 < frameCountIn ||
+       columnSizes[Telemetry::timeColumn] != frameCountIn * sizeof(Real))
+   {
+      corrupt();
+   }
+   for (size_t k = Telemetry::positionXColumn; k <= Telemetry::tagTimeColumn; k++)
+   {
+      if (columnSizes[k] / frameCountIn < characterCountIn) { corrupt(); }
+   }
+   frameCount = size_t(frameCountIn);
+   characterCount = size_t(characterCountIn);
+
+   frames.resize(frameCount);
+   p = columns[Telemetry::frameColumn];
+   int previous = firstFrame;
+   for (size_t f = 0; f < frameCount; f++)
+   {
+      frames[f] = previous + int(Telemetry::unzigzag(Telemetry::getVarint(p, columns[Telemetry::frameColumn + 1])));
+      previous = frames[f];
+   }
+
+   times.resize(frameCount);
+   if (0 < frameCount) { memcpy(&times[0], columns[Telemetry::timeColumn], frameCount * sizeof(Real)); }
+
+   getDeltas(columns[Telemetry::positionXColumn], columns[Telemetry::positionXColumn + 1], 0, positions);
+   getDeltas(columns[Telemetry::positionYColumn], columns[Telemetry::positionYColumn + 1], 1, positions);
+   getDeltas(columns[Telemetry::velocityXColumn], columns[Telemetry::velocityXColumn + 1], 0, velocities);
+   getDeltas(columns[Telemetry::velocityYColumn], columns[Telemetry::velocityYColumn + 1], 1, velocities);
+
+   tagTimes.resize(frameCount * characterCount);
+   p = columns[Telemetry::tagTimeColumn];
+   for (size_t i = 0; i < characterCount; i++)
+   {
+      int last = 0;
+      for (size_t f = 0; f < frameCount; f++)
+      {
+         last += int(Telemetry::unzigzag(Telemetry::getVarint(p, columns[Telemetry::tagTimeColumn + 1])));
+         tagTimes[f * characterCount + i] = last;
+      }
+   }
+
+   contacts.clear();
+   contactStarts.assign(1, 0);
+   keys.clear();
+   p = columns[Telemetry::contactColumn];
+   for (size_t f = 0; f < frameCount; f++)
+   {
+      getKeys(p, columns[Telemetry::contactColumn + 1], removedKeys);
+      getKeys(p, columns[Telemetry::contactColumn + 1], addedKeys);
+
+      previousKeys.swap(keys);
+      keys.clear();
+      set_difference(previousKeys.begin(), previousKeys.end(), removedKeys.begin(), removedKeys.end(), back_inserter(keys));
+      size_t const middle = keys.size();
+      keys.insert(keys.end(), addedKeys.begin(), addedKeys.end());
+      inplace_merge(keys.begin(), keys.begin() + middle, keys.end());
+
+      for (vector<unsigned long long>::const_iterator k = keys.begin(); k != keys.end(); k++)
+      {
+         contacts.push_back(Telemetry::getContact(*k));
+      }
+      contactStarts.push_back(contacts.size());
+   }
+
+   return true;
+}
+
+void TelemetryReader::getKeys(unsigned char const*& p, unsigned char const* const end, vector<unsigned long long>& keys) const
+{
+   // Each key takes at least two bytes.
+   unsigned long long const n = Telemetry::getVarint(p, end);
+   if (size_t(end - p) / 2 < n) { corrupt(); }
+   keys.resize(size_t(n));
+
+   unsigned long long i = 0;
+   unsigned long long j = 0;
+   for (size_t k = 0; k < keys.size(); k++)
+   {
+      unsigned long long const di = Telemetry::getVarint(p, end);
+      unsigned long long const dj = Telemetry::getVarint(p, end);
+      if (0xffffffffULL < di || 0xffffffffULL < dj) { corrupt(); }
+      j = 0 == di && 0 < k ? j + dj : dj;
+      i += di;
+      // The first of each pair is a character, and so is the second unless
+      // it's an obstacle.
+      if (characterCount <= i || 0xffffffffULL < j || (!(j & 1) && characterCount <= j >> 1)) { corrupt(); }
+      keys[k] = i << 32 | j;
+   }
+}
+
+void TelemetryReader::getDeltas(unsigned char const* p, unsigned char const* const end, size_t const k, vector<RealVec2>& values) const
+{
+   values.resize(frameCount * characterCount, RealVec2(Util2D::dim));
+   Real const resolution = getResolution();
+
+   for (size_t i = 0; i < characterCount; i++)
+   {
+      long long last = 0;
+      for (size_t f = 0; f < frameCount; f++)
+      {
+         last += Telemetry::unzigzag(Telemetry::getVarint(p, end));
+         values[f * characterCount + i][k] = Real(last) * resolution;
+      }
+   }
+}
+
+void TelemetryReader::corrupt() const
+{
+   Util::error("TelemetryReader: " + fileName + " has a corrupt chunk");
+}
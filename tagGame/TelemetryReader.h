@@ -0,0 +1,147 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_TELEMETRY_READER_H
+#define TG_TELEMETRY_READER_H
+
+#include "Telemetry.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace tagGame
+{
+   /// Reads back a file written by Telemetry, a chunk at a time, so that
+   /// files of any length can be analysed in a fixed amount of memory.
+   /// Positions and velocities come back rounded to the file's resolution.
+   class TelemetryReader
+   {
+   public:
+      explicit TelemetryReader(std::string const& fileName);
+      ~TelemetryReader();
+
+      inline Real getResolution() const;
+
+      /// Reads and decodes the next chunk.  False at the end of the file.
+      bool nextChunk();
+
+      /// The current chunk.  Frames are numbered from 0 within the chunk.
+      inline size_t getFrameCount() const;
+      inline size_t getCharacterCount() const;
+      inline int getFrame(size_t const frame) const;
+      inline Real getTime(size_t const frame) const;
+      inline RealVec2 const& getPosition(size_t const frame, size_t const id) const;
+      inline RealVec2 const& getVelocity(size_t const frame, size_t const id) const;
+      inline int getTagTime(size_t const frame, size_t const id) const;
+
+      /// The pairs that were touching in a frame, in order of their first
+      /// character, then the second.  The second of each is a character, or
+      /// a non-character obstacle if isObstacle is true.
+      inline Narrowphase::Pair const* getContactsBegin(size_t const frame) const;
+      inline Narrowphase::Pair const* getContactsEnd(size_t const frame) const;
+   protected:
+   private:
+      // Not copyable.
+      TelemetryReader(TelemetryReader const&);
+      TelemetryReader& operator=(TelemetryReader const&);
+
+      void getKeys(unsigned char const*& p, unsigned char const* const end, std::vector<unsigned long long>& keys) const;
+      void getDeltas(unsigned char const* p, unsigned char const* const end, size_t const k, std::vector<RealVec2>& values) const;
+      void corrupt() const;
+
+      std::FILE* file;
+      std::string fileName;
+      Telemetry::Header header;
+
+      std::vector<unsigned char> bytes;
+      size_t frameCount;
+      size_t characterCount;
+      std::vector<int> frames;
+      std::vector<Real> times;
+      // For each frame, for each character.
+      std::vector<RealVec2> positions;
+      std::vector<RealVec2> velocities;
+      std::vector<int> tagTimes;
+      // The contacts, and where each frame's start.
+      std::vector<Narrowphase::Pair> contacts;
+      std::vector<size_t> contactStarts;
+      std::vector<unsigned long long> keys;
+      std::vector<unsigned long long> previousKeys;
+      std::vector<unsigned long long> removedKeys;
+      std::vector<unsigned long long> addedKeys;
+   };
+
+   Real TelemetryReader::getResolution() const
+   {
+      return Real(header.resolution);
+   }
+
+   size_t TelemetryReader::getFrameCount() const
+   {
+      return frameCount;
+   }
+
+   size_t TelemetryReader::getCharacterCount() const
+   {
+      return characterCount;
+   }
+
+   int TelemetryReader::getFrame(size_t const frame) const
+   {
+      TG_ASSERT(frame < frameCount);
+      return frames[frame];
+   }
+
+   Real TelemetryReader::getTime(size_t const frame) const
+   {
+      TG_ASSERT(frame < frameCount);
+      return times[frame];
+   }
+
+   RealVec2 const& TelemetryReader::getPosition(size_t const frame, size_t const id) const
+   {
+      TG_ASSERT(frame < frameCount && id < characterCount);
+      return positions[frame * characterCount + id];
+   }
+
+   RealVec2 const& TelemetryReader::getVelocity(size_t const frame, size_t const id) const
+   {
+      TG_ASSERT(frame < frameCount && id < characterCount);
+      return velocities[frame * characterCount + id];
+   }
+
+   int TelemetryReader::getTagTime(size_t const frame, size_t const id) const
+   {
+      TG_ASSERT(frame < frameCount && id < characterCount);
+      return tagTimes[frame * characterCount + id];
+   }
+
+   Narrowphase::Pair const* TelemetryReader::getContactsBegin(size_t const frame) const
+   {
+      TG_ASSERT(frame < frameCount);
+      return contacts.empty() ? NULL : &contacts[0] + contactStarts[frame];
+   }
+
+   Narrowphase::Pair const* TelemetryReader::getContactsEnd(size_t const frame) const
+   {
+      TG_ASSERT(frame < frameCount);
+      return contacts.empty() ? NULL : &contacts[0] + contactStarts[frame + 1];
+   }
+}
+
+#endif
@@ -0,0 +1,199 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+
+#include "ThreadPool.h"
+
+#if defined(TG_USE_PTHREADS)
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+using namespace tagGame;
+
+using namespace std;
+
+TG_THREAD_LOCAL size_t ThreadPool::worker = 0;
+
+ThreadPool::ThreadPool(size_t threadCount) :
+   threadCount(0 < threadCount ? threadCount : getProcessorCount()),
+   job(NULL),
+   grainSize(1)
+{
+#if defined(TG_USE_PTHREADS)
+   generation = 0;
+   busyCount = 0;
+   isStopping = false;
+   pthread_mutex_init(&mutex, NULL);
+   pthread_cond_init(&wake, NULL);
+   pthread_cond_init(&done, NULL);
+
+   blocks.resize(this->threadCount);
+   starts.resize(this->threadCount);
+   threads.resize(this->threadCount);
+   for (size_t i = 1; i < this->threadCount; i++)
+   {
+      starts[i].pool = this;
+      starts[i].worker = i;
+      if (0 != pthread_create(&threads[i], NULL, threadMain, &starts[i]))
+      {
+         Util::error("unable to create thread " + Util::itos(int(i)));
+      }
+   }
+#else
+   Util::warn(1 == this->threadCount, "threads aren't supported, so running serially");
+   this->threadCount = 1;
+   blocks.resize(1);
+#endif
+}
+
+ThreadPool::~ThreadPool()
+{
+#if defined(TG_USE_PTHREADS)
+   pthread_mutex_lock(&mutex);
+   isStopping = true;
+   pthread_cond_broadcast(&wake);
+   pthread_mutex_unlock(&mutex);
+
+   for (size_t i = 1; i < threadCount; i++)
+   {
+      pthread_join(threads[i], NULL);
+   }
+
+   pthread_cond_destroy(&done);
+   pthread_cond_destroy(&wake);
+   pthread_mutex_destroy(&mutex);
+#endif
+}
+
+void ThreadPool::run(Job& job, size_t const n, size_t const grainSize)
+{
+   TG_ASSERT(0 < grainSize);
+   TG_ASSERT_MSG(!this->job, "jobs can't be nested");
+
+   // The calling thread is this pool's worker 0 until the job is done, even
+   // if it is a worker in some other pool's job.
+   size_t const outerWorker = worker;
+   worker = 0;
+
+   // Not worth waking anyone up.
+   if (1 == threadCount || n <= grainSize)
+   {
+      job.run(0, n, worker);
+      worker = outerWorker;
+      return;
+   }
+
+   this->job = &job;
+   this->grainSize = grainSize;
+
+   size_t const blockSize = n / threadCount;
+   for (size_t i = 0; i < threadCount; i++)
+   {
+      blocks[i].next = i * blockSize;
+      blocks[i].end = i + 1 < threadCount ? (i + 1) * blockSize : n;
+   }
+
+#if defined(TG_USE_PTHREADS)
+   pthread_mutex_lock(&mutex);
+   generation++;
+   busyCount = threadCount - 1;
+   pthread_cond_broadcast(&wake);
+   pthread_mutex_unlock(&mutex);
+
+   work(0);
+
+   pthread_mutex_lock(&mutex);
+   while (0 < busyCount)
+   {
+      pthread_cond_wait(&done, &mutex);
+   }
+   pthread_mutex_unlock(&mutex);
+#endif
+
+   this->job = NULL;
+   worker = outerWorker;
+}
+
+void ThreadPool::work(size_t const worker)
+{
+   // Finish my own block first, then help everyone else with theirs.
+   for (size_t i = 0; i < threadCount; i++)
+   {
+      Block& block(blocks[(worker + i) % threadCount]);
+      while (runChunk(block, worker))
+      {
+      }
+   }
+}
+
+bool ThreadPool::runChunk(Block& block, size_t const worker)
+{
+#if defined(TG_USE_PTHREADS)
+   size_t const begin = __sync_fetch_and_add(&block.next, grainSize);
+#else
+   size_t const begin = block.next;
+   block.next += grainSize;
+#endif
+   if (block.end <= begin) { return false; }
+
+   job->run(begin, min(begin + grainSize, block.end), worker);
+   return true;
+}
+
+size_t ThreadPool::getProcessorCount()
+{
+#if defined(TG_USE_PTHREADS)
+   long const n = sysconf(_SC_NPROCESSORS_ONLN);
+   return 0 < n ? size_t(n) : 1;
+#else
+   return 1;
+#endif
+}
+
+#if defined(TG_USE_PTHREADS)
+void* ThreadPool::threadMain(void* start)
+{
+   ThreadPool& pool(*static_cast<Start*>(start)->pool);
+   worker = static_cast<Start*>(start)->worker;
+
+   unsigned seen = 0;
+   pthread_mutex_lock(&pool.mutex);
+   while (true)
+   {
+      while (seen == pool.generation && !pool.isStopping)
+      {
+         pthread_cond_wait(&pool.wake, &pool.mutex);
+      }
+      if (pool.isStopping) { break; }
+      seen = pool.generation;
+      pthread_mutex_unlock(&pool.mutex);
+
+      pool.work(worker);
+
+      pthread_mutex_lock(&pool.mutex);
+      if (0 == --pool.busyCount)
+      {
+         pthread_cond_signal(&pool.done);
+      }
+   }
+   pthread_mutex_unlock(&pool.mutex);
+
+   return NULL;
+}
+#endif
@@ -0,0 +1,130 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+#ifndef TG_THREAD_POOL_H
+#define TG_THREAD_POOL_H
+
+#include "Util.h"
+
+#include <vector>
+
+#if !defined(TG_NO_THREADS) && !defined(_WIN32)
+#define TG_USE_PTHREADS 1
+#include <pthread.h>
+#endif
+
+namespace tagGame
+{
+   /// A fixed size pool of worker threads for running loops in parallel.
+   /// The calling thread is always worker 0, so a pool of one thread just
+   /// runs everything serially.  The items of a loop are split into one
+   /// block per worker, and each worker works through its own block a chunk
+   /// at a time.  Once its block is finished, a worker steals chunks from
+   /// the other workers' blocks, so the load stays balanced even if some
+   /// items take much longer than others.
+   /// Threads are only supported with POSIX threads.  Elsewhere (or if
+   /// TG_NO_THREADS is defined) every pool runs serially.
+   class ThreadPool
+   {
+   public:
+      /// The work to be done for each item in a loop.
+      class Job
+      {
+      public:
+         virtual ~Job() {}
+         /// Do items [begin, end) on the given worker.
+         virtual void run(size_t const begin, size_t const end, size_t const worker) = 0;
+      };
+
+      /// Create a pool of threadCount workers (including the calling thread).
+      /// If threadCount is 0, there is one worker per processor.
+      explicit ThreadPool(size_t threadCount = 1);
+      ~ThreadPool();
+
+      inline size_t getThreadCount() const;
+
+      /// Run job on items [0, n), handed out grainSize at a time, and wait
+      /// for it to finish.  Jobs can't be nested, but a job can run jobs of
+      /// its own on another pool.
+      void run(Job& job, size_t const n, size_t const grainSize = 1);
+
+      /// Which worker the calling thread is, in the pool whose job it is
+      /// running (0 for threads not running a job).
+      inline static size_t getWorker();
+
+      static size_t getProcessorCount();
+
+   protected:
+   private:
+      // Pools own threads, so can't be copied.
+      ThreadPool(ThreadPool const&);
+      ThreadPool& operator=(ThreadPool const&);
+
+      // Each worker's block of items.  Padded so that workers claiming
+      // chunks from different blocks don't fight over the same cache line.
+      struct Block
+      {
+         size_t next;
+         size_t end;
+         char padding[64 - 2 * sizeof(size_t)];
+      };
+
+      // What a new thread needs to know to start working.
+      struct Start
+      {
+         ThreadPool* pool;
+         size_t worker;
+      };
+
+      void work(size_t const worker);
+      bool runChunk(Block& block, size_t const worker);
+
+      size_t threadCount;
+      std::vector<Block> blocks;
+      Job* job;
+      size_t grainSize;
+
+      static TG_THREAD_LOCAL size_t worker;
+
+#if defined(TG_USE_PTHREADS)
+      static void* threadMain(void* start);
+
+      std::vector<Start> starts;
+      std::vector<pthread_t> threads;
+      pthread_mutex_t mutex;
+      // Signalled when there is a new job (or the pool is stopping).
+      pthread_cond_t wake;
+      // Signalled when the last busy thread finishes a job.
+      pthread_cond_t done;
+      unsigned generation;
+      size_t busyCount;
+      bool isStopping;
+#endif
+   };
+
+   size_t ThreadPool::getThreadCount() const
+   {
+      return threadCount;
+   }
+
+   size_t ThreadPool::getWorker()
+   {
+      return worker;
+   }
+}
+
+#endif
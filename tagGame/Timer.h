@@ -20,7 +20,20 @@
 
 #include "MathUtil.h"
 
+// Define TG_NO_SDL to build without SDL, e.g. for the headless batch runner.
+#if !defined(TG_NO_SDL)
 #include <SDL.h>
+#endif
+// Also needed for preciseTime, which SDL doesn't provide.
+#if defined(_MSC_VER)
+#if !defined(NOMINMAX)
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/time.h>
+#include <time.h>
+#endif
 
 namespace tagGame
 {
@@ -60,6 +73,12 @@ namespace tagGame
       /// Wall clock time in seconds.
       inline static Real time();
 
+      /// Wall clock time in seconds, measured with the most precise clock
+      /// available (typically to within a microsecond or better), for timing
+      /// short pieces of code.  Unlike time, it doesn't count from any
+      /// particular point, so only differences between two times make sense.
+      inline static Real preciseTime();
+
    protected:
    private:
       /// Purposefully hidden so that there can be only one Timer.
@@ -138,13 +157,50 @@ namespace tagGame
    // that don't support SDL.
    int Timer::ticks()
    {
+#if !defined(TG_NO_SDL)
       return SDL_GetTicks();
+#elif defined(_MSC_VER)
+      static DWORD const startTicks = GetTickCount();
+      return int(GetTickCount() - startTicks);
+#else
+      // Like SDL_GetTicks, count from the first call so that the result fits in an int.
+      static timeval startTv;
+      static bool started(false);
+      timeval tv;
+      gettimeofday(&tv, NULL);
+      if (!started)
+      {
+         startTv = tv;
+         started = true;
+      }
+      return int((tv.tv_sec - startTv.tv_sec) * ticksPerSec + (tv.tv_usec - startTv.tv_usec) / 1000);
+#endif
    }
 
    Real Timer::time()
    {
       return Real(ticks())/Real(ticksPerSec);
    }
+
+   Real Timer::preciseTime()
+   {
+#if defined(_MSC_VER)
+      static LARGE_INTEGER frequency;
+      static BOOL const hasCounter = QueryPerformanceFrequency(&frequency);
+      if (!hasCounter) { return time(); }
+      LARGE_INTEGER counter;
+      QueryPerformanceCounter(&counter);
+      return Real(counter.QuadPart)/Real(frequency.QuadPart);
+#elif defined(CLOCK_MONOTONIC)
+      timespec ts;
+      clock_gettime(CLOCK_MONOTONIC, &ts);
+      return Real(ts.tv_sec) + Real(ts.tv_nsec) * Real(1e-9);
+#else
+      timeval tv;
+      gettimeofday(&tv, NULL);
+      return Real(tv.tv_sec) + Real(tv.tv_usec) * Real(1e-6);
+#endif
+   }
 }
 
 #endif
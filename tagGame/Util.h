@@ -22,6 +22,7 @@
 #include <cstdlib>
 #include <cassert>
 #include <string>
+#include <vector>
 
 #undef TG_USE_TR1
 #if defined(__GNUC__) && (__GNUC__ >= 4)
@@ -75,9 +76,29 @@ namespace tagGame
       /// Convert n to a string.
       static std::string itos(int n);
 
+      /// Parse a comma separated list of numbers, e.g. from the command
+      /// line.  False if anything in it isn't a number.
+      template<class T> static bool parseList(char const* s, std::vector<T>& values);
+
    protected:
    private:
    };
+
+   template<class T>
+   bool Util::parseList(char const* s, std::vector<T>& values)
+   {
+      values.clear();
+      while (true)
+      {
+         char* end;
+         double const x = std::strtod(s, &end);
+         if (end == s) { return false; }
+         values.push_back(T(x));
+         if ('\0' == *end) { return true; }
+         if (',' != *end) { return false; }
+         s = end + 1;
+      }
+   }
 }
 
 #if defined(DEBUG)
@@ -90,4 +111,11 @@ namespace tagGame
 
 #define TG_ARRAY_COUNT(x) (sizeof(x)/sizeof((x)[0]))
 
+// Storage class for variables that each thread needs its own copy of.
+#if defined(_MSC_VER)
+   #define TG_THREAD_LOCAL __declspec(thread)
+#else
+   #define TG_THREAD_LOCAL __thread
+#endif
+
 #endif
@@ -16,47 +16,53 @@
 // ----------------------------------------------------------------------------
 
 #include "Util2D.h"
+#include "Random.h"
 
 using namespace tagGame;
 
-RealMatrix Util2D::perpendicularTo(RealVec const& v)
+RealMatrix Util2D::perpendicularTo(RealVec2 const& v)
 {
    // TODO: add more asserts of this nature
    TG_ASSERT(dim == v.size());
-   RealVec n0(dim);
-   n0[0] = v[1];
-   n0[1] = -v[0];
+   RealVec2 n0(perpendicular(v));
 
-   RealVec n1(dim);
-   n1[0] = -v[1];
-   n1[1] = v[0];
+   RealVec2 n1(n0);
+   n1.scale(-1);
 
    RealMatrix pts(dim, dim);
-   pts.setRow(0, n0);
-   pts.setRow(1, n1);
+   pts.setRow(0, RealVec(n0));
+   pts.setRow(1, RealVec(n1));
 
    return pts;
 }
 
-RealVec Util2D::perpendicularTo(RealVec const& v, RealVec const& d)
+RealVec2 Util2D::perpendicular(RealVec2 const& v)
+{
+   RealVec2 n(dim);
+   n[0] = v[1];
+   n[1] = -v[0];
+
+   return n;
+}
+
+RealVec2 Util2D::perpendicularTo(RealVec2 const& v, RealVec2 const& d)
 {
    TG_ASSERT(MathUtil::isAlmostEq(1,v.length()));
    TG_ASSERT(MathUtil::isAlmostEq(1,d.length()));
 
-   RealMatrix m(perpendicularTo(v));
-   Real const cosA = d.dot(m.getRow(0));
-   // Real const cosB = d.dot(m.getRow(1));
+   RealVec2 n(perpendicular(v));
+   Real const cosA = d.dot(n);
 
-   if (MathUtil::isAlmostZero(cosA)) { return m.getRow(0); }
+   if (MathUtil::isAlmostZero(cosA)) { return n; }
 
    // Pick the one with non-zero component in the d direction.
-   // Since row 1 and row 2 are 180 degrees apart, this should be unambiguous.
-   return 0 < cosA ? m.getRow(0) : m.getRow(1);
+   // Since the two perpendiculars are 180 degrees apart, this should be unambiguous.
+   return 0 < cosA ? n : n.scale(-1);
 }
 
-RealVec Util2D::dir(Real const t)
+RealVec2 Util2D::dir(Real const t)
 {
-   RealVec v(dim);
+   RealVec2 v(dim);
    Real const tr = MathUtil::degToRad(t);
    v[0] = cos(tr);
    v[1] = sin(tr);
@@ -64,21 +70,21 @@ RealVec Util2D::dir(Real const t)
    return v;
 }
 
-RealVec Util2D::uniformDir()
+RealVec2 Util2D::uniformDir()
 {
-   return dir(MathUtil::uniform01() * Real(360) - Real(180));
+   return dir(Random::current().uniform01() * Real(360) - Real(180));
 }
 
-RealVec Util2D::normalDir(Real const mean, Real const std)
+RealVec2 Util2D::normalDir(Real const mean, Real const std)
 {
    return dir(MathUtil::normalAngle(mean, std));
 }
 
-Real Util2D::angle(RealVec const& v)
+Real Util2D::angle(RealVec2 const& v)
 {
    TG_ASSERT(dim == v.size());
 
-   RealVec u(v);
+   RealVec2 u(v);
    u.normalize();
    return MathUtil::radToDeg(atan2(u[1], u[0]));
 }
@@ -92,19 +98,22 @@ RealMatrix Util2D::rotationMatrix(Real const t)
    return m;
 }
 
-RealVec Util2D::randomPosition(RealVec const& worldDim)
+RealVec2 Util2D::randomPosition(RealVec2 const& worldDim)
 {
-   RealVec p(dim);
+   Random& random(Random::current());
+   RealVec2 p(dim);
 
-   p.randomize();
-   p.scale(worldDim);
+   for (size_t i = 0; i < dim; i++)
+   {
+      p[i] = random.uniform01() * worldDim[i];
+   }
 
    return p;
 }
 
-RealMatrix Util2D::tagentLinePts(RealVec const& p, RealVec const& center, Real const radius)
+RealMatrix Util2D::tagentLinePts(RealVec2 const& p, RealVec2 const& center, Real const radius)
 {
-   RealVec v(center.relativeTo(p));
+   RealVec2 v(center.relativeTo(p));
    Real const d = v.length();
 
    TG_ASSERT_MSG(d < radius, "tangentLinePts: point is inside circle");
@@ -115,44 +124,44 @@ RealMatrix Util2D::tagentLinePts(RealVec const& p, RealVec const& center, Real c
    Real const beta2 = alpha - theta;
    Real const h = sqrt(d * d - radius * radius);
 
-   RealVec q0(dim);
+   RealVec2 q0(dim);
    q0[0] = cos(beta1);
    q0[1] = sin(beta1);
    q0.scale(h);
    q0.add(p);
 
-   RealVec q1(dim);
+   RealVec2 q1(dim);
    q1[0] = cos(beta2);
    q1[1] = sin(beta2);
    q1.scale(h);
    q1.add(p);
 
    RealMatrix pts(dim, dim);
-   pts.setRow(0, q0);
-   pts.setRow(1, q1);
+   pts.setRow(0, RealVec(q0));
+   pts.setRow(1, RealVec(q1));
 
    return pts;
 }
 
-RealMatrix Util2D::perpendicularLinePts(RealVec const& p, RealVec const& center, Real const radius)
+RealMatrix Util2D::perpendicularLinePts(RealVec2 const& p, RealVec2 const& center, Real const radius)
 {
-   RealVec v(center.relativeTo(p));
+   RealVec2 v(center.relativeTo(p));
 
    Real const alpha = atan2(v[1], v[0]);
 
-   RealVec q0(dim);
+   RealVec2 q0(dim);
    q0[0] = cos(alpha + M_PI_2);
    q0[1] = sin(alpha + M_PI_2);
    q0.add(center);
 
-   RealVec q1(dim);
+   RealVec2 q1(dim);
    q1[0] = cos(alpha - M_PI_2);
    q1[1] = sin(alpha - M_PI_2);
    q1.add(center);
 
    RealMatrix pts(dim, dim);
-   pts.setRow(0, q0);
-   pts.setRow(1, q1);
+   pts.setRow(0, RealVec(q0));
+   pts.setRow(1, RealVec(q1));
 
    return pts;
 }
@@ -30,21 +30,24 @@ namespace tagGame
 
       // TODO: inline some of these
       /// Return the two vectors perpendicular to v.
-      static RealMatrix perpendicularTo(RealVec const& v);
+      static RealMatrix perpendicularTo(RealVec2 const& v);
+      /// Return the first of the two vectors perpendicular to v (i.e. v rotated
+      /// by -90 degrees).  Unlike perpendicularTo, this doesn't allocate a matrix.
+      static RealVec2 perpendicular(RealVec2 const& v);
       /// Return the vector perpendicular to v that is closest in direction to d.
-      static RealVec perpendicularTo(RealVec const& v, RealVec const& d);
-      static RealVec dir(Real const t);
-      static RealVec uniformDir();
-      static RealVec normalDir(Real const mean, Real const std);
-      static Real angle(RealVec const& v);
+      static RealVec2 perpendicularTo(RealVec2 const& v, RealVec2 const& d);
+      static RealVec2 dir(Real const t);
+      static RealVec2 uniformDir();
+      static RealVec2 normalDir(Real const mean, Real const std);
+      static Real angle(RealVec2 const& v);
       static RealMatrix rotationMatrix(Real const t);
-      static RealVec randomPosition(RealVec const& worldDim);
+      static RealVec2 randomPosition(RealVec2 const& worldDim);
       /// Computes points on circle and on tangent line of p to
       /// circle.
-      static RealMatrix tagentLinePts(RealVec const& p, RealVec const& center, Real const radius);
+      static RealMatrix tagentLinePts(RealVec2 const& p, RealVec2 const& center, Real const radius);
       /// Computes points on circle that intersects with the line
       /// perpendicular to the line from p to center.
-      static RealMatrix perpendicularLinePts(RealVec const& p, RealVec const& center, Real const radius);
+      static RealMatrix perpendicularLinePts(RealVec2 const& p, RealVec2 const& center, Real const radius);
    };
 }
 
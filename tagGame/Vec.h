@@ -28,6 +28,9 @@
 
 namespace tagGame
 {
+   template <class T, size_t N = 0>
+   class Vec;
+
    /// A basic templatized vector class.
    /// The world probably doesn't need yet another vector class, but
    /// this one has several desirable properties:
@@ -36,8 +39,8 @@ namespace tagGame
    ///  - it is simple and light-weight;
    ///  - it avoids any "behind the scenes" copying of objects;
    ///  - it avoids almost all use of operator overloading (can make code hard to read)
-   ///  - it allows arbiray length vectors (partial template specializations could be
-   ///    written to provide faster special case implmentations for 2D, 3D and 4D vectors).
+   ///  - it allows arbiray length vectors (Vec<T, N> below is a fixed length version
+   ///    for when the length is known at compile time, e.g. 2D positions).
    ///  - it makes extensive use of STL to simplify and reduce the amount of code
    ///    (STL could be expanded and improved to make the code even simpler and shorter).
    ///
@@ -45,12 +48,14 @@ namespace tagGame
    /// are looking for such a library try www.boost.org, geometrictools.com, or any
    /// of a host of other libraries.
    template <class T>
-   class Vec : public std::vector<T>
+   class Vec<T, 0> : public std::vector<T>
    {
    public:
       Vec(size_t const n = 0);
       Vec(std::vector<T> const& data);
       Vec(Vec const& v);
+      template <size_t N>
+      explicit Vec(Vec<T, N> const& v);
       // ~Vec();
 
       bool isAlmostEq(Vec const& v) const;
@@ -96,6 +101,79 @@ namespace tagGame
    typedef Vec<int> IntVec;
    typedef Vec<Real> RealVec;
 
+   /// A fixed length version of the vector class.
+   /// It has the same interface as the arbitrary length version, but the
+   /// elements are stored in the object itself, so creating and copying
+   /// one never allocates any memory.  This makes it the better choice for
+   /// all the small temporary vectors in the simulator and the controllers.
+   template <class T, size_t N>
+   class Vec
+   {
+   public:
+      typedef T value_type;
+      typedef T* iterator;
+      typedef T const* const_iterator;
+
+      /// The size is only a parameter to keep the same interface as the arbitrary
+      /// length vector, it must be N.
+      Vec(size_t const n = N);
+      explicit Vec(Vec<T> const& v);
+
+      inline size_t size() const;
+      inline T& operator[](size_t const i);
+      inline T const& operator[](size_t const i) const;
+      inline iterator begin();
+      inline iterator end();
+      inline const_iterator begin() const;
+      inline const_iterator end() const;
+
+      bool operator==(Vec const& v) const;
+      bool operator!=(Vec const& v) const;
+
+      bool isAlmostEq(Vec const& v) const;
+      bool isAlmostZero() const;
+
+      std::ostream& output(std::ostream& out) const;
+
+      inline Vec& set(T const x);
+      inline Vec& add(Vec const& v);
+      inline Vec& subtract(Vec const& v);
+      inline Vec& scale(T const x);
+      inline Vec& scale(Vec const& v);
+
+      inline T length() const;
+      inline T squaredLength() const;
+      T minElement() const;
+      T maxElement() const;
+      size_t argMax() const;
+      size_t argMin() const;
+      inline T dot(Vec const& v) const;
+      T sum() const;
+
+      inline Vec& normalize();
+      inline Vec& setLength(T const x);
+      inline Vec& clampMaxLength(T const x);
+      Vec& shuffle();
+      Vec& randomize();
+      Vec& wrap(Vec const& v);
+      Vec& clamp(Vec const& lower, Vec const& upper);
+
+      /// Make this into a probability distribution.
+      Vec& probabilityDistribution();
+
+      /// Calculate a new vector that is this vector relative to v.
+      inline Vec relativeTo(Vec const& v) const;
+   protected:
+   private:
+      T x[N];
+   };
+
+   template <class T, size_t N>
+   std::ostream& operator<<(std::ostream& out, Vec<T, N> const& v);
+
+   typedef Vec<int, 2> IntVec2;
+   typedef Vec<Real, 2> RealVec2;
+
    template <class T>
    Vec<T>::Vec(size_t const size) :
       std::vector<T>(size)
@@ -114,6 +192,13 @@ namespace tagGame
       std::vector<T>(v) 
    {
    }
+
+   template <class T>
+   template <size_t N>
+   Vec<T>::Vec(Vec<T, N> const& v) :
+      std::vector<T>(v.begin(), v.end())
+   {
+   }
    
    // not really needed, but uncommenting this destructor causes an internal compiler error on MacOSX!
    /*
@@ -362,6 +447,324 @@ namespace tagGame
    {
       return v.output(out);
    }
+
+   template <class T, size_t N>
+   Vec<T, N>::Vec(size_t const n)
+   {
+      TG_ASSERT(N == n);
+      set(T(0));
+   }
+
+   template <class T, size_t N>
+   Vec<T, N>::Vec(Vec<T> const& v)
+   {
+      TG_ASSERT(N == v.size());
+      std::copy(v.begin(), v.end(), x);
+   }
+
+   template <class T, size_t N>
+   size_t Vec<T, N>::size() const
+   {
+      return N;
+   }
+
+   template <class T, size_t N>
+   T& Vec<T, N>::operator[](size_t const i)
+   {
+      return x[i];
+   }
+
+   template <class T, size_t N>
+   T const& Vec<T, N>::operator[](size_t const i) const
+   {
+      return x[i];
+   }
+
+   template <class T, size_t N>
+   typename Vec<T, N>::iterator Vec<T, N>::begin()
+   {
+      return x;
+   }
+
+   template <class T, size_t N>
+   typename Vec<T, N>::iterator Vec<T, N>::end()
+   {
+      return x + N;
+   }
+
+   template <class T, size_t N>
+   typename Vec<T, N>::const_iterator Vec<T, N>::begin() const
+   {
+      return x;
+   }
+
+   template <class T, size_t N>
+   typename Vec<T, N>::const_iterator Vec<T, N>::end() const
+   {
+      return x + N;
+   }
+
+   template <class T, size_t N>
+   bool Vec<T, N>::operator==(Vec const& v) const
+   {
+      return std::equal(begin(), end(), v.begin());
+   }
+
+   template <class T, size_t N>
+   bool Vec<T, N>::operator!=(Vec const& v) const
+   {
+      return !(*this == v);
+   }
+
+   template <class T, size_t N>
+   Vec<T, N>& Vec<T, N>::set(T const y)
+   {
+      for (size_t i = 0; i < N; i++)
+      {
+         x[i] = y;
+      }
+
+      return *this;
+   }
+
+   template <class T, size_t N>
+   Vec<T, N>& Vec<T, N>::add(Vec const& v)
+   {
+      for (size_t i = 0; i < N; i++)
+      {
+         x[i] += v.x[i];
+      }
+
+      return *this;
+   }
+
+   template <class T, size_t N>
+   Vec<T, N>& Vec<T, N>::subtract(Vec const& v)
+   {
+      for (size_t i = 0; i < N; i++)
+      {
+         x[i] -= v.x[i];
+      }
+
+      return *this;
+   }
+
+   template <class T, size_t N>
+   Vec<T, N>& Vec<T, N>::scale(T const y)
+   {
+      for (size_t i = 0; i < N; i++)
+      {
+         x[i] = y * x[i];
+      }
+
+      return *this;
+   }
+
+   template <class T, size_t N>
+   Vec<T, N>& Vec<T, N>::scale(Vec const& v)
+   {
+      for (size_t i = 0; i < N; i++)
+      {
+         x[i] *= v.x[i];
+      }
+
+      return *this;
+   }
+
+   template <class T, size_t N>
+   T Vec<T, N>::length() const
+   {
+      return T(sqrt(Real(this->squaredLength())));
+   }
+
+   template <class T, size_t N>
+   T Vec<T, N>::squaredLength() const
+   {
+      return this->dot(*this);
+   }
+
+   template <class T, size_t N>
+   T Vec<T, N>::dot(Vec const& v) const
+   {
+      // Same order of operations as the arbitrary length version, so that
+      // both give identical results.
+      T d(0);
+      for (size_t i = 0; i < N; i++)
+      {
+         d = d + x[i] * v.x[i];
+      }
+
+      return d;
+   }
+
+   template <class T, size_t N>
+   T Vec<T, N>::sum() const
+   {
+      return std::accumulate(begin(), end(), T(0));
+   }
+
+   template <class T, size_t N>
+   size_t Vec<T, N>::argMin() const
+   {
+      return std::min_element(begin(), end()) - begin();
+   }
+
+   template <class T, size_t N>
+   size_t Vec<T, N>::argMax() const
+   {
+      return std::max_element(begin(), end()) - begin();
+   }
+
+   template <class T, size_t N>
+   T Vec<T, N>::minElement() const
+   {
+      return x[argMin()];
+   }
+
+   template <class T, size_t N>
+   T Vec<T, N>::maxElement() const
+   {
+      return x[argMax()];
+   }
+
+   template <class T, size_t N>
+   Vec<T, N>& Vec<T, N>::normalize()
+   {
+      return setLength(T(1));
+   }
+
+   template <class T, size_t N>
+   Vec<T, N>& Vec<T, N>::clampMaxLength(T const y)
+   {
+      Real const l(length());
+
+      if (y < l)
+      {
+         setLength(y);
+      }
+
+      return *this;
+   }
+
+   template <class T, size_t N>
+   Vec<T, N>& Vec<T, N>::setLength(T const y)
+   {
+      Real const l(length());
+      if (MathUtil::isAlmostZero(l))
+      {
+         set(T(0));
+      }
+      else
+      {
+         scale(y/T(l));
+      }
+
+      return *this;
+   }
+
+   template <class T, size_t N>
+   Vec<T, N>& Vec<T, N>::shuffle()
+   {
+      // Fisher-Yates, drawing from the calling thread's random stream.
+      for (size_t i = 1; i < N; i++)
+      {
+         std::swap(x[i], x[MathUtil::uniform(int(i + 1))]);
+      }
+
+      return *this;
+   }
+
+   template <class T, size_t N>
+   Vec<T, N>& Vec<T, N>::randomize()
+   {
+      std::generate(begin(), end(), MathUtil::uniform01);
+
+      return *this;
+   }
+
+   template <class T, size_t N>
+   Vec<T, N>& Vec<T, N>::wrap(Vec const& v)
+   {
+      for (size_t i = 0; i < N; i++)
+      {
+         // otherwise loops forever
+         TG_ASSERT(0 < v[i]);
+
+         while (x[i] < 0)
+         {
+            x[i] += v[i];
+         }
+         while (v[i] < x[i])
+         {
+            x[i] -= v[i];
+         }
+      }
+
+      return *this;
+   }
+
+   template <class T, size_t N>
+   Vec<T, N>& Vec<T, N>::clamp(Vec const& lower, Vec const& upper)
+   {
+      for (size_t i = 0; i < N; i++)
+      {
+         x[i] = MathUtil::clamp(x[i], lower[i], upper[i]);
+      }
+
+      return *this;
+   }
+
+   template <class T, size_t N>
+   bool Vec<T, N>::isAlmostEq(Vec const& v) const
+   {
+      for (size_t i = 0; i < N; i++)
+      {
+         if (!MathUtil::isAlmostEq(x[i], v[i])) { return false; }
+      }
+      return true;
+   }
+
+   template <class T, size_t N>
+   bool Vec<T, N>::isAlmostZero() const
+   {
+      for (size_t i = 0; i < N; i++)
+      {
+         if (!MathUtil::isAlmostZero(x[i])) { return false; }
+      }
+      return true;
+   }
+
+   template <class T, size_t N>
+   Vec<T, N> Vec<T, N>::relativeTo(Vec const& v) const
+   {
+      Vec u(*this);
+
+      return u.subtract(v);
+   }
+
+   template <class T, size_t N>
+   std::ostream& Vec<T, N>::output(std::ostream& out) const
+   {
+      std::copy(begin(), end(), std::ostream_iterator<T>(out, " "));
+
+      return out;
+   }
+
+   template <class T, size_t N>
+   Vec<T, N>& Vec<T, N>::probabilityDistribution()
+   {
+      Real const s(sum());
+
+      Util::warn(0 < s, "Vec::probabilityDistribution: vector is zero");
+
+      return scale(Real(1.0)/s);
+   }
+
+   template <class T, size_t N>
+   std::ostream& operator<<(std::ostream& out, Vec<T, N> const& v)
+   {
+      return v.output(out);
+   }
 }
 
 #endif
@@ -22,6 +22,24 @@
 #include "ControllerEvade.h"
 #include "Character.h"
 #include "Perception.h"
+#include "GameState.h"
+#include "SpatialGrid.h"
+#include "Integrator.h"
+#include "Narrowphase.h"
+#include "Steering.h"
+#include "Snapshot.h"
+#include "ControllerLookahead.h"
+#include "Recorder.h"
+#include "Replay.h"
+#include "TelemetryReader.h"
+#include "Scenario.h"
+#include "ThreadPool.h"
+#include "Simulator.h"
+#include "ControllerWander.h"
+#include "GameSetup.h"
+#include "ControllerProgram.h"
+
+#include <cstdio>
 
 using namespace tagGame;
 
@@ -34,7 +52,7 @@ void collideTest01()
    cs0->setRadius(2);
    cs1->setRadius(2);
    Obstacle c0(cs0), c1(cs1);
-   RealVec p(Util2D::dim);
+   RealVec2 p(Util2D::dim);
    p.set(0);
    c0.setPosition(p);
    c0.setMass(1);
@@ -51,8 +69,8 @@ void collideTest01()
    c1.setPosition(p);
    TG_ASSERT(1 == c0.distanceTo(c1));
 
-   RealVec rpc1(c0.getPosition().relativeTo(c1.getPosition()));
-   RealVec rpc0(c1.getPosition().relativeTo(c0.getPosition()));
+   RealVec2 rpc1(c0.getPosition().relativeTo(c1.getPosition()));
+   RealVec2 rpc0(c1.getPosition().relativeTo(c0.getPosition()));
 
    rpc0.scale(-1);
    TG_ASSERT(rpc0 == rpc1);
@@ -62,7 +80,7 @@ void collideTest01()
    TG_ASSERT(1 == c0p->distanceTo(*c1p));
 
    SidePtr ss0(new Side());
-   RealVec normal(Util2D::dim);
+   RealVec2 normal(Util2D::dim);
    normal[0] = Real(1);
    normal[1] = Real(0);
    ss0->setNormal(normal);
@@ -100,7 +118,7 @@ void collideTest01()
 
    TG_ASSERT(c0p->isTouching(c1));
 
-   RealVec v(Util2D::dim);
+   RealVec2 v(Util2D::dim);
    v[0] = -1;
    v[1] = 0;
    c0.setVelocity(v);
@@ -143,15 +161,15 @@ void collideTest01()
 
 void collideTest02()
 {
-   RealVec p(Util2D::dim);
+   RealVec2 p(Util2D::dim);
    p.set(0);
    p[0] = 1;
 
-   RealVec v(Util2D::dim);
+   RealVec2 v(Util2D::dim);
    v.set(0);
    v[0] = 1;
 
-   RealVec center(Util2D::dim);
+   RealVec2 center(Util2D::dim);
    center.set(0);
    center[0] = 4;
 
@@ -163,7 +181,7 @@ void collideTest02()
    // TODO: more sensible constructors
    cs->setRadius(radius);
 
-   RealVec q(circle->nearestIntersection(p, v));
+   RealVec2 q(circle->nearestIntersection(p, v));
 
    TG_ASSERT(2 == q[0] && 0 == q[1]);
 
@@ -171,8 +189,8 @@ void collideTest02()
    q = circle->nearestIntersection(p, v);
    TG_ASSERT(Inf == q[0] && Inf == q[1]);
 
-   RealVec begin(Util2D::dim);
-   RealVec end(Util2D::dim);
+   RealVec2 begin(Util2D::dim);
+   RealVec2 end(Util2D::dim);
 
    end[1] = Real(8);
 
@@ -212,9 +230,9 @@ void collideTest02()
 
 void collideTest03()
 {
-   RealVec normal(Util2D::dim);
-   RealVec begin(Util2D::dim);
-   RealVec end(Util2D::dim);
+   RealVec2 normal(Util2D::dim);
+   RealVec2 begin(Util2D::dim);
+   RealVec2 end(Util2D::dim);
 
    SidePtr ss(new Side());
 
@@ -230,11 +248,11 @@ void collideTest03()
    ss->setDistance(0);
 
    CirclePtr cs(new Circle());
-   RealVec w;
+   RealVec2 w;
    GameState gs(w);
    Character* c(new Character(cs, ControllerPtr(new ControllerEvade(PerceptionPtr(new Perception(&gs))))));
    c->setMass(1);
-   RealVec x(Util2D::dim);
+   RealVec2 x(Util2D::dim);
    x.set(5);
    c->setPosition(x);
    cs->setRadius(1);
@@ -249,7 +267,7 @@ void collideTest03()
    Perception perception(&gs);
    perception.setMe(c);
    // TG_ASSERT(side == perception.nextCollider());
-   RealVec cp(perception.nextCollisionPoint());
+   RealVec2 cp(perception.nextCollisionPoint());
    cerr << "cp: " << perception.nextCollisionPoint() << endl;
    // TG_ASSERT(cp[0] == 0 && cp[1] == 5);
 
@@ -272,11 +290,924 @@ void collideTest03()
 #endif
 }
 
+void collideTest04()
+{
+   RealVec2 w(Util2D::dim);
+   w.set(100);
+   GameState gs(w);
+   PerceptionPtr perception(new Perception(&gs));
+
+   RealVec2 p(Util2D::dim);
+   Real const x[] = { 10, 13, 80 };
+   for (size_t i = 0; i < 3; i++)
+   {
+      CirclePtr cs(new Circle());
+      cs->setRadius(2);
+      CharacterPtr c(new Character(cs, ControllerPtr(new ControllerEvade(perception))));
+      p.set(x[i]);
+      c->setPosition(p);
+      gs.addCharacter(c);
+   }
+
+   CirclePtr cs(new Circle());
+   cs->setRadius(5);
+   p.set(50);
+   cs->setPosition(p);
+   gs.addObstacle(ObstaclePtr(new Obstacle(cs)));
+   gs.addObstacle(ObstaclePtr(new Obstacle(SidePtr(new Side()))));
+
+   SpatialGrid const& grid(gs.getGrid());
+
+   RealVec2 lower(Util2D::dim);
+   RealVec2 upper(Util2D::dim);
+   vector<size_t> result;
+
+   // Only the two characters near the origin are anywhere near the first.
+   TG_ASSERT((*gs.getCharacterListBegin())->getBounds(lower, upper));
+   grid.queryCharacters(lower, upper, result);
+   TG_ASSERT(2 == result.size() && 0 == result[0] && 1 == result[1]);
+
+   // Sides have no bounds so are returned by every query.
+   result.clear();
+   grid.queryObstacles(lower, upper, result);
+   TG_ASSERT(!result.empty() && 1 == result.back());
+
+   // Everything is found by a query that covers the whole world.
+   lower.set(-1);
+   upper.set(101);
+   result.clear();
+   grid.queryCharacters(lower, upper, result);
+   TG_ASSERT(3 == result.size());
+   result.clear();
+   grid.queryObstacles(lower, upper, result);
+   TG_ASSERT(2 == result.size() && 0 == result[0] && 1 == result[1]);
+
+   Character& c0(**gs.getCharacterListBegin());
+   Character& c1(*gs.getCharacterListBegin()[1]);
+   Character& c2(*gs.getCharacterListBegin()[2]);
+   Obstacle& o0(**gs.getNonCharacterObstacleListBegin());
+   TG_ASSERT(&c1 == grid.nearestCharacter(c0));
+   TG_ASSERT(&c1 == grid.nearestCharacter(c2));
+   TG_ASSERT(&o0 == grid.nearestObstacle(c2));
+
+   // Looking along the diagonal from c0, c1 is in the way of everything else.
+   RealVec2 v(Util2D::dim);
+   v.set(1);
+   v.normalize();
+   TG_ASSERT(&c1 == grid.nearestIntersecting(c0, c0.getPosition(), v));
+   TG_ASSERT(&o0 == grid.nearestIntersecting(c1, c1.getPosition(), v));
+   v.scale(-1);
+   TG_ASSERT(NULL == grid.nearestIntersecting(c0, c0.getPosition(), v));
+}
+
+void collideTest05()
+{
+   CirclePtr cs(new Circle());
+   cs->setRadius(3);
+   CharacterPtr c;
+   RealVec2 p(Util2D::dim);
+   p.set(7);
+
+   {
+      RealVec2 w(Util2D::dim);
+      w.set(100);
+      GameState gs(w);
+      c = CharacterPtr(new Character(cs, ControllerPtr(new ControllerEvade(PerceptionPtr(new Perception(&gs))))));
+      c->setMass(2);
+      gs.addCharacter(c);
+
+      // Once added, the character is a view onto the game-state's store.
+      EntityStore& store(gs.getCharacterStore());
+      TG_ASSERT(&store == c->getStore() && 0 == c->getId());
+      TG_ASSERT(3 == store.getRadii()[0] && 2 == store.getMasses()[0]);
+      store.getPositions()[0] = p;
+      TG_ASSERT(p == c->getPosition() && p == cs->getPosition());
+   }
+
+   // The character keeps its state after the game-state has gone.
+   TG_ASSERT(p == c->getPosition() && 3 == cs->getRadius() && 2 == c->getMass());
+}
+
+void integrateTest01()
+{
+   // An odd number of characters, so that any SIMD version has a remainder.
+   size_t const n = 37;
+   RealVec2 w(Util2D::dim);
+   w[0] = 200;
+   w[1] = 100;
+
+   EntityStore s0;
+   vector<RealVec2> directions;
+   vector<Real> speeds;
+   for (size_t i = 0; i < n; i++)
+   {
+      s0.add();
+      s0.getPositions()[i] = Util2D::randomPosition(w);
+      // Some characters need wrapping more than once.
+      s0.getPositions()[i][i % 2] += Real(int(i % 7) - 3) * w[i % 2];
+      s0.getMasses()[i] = 1 + 2 * MathUtil::uniform01();
+      s0.getMaxSpeeds()[i] = 100;
+      s0.getMaxForces()[i] = i % 3 ? 150 : 1e9;
+      s0.getTagTimes()[i] = i % 5 ? -1 : 0;
+      s0.setVelocity(i, Util2D::uniformDir().scale(150 * MathUtil::uniform01()));
+      directions.push_back(Util2D::uniformDir());
+      speeds.push_back(i % 4 ? MathUtil::uniform01() : 0);
+   }
+   s0.setVelocity(0, RealVec2(Util2D::dim));
+
+   EntityStore s1;
+   for (size_t i = 0; i < n; i++)
+   {
+      s1.add(s0, i);
+   }
+
+   for (size_t frame = 0; frame < 10; frame++)
+   {
+      Integrator::accelerate(s0, directions, speeds, 0.1);
+      Integrator::move(s0, w, 0.1);
+      Integrator::accelerateScalar(s1, directions, speeds, 0.1);
+      Integrator::moveScalar(s1, w, 0.1);
+   }
+
+   // The results must be bit-identical, not just close.
+   TG_ASSERT(s0.getPositions() == s1.getPositions());
+   TG_ASSERT(s0.getOrientations() == s1.getOrientations());
+   TG_ASSERT(s0.getSpeeds() == s1.getSpeeds());
+}
+
+void collideTest06()
+{
+   RealVec2 w(Util2D::dim);
+   w.set(200);
+   GameState gs(w);
+   Simulator sim(&gs);
+   PerceptionPtr perception(new Perception(&gs));
+
+   // A chain of three touching characters, a touching pair and a loner,
+   // all moving along the x-axis.
+   Real const x[] = { 20, 23.9, 27.8, 100, 103, 150 };
+   Real const y[] = { 20, 20, 20, 100, 100, 150 };
+   Real const vx[] = { 5, 0, -5, 5, -5, 0 };
+   RealVec2 p(Util2D::dim);
+   RealVec2 v(Util2D::dim);
+   for (size_t i = 0; i < 6; i++)
+   {
+      CirclePtr cs(new Circle());
+      cs->setRadius(2);
+      CharacterPtr c(new Character(cs, ControllerPtr(new ControllerWander(perception))));
+      p[0] = x[i];
+      p[1] = y[i];
+      c->setPosition(p);
+      c->setMass(1);
+      v[0] = vx[i];
+      c->setVelocity(v);
+      gs.addCharacter(c);
+   }
+
+   // Even with only one pass, the chain and the pair are each resolved
+   // as an island of their own.
+   sim.setMaxCollisionPasses(1);
+   sim.forward(0.001);
+   TG_ASSERT(2 == sim.getIslandCount());
+   TG_ASSERT(1 == sim.getCollisionPassCount());
+
+   CharacterIterator const characters(gs.getCharacterListBegin());
+   TG_ASSERT(characters[3]->getVelocity()[0] < 0 && 0 < characters[4]->getVelocity()[0]);
+}
+
+void collideTest07()
+{
+   RealVec2 w(Util2D::dim);
+   w.set(200);
+   GameState gs(w);
+   Simulator sim(&gs);
+   PerceptionPtr perception(new Perception(&gs));
+
+   // Two characters heading straight for each other, fast enough to pass
+   // right through each other in one big step, and another two that meet
+   // later in the same step.
+   RealVec2 p(Util2D::dim);
+   RealVec2 v(Util2D::dim);
+   for (size_t i = 0; i < 4; i++)
+   {
+      CirclePtr cs(new Circle());
+      cs->setRadius(2);
+      CharacterPtr c(new Character(cs, ControllerPtr(new ControllerWander(perception))));
+      p.set(i < 2 ? 100 : 50);
+      p[0] = i < 2 ? (i ? 120 : 80) : (i % 2 ? 121 : 79);
+      c->setPosition(p);
+      c->setMass(1);
+      v.set(0);
+      v[0] = i % 2 ? -100 : 100;
+      c->setVelocity(v);
+      gs.addCharacter(c);
+   }
+
+   // The circles' swept test agrees.
+   Character& c0(**gs.getCharacterListBegin());
+   Character& c1(*gs.getCharacterListBegin()[1]);
+   Real leave;
+   TG_ASSERT(MathUtil::isAlmostEq(0.18, c0.timeToImpact(c1, leave)));
+   TG_ASSERT(MathUtil::isAlmostEq(0.22, leave));
+
+   sim.forward(0.3);
+
+   // They bounced off each other instead.
+   TG_ASSERT(1 < sim.getSubstepCount());
+   TG_ASSERT(c0.getPosition()[0] < c1.getPosition()[0]);
+   TG_ASSERT(c0.getVelocity()[0] < 0 && 0 < c1.getVelocity()[0]);
+   // Both impacts count, though they were in different sub-steps (each
+   // pair is touching both ways round).
+   TG_ASSERT(2 < sim.getSubstepCount());
+   TG_ASSERT(4 == sim.getContactCount());
+}
+
+// Counts how many times each item is visited, and by which worker.
+class CountJob : public ThreadPool::Job
+{
+public:
+   CountJob(size_t const n) :
+      counts(n, 0),
+      workers(n, 0)
+   {
+   }
+
+   virtual void run(size_t const begin, size_t const end, size_t const worker)
+   {
+      TG_ASSERT(worker == ThreadPool::getWorker());
+      for (size_t i = begin; i < end; i++)
+      {
+         counts[i]++;
+         workers[i] = worker;
+      }
+   }
+
+   vector<int> counts;
+   vector<size_t> workers;
+};
+
+void narrowphaseTest01()
+{
+   RealVec2 w(Util2D::dim);
+   w.set(100);
+   GameState gs(w, 1);
+   PerceptionPtr perception(new Perception(&gs));
+   Random::Scope scope(gs.getRandom());
+
+   // Enough circles for a few blocks of pairs, plus a circular obstacle
+   // right on top of one of them, and a side.
+   RealVec2 p(Util2D::dim);
+   for (size_t i = 0; i < 50; i++)
+   {
+      CirclePtr cs(new Circle());
+      cs->setRadius(1 + MathUtil::uniform01() * 5);
+      CharacterPtr c(new Character(cs, ControllerPtr(new ControllerWander(perception))));
+      p.randomize().scale(w);
+      c->setPosition(p);
+      c->setMass(1);
+      p.randomize().scale(10);
+      c->setVelocity(p);
+      gs.addCharacter(c);
+   }
+   CirclePtr cs(new Circle());
+   cs->setPosition(gs.getCharacterListBegin()[3]->getPosition());
+   gs.addObstacle(ObstaclePtr(new Obstacle(cs)));
+   SidePtr s(new Side());
+   p.set(0);
+   p[1] = 1;
+   s->setNormal(p);
+   s->setDistance(50);
+   gs.addObstacle(ObstaclePtr(new Obstacle(s)));
+
+   std::vector<Narrowphase::Pair> pairs;
+   Narrowphase::Pair pair;
+   pair.isObstacle = false;
+   for (pair.i = 0; pair.i < 50; pair.i++)
+   {
+      for (pair.j = 0; pair.j < 50; pair.j++)
+      {
+         if (pair.i != pair.j) { pairs.push_back(pair); }
+      }
+   }
+   pair.i = 3;
+   pair.isObstacle = true;
+   for (pair.j = 0; pair.j < 2; pair.j++)
+   {
+      pairs.push_back(pair);
+   }
+
+   std::vector<Real> distances;
+   std::vector<RealVec2> normals;
+   std::vector<Real> approachSpeeds;
+   Narrowphase::evaluate(gs.getCharacterStore(), gs.getObstacleStore(), pairs, distances, normals, &approachSpeeds);
+
+   // Exactly the same as asking the shapes one pair at a time.
+   CharacterIterator const characters = gs.getCharacterListBegin();
+   for (size_t k = 0; k < pairs.size(); k++)
+   {
+      Obstacle const& c(*characters[pairs[k].i]);
+      Obstacle const& o(pairs[k].isObstacle ? *gs.getNonCharacterObstacleListBegin()[pairs[k].j] : *characters[pairs[k].j]);
+      RealVec2 const n(c.normalTo(o));
+
+      TG_ASSERT(c.distanceTo(o) == distances[k]);
+      TG_ASSERT(n[0] == normals[k][0] && n[1] == normals[k][1]);
+      TG_ASSERT(c.isColliding(o) == (distances[k] <= 0 && 0 < approachSpeeds[k]));
+   }
+}
+
+void steeringTest01()
+{
+   Random random(7);
+   Random::Scope scope(random);
+
+   // An odd number, so the SIMD version has a left over, and one character
+   // right on top of its target.
+   std::vector<RealVec2> positions(11, RealVec2(Util2D::dim));
+   std::vector<RealVec2> targets(11, RealVec2(Util2D::dim));
+   for (size_t i = 0; i < positions.size(); i++)
+   {
+      positions[i].randomize().scale(100);
+      targets[i].randomize().scale(100);
+   }
+   targets[4] = positions[4];
+
+   std::vector<RealVec2> directions;
+   std::vector<Real> speeds;
+   Steering::evade(positions, targets, directions, speeds);
+   for (size_t i = 0; i < positions.size(); i++)
+   {
+      TG_ASSERT(directions[i] == Steering::evade(positions[i], targets[i]));
+      TG_ASSERT(Real(1) == speeds[i]);
+   }
+   TG_ASSERT(directions[4] == RealVec2(Util2D::dim).set(0));
+   TG_ASSERT(MathUtil::isAlmostEq(directions[5].length(), 1));
+
+   Steering::pursue(positions, targets[0], directions, speeds);
+   for (size_t i = 0; i < positions.size(); i++)
+   {
+      TG_ASSERT(directions[i] == Steering::pursue(positions[i], targets[0]));
+   }
+
+   // Each character's wandering comes from its own stream.
+   std::vector<Random> randoms;
+   for (size_t i = 0; i < 3; i++)
+   {
+      randoms.push_back(Random(i));
+   }
+   std::vector<Random> copies(randoms);
+   Steering::wander(randoms, directions, speeds);
+   for (size_t i = 0; i < randoms.size(); i++)
+   {
+      RealVec2 direction(Util2D::dim);
+      Real speed;
+      Steering::wander(copies[i], direction, speed);
+      TG_ASSERT(directions[i] == direction);
+      TG_ASSERT(speeds[i] == speed);
+      TG_ASSERT(0.25 <= speed && speed <= 1);
+   }
+}
+
+void perceptionTest01()
+{
+   RealVec2 w(Util2D::dim);
+   w.set(200);
+   GameState gs(w, 1);
+   PerceptionPtr perception(new Perception(&gs));
+   Random::Scope scope(gs.getRandom());
+
+   for (size_t i = 0; i < 20; i++)
+   {
+      CirclePtr cs(new Circle());
+      cs->setRadius(2);
+      CharacterPtr c(new Character(cs, ControllerPtr(new ControllerWander(perception))));
+      c->setPosition(Util2D::randomPosition(w));
+      c->setMass(1);
+      RealVec2 v(Util2D::dim);
+      RealVec2 half(Util2D::dim);
+      half.set(0.5);
+      c->setVelocity(v.randomize().subtract(half).scale(10));
+      gs.addCharacter(c);
+   }
+   CharacterIterator const characters(gs.getCharacterListBegin());
+   characters[7]->setTagged(gs.getTicks());
+
+   // Percepts from the table are the same as those calculated one
+   // character at a time, and are only calculated once per frame.
+   std::vector<Real> distances;
+   std::vector<Character*> nearest;
+   std::vector<Real> times;
+   for (size_t k = 0; k < 2; k++)
+   {
+      for (size_t i = 0; i < 20; i++)
+      {
+         perception->setMe(characters[i].get());
+         if (0 == k)
+         {
+            distances.push_back(perception->distanceToTagged());
+            nearest.push_back(perception->nearestCharacter());
+            times.push_back(perception->timeToCollision());
+            continue;
+         }
+         TG_ASSERT(distances[i] == perception->distanceToTagged());
+         TG_ASSERT(nearest[i] == perception->nearestCharacter());
+         TG_ASSERT(times[i] == perception->timeToCollision());
+      }
+      if (0 == k) { perception->update(); }
+   }
+   perception->resetCacheCounts();
+
+   for (size_t i = 0; i < 20; i++)
+   {
+      perception->setMe(characters[i].get());
+      perception->nearestCharacter();
+   }
+   size_t hits, misses;
+   perception->getCacheCounts(hits, misses);
+   TG_ASSERT(20 == hits && 0 == misses);
+}
+
+void programTest01()
+{
+   RealVec2 w(Util2D::dim);
+   w.set(400);
+   GameState gs(w, 3);
+   Simulator sim(&gs);
+   PerceptionPtr perception(new Perception(&gs));
+   GameSetup::setupObstacles(gs, RendererPtr());
+
+   // Characters running a program compiled from the NPC tree, and a tree
+   // of their own to compare against.
+   std::vector<ControllerPtr> trees;
+   BehaviorProgramPtr program(new BehaviorProgram(*GameSetup::createNPCController(perception, 10)));
+   for (size_t i = 0; i < 10; i++)
+   {
+      CirclePtr cs(new Circle());
+      CharacterPtr c(new Character(cs, ControllerPtr(new ControllerProgram(perception, program))));
+      c->setPosition(Util2D::randomPosition(w));
+      c->setMass(1);
+      gs.addCharacter(c);
+      trees.push_back(GameSetup::createNPCController(perception, 10));
+   }
+   TG_ASSERT(10 == program->getInstanceCount());
+   CharacterIterator const characters(gs.getCharacterListBegin());
+   characters[0]->setTagged(gs.getTicks());
+
+   // Given the same random numbers, the program selects the same actions
+   // as the trees.
+   for (size_t frame = 0; frame < 100; frame++)
+   {
+      std::vector<Action> expected;
+      perception->update();
+      for (size_t i = 0; i < 10; i++)
+      {
+         perception->setMe(characters[i].get());
+         Random random(gs.getCharacterStore().getRandoms()[i]);
+         Random::Scope scope(random);
+         trees[i]->calcAction();
+         expected.push_back(trees[i]->getAction());
+      }
+
+      sim.forward(0.1);
+      gs.incFrame();
+
+      for (size_t i = 0; i < 10; i++)
+      {
+         Action const& action(characters[i]->getAction());
+         TG_ASSERT(expected[i].getDesiredSpeed() == action.getDesiredSpeed());
+         TG_ASSERT(expected[i].getDesiredDirection()[0] == action.getDesiredDirection()[0]);
+         TG_ASSERT(expected[i].getDesiredDirection()[1] == action.getDesiredDirection()[1]);
+      }
+   }
+}
+
+void poolTest01()
+{
+   Pool<Circle> circles(4);
+   std::vector<CirclePtr> cs;
+   for (size_t i = 0; i < 6; i++)
+   {
+      cs.push_back(circles.share());
+      cs.back()->setRadius(Real(i));
+   }
+   TG_ASSERT(6 == circles.size() && 8 == circles.getCapacity());
+
+   // A freed slot is the first to be reused.
+   Circle const* const freed = &*cs[2];
+   cs[2].reset();
+   TG_ASSERT(5 == circles.size());
+   cs[2] = circles.share();
+   TG_ASSERT(freed == &*cs[2] && 10 == cs[2]->getRadius() && 5 == cs[5]->getRadius());
+
+   Pool<Circle> others;
+   Circle* c = others.create();
+   others.create()->setRadius(1);
+   others.destroy(c);
+   TG_ASSERT(1 == others.size());
+   others.clear();
+   TG_ASSERT(0 == others.size());
+
+   // Pooled worlds are the same as any other.
+   RealVec2 w(Util2D::dim);
+   w.set(500);
+   GameSetup::Pools pools;
+   GameState gs0(w, 5);
+   GameState gs1(w, 5);
+   PerceptionPtr perception0(new Perception(&gs0));
+   PerceptionPtr perception1(new Perception(&gs1));
+   GameSetup::setupCharacters(gs0, perception0, 20, RendererPtr());
+   GameSetup::setupCharacters(gs1, perception1, 20, RendererPtr(), &pools);
+   GameSetup::setupObstacles(gs0, RendererPtr());
+   GameSetup::setupObstacles(gs1, RendererPtr(), 7, &pools);
+   TG_ASSERT(20 == pools.characters.size() && 27 == pools.circles.size() && 4 == pools.sides.size());
+   TG_ASSERT(gs0.getCharacterStore().getPositions() == gs1.getCharacterStore().getPositions());
+   TG_ASSERT(gs0.getObstacleStore().getPositions() == gs1.getObstacleStore().getPositions());
+}
+
+void removeTest01()
+{
+   RealVec2 w(Util2D::dim);
+   w.set(300);
+   GameState gs(w, 4);
+   Simulator sim(&gs);
+   PerceptionPtr perception(new Perception(&gs));
+   GameSetup::setupCharacters(gs, perception, 10, RendererPtr());
+   GameSetup::setupObstacles(gs, RendererPtr());
+   CharacterIterator characters(gs.getCharacterListBegin());
+   characters[0]->setTagged(gs.getTicks());
+   gs.incFrame();
+   sim.forward(0.1);
+
+   // Removing a character moves the last one into its place, but handles
+   // still find it.
+   CharacterPtr removed(characters[2]);
+   Handle const h2(removed->getHandle());
+   Character* const last = &*characters[9];
+   Handle const h9(last->getHandle());
+   RealVec2 const p2(removed->getPosition());
+   RealVec2 const p9(last->getPosition());
+   int const changeCount = gs.getChangeCount();
+   gs.removeCharacter(&*removed);
+   characters = gs.getCharacterListBegin();
+   TG_ASSERT(9 == gs.getCharacterListEnd() - characters && 9 == gs.getCharacterStore().size());
+   TG_ASSERT(20 == gs.getObstacleListEnd() - gs.getObstacleListBegin());
+   TG_ASSERT(last == gs.getCharacter(h9) && last == gs.getObstacle(h9) && &*characters[2] == last);
+   TG_ASSERT(2 == last->getId() && p9 == last->getPosition() && h9 == last->getHandle());
+   TG_ASSERT(!gs.getCharacter(h2) && !gs.getObstacle(h2));
+   TG_ASSERT(changeCount < gs.getChangeCount());
+   // The removed character keeps its state.
+   TG_ASSERT(p2 == removed->getPosition());
+
+   // Its slot is reused, but the old handle stays stale.
+   GameSetup::setupCharacters(gs, perception, 1, RendererPtr());
+   characters = gs.getCharacterListBegin();
+   TG_ASSERT(h2.getSlot() == characters[9]->getHandle().getSlot() && h2 != characters[9]->getHandle());
+   TG_ASSERT(!gs.getCharacter(h2) && &*characters[9] == gs.getCharacter(characters[9]->getHandle()));
+
+   Obstacle* const o = &*gs.getNonCharacterObstacleListBegin()[0];
+   TG_ASSERT(o == gs.getObstacle(o->getHandle()) && !gs.getCharacter(o->getHandle()));
+   Handle const ho(o->getHandle());
+   gs.removeObstacle(o);
+   TG_ASSERT(10 == gs.getNonCharacterObstacleListEnd() - gs.getNonCharacterObstacleListBegin());
+   TG_ASSERT(!gs.getObstacle(ho));
+
+   // The world carries on as normal, until the tagged character goes too.
+   for (size_t frame = 0; frame < 10; frame++)
+   {
+      gs.incFrame();
+      sim.forward(0.1);
+   }
+   Character* const tagged = perception->getTagged();
+   TG_ASSERT(tagged && tagged == gs.getCharacter(tagged->getHandle()));
+   gs.removeCharacter(tagged);
+   TG_ASSERT(!perception->getTagged());
+}
+
+void snapshotTest01()
+{
+   RealVec2 w(Util2D::dim);
+   w.set(300);
+   GameState gs(w, 6);
+   Simulator sim(&gs);
+   PerceptionPtr perception(new Perception(&gs));
+   BehaviorProgramPtr program(GameSetup::setupCharacters(gs, perception, 20, RendererPtr()));
+   GameSetup::setupObstacles(gs, RendererPtr());
+   gs.getCharacterListBegin()[0]->setTagged(gs.getTicks());
+   for (size_t frame = 0; frame < 20; frame++)
+   {
+      gs.incFrame();
+      sim.forward(0.1);
+   }
+
+   Snapshot snapshot;
+   snapshot.capture(gs, *perception, &*program);
+   int const frame = gs.getFrame();
+   std::vector<RealVec2> const captured(gs.getCharacterStore().getPositions());
+
+   // Running on from a restored snapshot repeats exactly the same steps,
+   // tags included.
+   std::vector<std::vector<RealVec2> > positions;
+   std::vector<Character*> tagged;
+   for (size_t k = 0; k < 2; k++)
+   {
+      if (0 < k) { snapshot.restore(gs, *perception, &*program); }
+      TG_ASSERT(frame == gs.getFrame());
+      for (size_t i = 0; i < 100; i++)
+      {
+         gs.incFrame();
+         sim.forward(0.1);
+      }
+      positions.push_back(gs.getCharacterStore().getPositions());
+      tagged.push_back(perception->getTagged());
+   }
+   TG_ASSERT(positions[0] == positions[1] && tagged[0] == tagged[1]);
+   TG_ASSERT(positions[0] != captured);
+}
+
+void lookaheadTest01()
+{
+   // The same world twice, with a tagged character that looks ahead on one
+   // thread in one, and on three in the other.
+   RealVec2 w(Util2D::dim);
+   w.set(200);
+   std::vector<RealVec2> positions[2];
+   for (size_t k = 0; k < 2; k++)
+   {
+      GameState gs(w, 8);
+      Simulator sim(&gs);
+      PerceptionPtr perception(new Perception(&gs));
+      BehaviorProgramPtr program(GameSetup::setupCharacters(gs, perception, 8, RendererPtr()));
+      GameSetup::setupObstacles(gs, RendererPtr(), 2);
+      Character& c(*gs.getCharacterListBegin()[0]);
+      ControllerLookahead::WorkersPtr workers(new ControllerLookahead::Workers(program, 1 + 2 * k));
+      ControllerLookahead* const lookahead = new ControllerLookahead(perception, workers, 6, 0.5, 0.5);
+      c.setController(ControllerPtr(lookahead));
+      c.setTagged(gs.getTicks());
+
+      for (size_t frame = 0; frame < 30; frame++)
+      {
+         gs.incFrame();
+         sim.forward(0.1);
+         if (0 == frame)
+         {
+            // Every direction was tried, and the best one was picked.
+            std::vector<Real> const& scores(lookahead->getScores());
+            TG_ASSERT(6 == scores.size());
+            size_t const best = std::max_element(scores.begin(), scores.end()) - scores.begin();
+            TG_ASSERT(-Inf < scores[best]);
+            TG_ASSERT(c.getAction().getDesiredDirection().isAlmostEq(Util2D::dir(Real(360) * Real(best)/Real(6) - Real(180))));
+         }
+      }
+      positions[k] = gs.getCharacterStore().getPositions();
+   }
+   TG_ASSERT(positions[0] == positions[1]);
+}
+
+void lookaheadTest02()
+{
+   // Three characters that look ahead, sharing one set of workers, on one
+   // thread and on three.  Each sees the others keep doing what they did.
+   RealVec2 w(Util2D::dim);
+   w.set(200);
+   std::vector<RealVec2> positions[2];
+   for (size_t k = 0; k < 2; k++)
+   {
+      GameState gs(w, 5);
+      Simulator sim(&gs);
+      PerceptionPtr perception(new Perception(&gs));
+      BehaviorProgramPtr program(GameSetup::setupCharacters(gs, perception, 8, RendererPtr()));
+      GameSetup::setupObstacles(gs, RendererPtr(), 2);
+      ControllerLookahead::WorkersPtr workers(new ControllerLookahead::Workers(program, 1 + 2 * k));
+      TG_ASSERT(1 + 2 * k == workers->getThreadCount() || 1 == workers->getThreadCount());
+      std::vector<ControllerLookahead*> lookaheads;
+      for (size_t i = 0; i < 3; i++)
+      {
+         lookaheads.push_back(new ControllerLookahead(perception, workers, 4, 0.5, 0.5));
+         gs.getCharacterListBegin()[i]->setController(ControllerPtr(lookaheads.back()));
+      }
+      gs.getCharacterListBegin()[1]->setTagged(gs.getTicks());
+
+      for (size_t frame = 0; frame < 20; frame++)
+      {
+         gs.incFrame();
+         sim.forward(0.1);
+         if (0 == frame)
+         {
+            for (size_t i = 0; i < lookaheads.size(); i++)
+            {
+               std::vector<Real> const& scores(lookaheads[i]->getScores());
+               TG_ASSERT(4 == scores.size() && -Inf < *std::max_element(scores.begin(), scores.end()));
+            }
+         }
+      }
+      positions[k] = gs.getCharacterStore().getPositions();
+   }
+   TG_ASSERT(positions[0] == positions[1]);
+}
+
+void recordTest01()
+{
+   // The match is recorded with a keyframe every 16 frames, then replayed
+   // into a world set up the same way.
+   char const* const fileName = "recordTest01.tgr";
+   std::vector<RealVec2> positions[2];
+   std::vector<RealVec2> positions37;
+   for (size_t k = 0; k < 2; k++)
+   {
+      RealVec2 w(Util2D::dim);
+      w.set(300);
+      GameState gs(w, 9);
+      Simulator sim(&gs);
+      PerceptionPtr perception(new Perception(&gs));
+      BehaviorProgramPtr program(GameSetup::setupCharacters(gs, perception, 20, RendererPtr()));
+      GameSetup::setupObstacles(gs, RendererPtr());
+      gs.getCharacterListBegin()[0]->setTagged(gs.getTicks());
+
+      if (0 == k)
+      {
+         Recorder recorder(fileName, gs, *perception, &*program, 16);
+         sim.setRecorder(&recorder);
+         for (size_t frame = 0; frame < 100; frame++)
+         {
+            if (37 == frame) { positions37 = gs.getCharacterStore().getPositions(); }
+            gs.incFrame();
+            // Any time steps will do.
+            sim.forward(Real(0.05) + Real(frame % 3) * Real(0.02));
+         }
+         TG_ASSERT(100 == recorder.getFrameCount());
+      }
+      else
+      {
+         Replay replay(fileName);
+         TG_ASSERT(100 == replay.getFrameCount() && 20 == replay.getCharacterCount() && 9 == replay.getSeed());
+         sim.setReplay(&replay);
+
+         // Seeking restores the keyframe at 32 and replays 5 frames.
+         replay.seek(37, sim, gs, *perception, &*program);
+         TG_ASSERT(37 == replay.getFrame());
+         TG_ASSERT(positions37 == gs.getCharacterStore().getPositions());
+
+         replay.seek(0, sim, gs, *perception, &*program);
+         while (replay.getFrame() < replay.getFrameCount())
+         {
+            replay.step(sim, gs);
+         }
+      }
+      positions[k] = gs.getCharacterStore().getPositions();
+   }
+   TG_ASSERT(positions[0] == positions[1]);
+   std::remove(fileName);
+}
+
+void telemetryTest01()
+{
+   char const* const fileName = "telemetryTest01.tgt";
+   RealVec2 w(Util2D::dim);
+   w.set(100);
+   GameState gs(w, 4);
+   Simulator sim(&gs);
+   PerceptionPtr perception(new Perception(&gs));
+   GameSetup::setupCharacters(gs, perception, 20, RendererPtr());
+   GameSetup::setupObstacles(gs, RendererPtr());
+   gs.getCharacterListBegin()[0]->setTagged(gs.getTicks());
+
+   // 40 frames in chunks of 16.
+   std::vector<RealVec2> positions;
+   std::vector<int> tagTimes;
+   std::vector<size_t> contactCounts;
+   {
+      Telemetry telemetry(fileName, Real(1)/Real(64), 16);
+      sim.setTelemetry(&telemetry);
+      for (size_t frame = 0; frame < 40; frame++)
+      {
+         gs.incFrame();
+         sim.forward(0.1);
+         EntityStore const& store(gs.getCharacterStore());
+         positions.insert(positions.end(), store.getPositions().begin(), store.getPositions().end());
+         tagTimes.insert(tagTimes.end(), store.getTagTimes().begin(), store.getTagTimes().end());
+         contactCounts.push_back(sim.getContactCount());
+      }
+      sim.setTelemetry(NULL);
+   }
+
+   TelemetryReader reader(fileName);
+   size_t chunkCount = 0;
+   size_t frame = 0;
+   while (reader.nextChunk())
+   {
+      chunkCount++;
+      TG_ASSERT(20 == reader.getCharacterCount());
+      for (size_t f = 0; f < reader.getFrameCount(); f++, frame++)
+      {
+         TG_ASSERT(int(frame + 1) == reader.getFrame(f));
+         TG_ASSERT(contactCounts[frame] == size_t(reader.getContactsEnd(f) - reader.getContactsBegin(f)));
+         for (size_t i = 0; i < 20; i++)
+         {
+            RealVec2 const& p(positions[frame * 20 + i]);
+            TG_ASSERT(p.relativeTo(reader.getPosition(f, i)).length() <= Real(1)/Real(64));
+            TG_ASSERT(tagTimes[frame * 20 + i] == reader.getTagTime(f, i));
+         }
+      }
+   }
+   TG_ASSERT(3 == chunkCount && 40 == frame);
+   std::remove(fileName);
+}
+
+void scenarioTest01()
+{
+   // The text form's random entries give the same world as GameSetup, and
+   // the binary form gives back the same world as it was saved from.
+   char const* const textName = "scenarioTest01.txt";
+   char const* const binaryName = "scenarioTest01.tgs";
+   {
+      std::FILE* const f = std::fopen(textName, "w");
+      std::fputs("# A small world\nworld 512 512\nseed 6\ncharacters 20\ncircles 7\nwalls\ntagged 0\n", f);
+      std::fclose(f);
+   }
+
+   std::vector<RealVec2> characterPositions[3];
+   std::vector<RealVec2> obstaclePositions[3];
+   for (size_t k = 0; k < 3; k++)
+   {
+      RealVec2 w(Util2D::dim);
+      w.set(512);
+      GameState gs(w, 6);
+      PerceptionPtr perception(new Perception(&gs));
+      if (0 == k)
+      {
+         GameSetup::setupCharacters(gs, perception, 20, RendererPtr());
+         GameSetup::setupObstacles(gs, RendererPtr());
+      }
+      else
+      {
+         Scenario scenario(1 == k ? textName : binaryName);
+         TG_ASSERT(w == scenario.getWorldDim() && 6 == scenario.getSeed() && 0 == scenario.getTagged());
+         TG_ASSERT(20 == scenario.getCharacterCount() && 7 == scenario.getCircleCount() && 4 == scenario.getSideCount());
+         if (1 == k) { scenario.saveBinary(binaryName); }
+         scenario.setup(gs, perception, RendererPtr(), RendererPtr());
+         TG_ASSERT(gs.getCharacterListBegin()[0]->getIsTagged());
+      }
+      TG_ASSERT(20 == gs.getCharacterStore().size() && 11 == gs.getObstacleStore().size());
+      characterPositions[k] = gs.getCharacterStore().getPositions();
+      obstaclePositions[k] = gs.getObstacleStore().getPositions();
+
+      // The sides are where GameSetup puts them too.
+      Side const& side(dynamic_cast<Side const&>(gs.getNonCharacterObstacleListBegin()[8]->getShape()));
+      TG_ASSERT(MathUtil::isAlmostEq(Real(-512), side.getDistance()));
+   }
+   for (size_t k = 1; k < 3; k++)
+   {
+      TG_ASSERT(characterPositions[0] == characterPositions[k]);
+      TG_ASSERT(obstaclePositions[0] == obstaclePositions[k]);
+   }
+   std::remove(textName);
+   std::remove(binaryName);
+}
+
+void threadTest01()
+{
+   ThreadPool pool(4);
+   TG_ASSERT(4 == pool.getThreadCount() || 1 == pool.getThreadCount());
+
+   // Run a few times with awkward sizes, so that some blocks are empty and
+   // some chunks are short.
+   size_t const sizes[] = { 0, 1, 3, 1000, 1001 };
+   for (size_t s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++)
+   {
+      CountJob job(sizes[s]);
+      pool.run(job, sizes[s], 7);
+      for (size_t i = 0; i < sizes[s]; i++)
+      {
+         TG_ASSERT(1 == job.counts[i] && job.workers[i] < pool.getThreadCount());
+      }
+   }
+
+   // Back on the calling thread.
+   TG_ASSERT(0 == ThreadPool::getWorker());
+}
+
 int main(int argc, char** argv)
 {
    collideTest01();
    collideTest02();
    collideTest03();
+   collideTest04();
+   collideTest05();
+   collideTest06();
+   collideTest07();
+   integrateTest01();
+   narrowphaseTest01();
+   steeringTest01();
+   perceptionTest01();
+   programTest01();
+   poolTest01();
+   removeTest01();
+   snapshotTest01();
+   lookaheadTest01();
+   lookaheadTest02();
+   recordTest01();
+   telemetryTest01();
+   scenarioTest01();
+   threadTest01();
 
    exit(EXIT_SUCCESS);
 }
@@ -16,6 +16,8 @@
 // ----------------------------------------------------------------------------
 
 #include "Util2D.h"
+#include "Random.h"
+#include "PerfStats.h"
 
 using namespace tagGame;
 
@@ -172,6 +174,72 @@ void mathTestReal()
    v.wrap(u);
 
    TG_ASSERT(20.0 == v[0] && 100.0 == v[1]);
+}
+
+void mathTestReal2()
+{
+   RealVec2 u(Util2D::dim);
+   u[0] = 3.0;
+   u[1] = 4.0;
+
+   TG_ASSERT(2 == u.size());
+   TG_ASSERT(25.0 == u.squaredLength());
+   TG_ASSERT(5.0 == u.length());
+
+   RealVec2 v;
+   TG_ASSERT(v.isAlmostZero());
+   v[0] = 6.0;
+   v[1] = 8.0;
+
+   RealVec2 w(u);
+   w.scale(2.0);
+   TG_ASSERT(v == w);
+   TG_ASSERT(3.0 == u[0] && 4.0 == u[1]);
+   u.scale(2.0);
+   TG_ASSERT(v == u);
+
+   v.add(u);
+   v.subtract(w);
+   TG_ASSERT(v == u);
+
+   v.scale(u);
+   TG_ASSERT(36.0 == v[0] && 64.0 == v[1]);
+   TG_ASSERT(100.0 == v.sum());
+
+   // Must give exactly the same answers as the arbitrary length version.
+   RealVec dv(v);
+   TG_ASSERT(2 == dv.size() && 36.0 == dv[0] && 64.0 == dv[1]);
+   dv.normalize();
+   v.normalize();
+   TG_ASSERT(dv[0] == v[0] && dv[1] == v[1]);
+   TG_ASSERT(RealVec2(dv) == v);
+   TG_ASSERT(MathUtil::isAlmostEq(1.0, v.length()));
+
+   v[0] = 0.0;
+   v[1] = -8.0;
+   TG_ASSERT(-8.0 == v.minElement());
+   TG_ASSERT(0.0 == v.maxElement());
+   TG_ASSERT(1 == v.argMin());
+   TG_ASSERT(0 == v.argMax());
+
+   u[0] = 6.0;
+   u[1] = 8.0;
+   u.clampMaxLength(80);
+   TG_ASSERT(6.0 == u[0] && 8.0 == u[1]);
+   u.clampMaxLength(5.0);
+   TG_ASSERT(3.0 == u[0] && 4.0 == u[1]);
+
+   w = u.relativeTo(v);
+   TG_ASSERT(3.0 == w[0] && 12.0 == w[1]);
+   TG_ASSERT(3.0 == u[0] && 4.0 == u[1]);
+
+   v[0] = -180.0;
+   v[1] = 200.0;
+   u[0] = 50.0;
+   u[1] = 100.0;
+   v.wrap(u);
+
+   TG_ASSERT(20.0 == v[0] && 100.0 == v[1]);
 
    v[0] = 4.0;
    v[1] = 4.0;
@@ -182,8 +250,18 @@ void mathTestReal()
    v[1] = 0;
    u.set(1);
    u.normalize();
-   RealVec a(Util2D::perpendicularTo(v, u));
+   RealVec2 a(Util2D::perpendicularTo(v, u));
    TG_ASSERT(0 == a[0] && 1 == a[1]);
+   a = Util2D::perpendicular(v);
+   TG_ASSERT(0 == a[0] && -1 == a[1]);
+
+   // Shuffling only reorders, and sooner or later swaps.
+   u = a;
+   while (u == a)
+   {
+      a.shuffle();
+   }
+   TG_ASSERT(u[0] == a[1] && u[1] == a[0]);
 }
 
 void mathTestStats()
@@ -214,14 +292,87 @@ void mathTestStats()
    cout << "plot(v, \"^\")\n";
 }
 
+void mathTestRandom()
+{
+   // The same seed and stream gives the same numbers, other streams don't.
+   Random r0(7, 1);
+   Random r1(7, 1);
+   Random r2(7, 2);
+   Random r3(8, 1);
+   for (size_t i = 0; i < 100; i++)
+   {
+      Random::Bits const x(r0.next());
+      TG_ASSERT(x == r1.next());
+      TG_ASSERT(x != r2.next() && x != r3.next());
+   }
+
+   for (size_t i = 0; i < 1000; i++)
+   {
+      Real const x(r0.uniform01());
+      TG_ASSERT(0 <= x && x < 1);
+      int const n(r0.uniform(7));
+      TG_ASSERT(0 <= n && n < 7);
+   }
+
+   // Batches give the same numbers as single draws, even from an odd start.
+   r1 = r0;
+   r0.normal();
+   r1.normal();
+   vector<Real> values(9);
+   r0.normal(values, 2, 3);
+   for (size_t i = 0; i < values.size(); i++)
+   {
+      TG_ASSERT(values[i] == r1.normal(2, 3));
+   }
+   r0.uniform01(values);
+   for (size_t i = 0; i < values.size(); i++)
+   {
+      TG_ASSERT(values[i] == r1.uniform01());
+   }
+
+   // MathUtil draws from the current stream.
+   r1 = r0;
+   {
+      Random::Scope scope(r0);
+      MathUtil::uniform01();
+      TG_ASSERT(&Random::current() == &r0);
+   }
+   TG_ASSERT(&Random::current() != &r0);
+   r1.uniform01();
+   TG_ASSERT(r0.next() == r1.next());
+}
+
+void mathTestHistogram()
+{
+   RollingHistogram h(100);
+   TG_ASSERT(0 == h.getCount() && 0 == h.getPercentile(50) && 0 == h.getMax());
+
+   // Only the last 100 of 1..250 are kept.
+   for (int i = 1; i <= 250; i++)
+   {
+      h.add(Real(i));
+   }
+   TG_ASSERT(100 == h.getCount() && 151 == h.getSample(0) && 250 == h.getLast());
+   TG_ASSERT(200 == h.getPercentile(50));
+   TG_ASSERT(249 == h.getPercentile(99));
+   TG_ASSERT(250 == h.getPercentile(100) && 250 == h.getMax());
+   TG_ASSERT(151 == h.getPercentile(0));
+}
+
 int main(int argc, char** argv)
 {
    mathTestInt();
 
    mathTestReal();
 
+   mathTestReal2();
+
    mathTestStats();
 
+   mathTestRandom();
+
+   mathTestHistogram();
+
    exit(EXIT_SUCCESS);
 }
 
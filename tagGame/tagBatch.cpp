@@ -0,0 +1,245 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+
+// A headless batch runner for the tag game.  It steps the simulator at a
+// fixed time step as fast as the CPU allows, without opening a window.
+// It doesn't use SDL or OpenGL so it can be used to evaluate different
+// AI variants offline.
+
+#include "Simulator.h"
+#include "GameState.h"
+#include "GameSetup.h"
+#include "Character.h"
+#include "Perception.h"
+#include "ControllerLookahead.h"
+#include "Recorder.h"
+#include "Replay.h"
+#include "Telemetry.h"
+#include "Scenario.h"
+#include "Timer.h"
+#include "Util.h"
+#include "Util2D.h"
+
+#include <cstring>
+
+using namespace tagGame;
+
+using namespace std;
+
+static void usage(char const* name)
+{
+   cerr << "usage: " << name << " [options]" << endl;
+   cerr << "  -frames n      maximum number of frames to simulate (default 36000)" << endl;
+   cerr << "  -seconds t     maximum game time to simulate, in seconds" << endl;
+   cerr << "  -tags n        stop after the tagged character has changed n times" << endl;
+   cerr << "  -dt t          fixed time step in seconds (default 1/60)" << endl;
+   cerr << "  -characters n  number of characters (default 5)" << endl;
+   cerr << "  -seed n        random number seed (default 0)" << endl;
+   cerr << "  -threads n     threads to generate actions on, 0 for one per processor (default 1)" << endl;
+   cerr << "  -stats t       write performance counters to stderr every t seconds (default never)" << endl;
+   cerr << "  -lookahead n   give the first n characters a lookahead controller (needs -threads 1)" << endl;
+   cerr << "  -record file   record the match to file" << endl;
+   cerr << "  -replay file   replay the match recorded in file, instead of playing one" << endl;
+   cerr << "  -seek n        start the replay at frame n" << endl;
+   cerr << "  -telemetry file  write the state of the world at every frame to file" << endl;
+   cerr << "  -scenario file  set up the world from a scenario file, instead of at random" << endl;
+   cerr << "  -save-scenario file  save the scenario to file, in binary if it ends in .tgs, otherwise as text" << endl;
+   exit(EXIT_FAILURE);
+}
+
+int main(int argc, char** argv)
+{
+   int maxFrames = 36000;
+   Real maxSeconds = Inf;
+   int maxTags = -1;
+   Real deltaT = Real(1)/Real(60);
+   int characterCount = 5;
+   unsigned seed = 0;
+   int threadCount = 1;
+   Real statsPeriod = Inf;
+   int lookaheadCount = 0;
+   char const* recordFile = NULL;
+   char const* replayFile = NULL;
+   int seekFrame = 0;
+   char const* telemetryFile = NULL;
+   char const* scenarioFile = NULL;
+   char const* saveScenarioFile = NULL;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (i + 1 == argc) { usage(argv[0]); }
+
+      if (0 == strcmp(argv[i], "-frames")) { maxFrames = atoi(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-seconds")) { maxSeconds = atof(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-tags")) { maxTags = atoi(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-dt")) { deltaT = atof(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-characters")) { characterCount = atoi(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-seed")) { seed = unsigned(atoi(argv[++i])); }
+      else if (0 == strcmp(argv[i], "-threads")) { threadCount = atoi(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-stats")) { statsPeriod = atof(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-lookahead")) { lookaheadCount = atoi(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-record")) { recordFile = argv[++i]; }
+      else if (0 == strcmp(argv[i], "-replay")) { replayFile = argv[++i]; }
+      else if (0 == strcmp(argv[i], "-seek")) { seekFrame = atoi(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-telemetry")) { telemetryFile = argv[++i]; }
+      else if (0 == strcmp(argv[i], "-scenario")) { scenarioFile = argv[++i]; }
+      else if (0 == strcmp(argv[i], "-save-scenario")) { saveScenarioFile = argv[++i]; }
+      else { usage(argv[0]); }
+   }
+
+   if (deltaT <= 0 || characterCount < 2 || threadCount < 0 || statsPeriod <= 0) { usage(argv[0]); }
+   if (lookaheadCount < 0 || characterCount < lookaheadCount || (0 < lookaheadCount && 1 != threadCount)) { usage(argv[0]); }
+   if (seekFrame < 0 || (recordFile && replayFile)) { usage(argv[0]); }
+   if (saveScenarioFile && !scenarioFile) { usage(argv[0]); }
+
+   // The scenario decides the world's size, seed and characters.
+   RealVec2 worldDim(Util2D::dim);
+   worldDim.set(512.0);
+   Scenario* scenario = NULL;
+   if (scenarioFile)
+   {
+      scenario = new Scenario(scenarioFile);
+      worldDim = scenario->getWorldDim();
+      characterCount = int(scenario->getCharacterCount());
+      seed = unsigned(scenario->getSeed());
+      if (characterCount < 2 || characterCount < lookaheadCount) { usage(argv[0]); }
+      if (saveScenarioFile)
+      {
+         string const name(saveScenarioFile);
+         if (4 <= name.size() && ".tgs" == name.substr(name.size() - 4)) { scenario->saveBinary(name); }
+         else { scenario->saveText(name); }
+      }
+   }
+
+   // A replay has to be into the same world as the one recorded.
+   Replay* replay = NULL;
+   if (replayFile)
+   {
+      replay = new Replay(replayFile);
+      if (scenario && scenario->getCharacterCount() != replay->getCharacterCount()) { usage(argv[0]); }
+      characterCount = int(replay->getCharacterCount());
+      seed = unsigned(replay->getSeed());
+      if (int(replay->getFrameCount()) < seekFrame) { usage(argv[0]); }
+   }
+
+   // Declared first, so the objects allocated from them go before they do.
+   GameSetup::Pools pools;
+   GameState gs(worldDim, seed);
+   Simulator sim(&gs, size_t(threadCount));
+
+   // Shared perception object (see Chapter 3)
+   PerceptionPtr perception(new Perception(&gs));
+
+   // Nothing is drawn, so no renderers are needed.
+   BehaviorProgramPtr program;
+   if (scenario)
+   {
+      program = scenario->setup(gs, perception, RendererPtr(), RendererPtr(), &pools);
+   }
+   else
+   {
+      program = GameSetup::setupCharacters(gs, perception, characterCount, RendererPtr(), &pools);
+      GameSetup::setupObstacles(gs, RendererPtr(), 7, &pools);
+   }
+   // The lookahead characters share one thread per processor, and one
+   // replica of the world per thread.
+   if (0 < lookaheadCount)
+   {
+      ControllerLookahead::WorkersPtr workers(new ControllerLookahead::Workers(program, 0));
+      for (int i = 0; i < lookaheadCount; i++)
+      {
+         gs.getCharacterListBegin()[i]->setController(ControllerPtr(new ControllerLookahead(perception, workers)));
+      }
+   }
+
+   // Make character 0 the tagged character, unless the scenario says.
+   if (!scenario || scenario->getTagged() < 0)
+   {
+      (*gs.getCharacterListBegin())->setTagged(gs.getTicks());
+   }
+
+   Recorder* recorder = NULL;
+   if (recordFile)
+   {
+      recorder = new Recorder(recordFile, gs, *perception, &*program);
+      sim.setRecorder(recorder);
+   }
+   Telemetry* telemetry = NULL;
+   if (telemetryFile)
+   {
+      telemetry = new Telemetry(telemetryFile);
+      sim.setTelemetry(telemetry);
+   }
+   if (replay)
+   {
+      sim.setReplay(replay);
+      replay->seek(size_t(seekFrame), sim, gs, *perception, &*program);
+   }
+
+   int tagCount = 0;
+   int lastTaggedTime = gs.getLastTaggedTime();
+
+   Real const startWallTime = Timer::time();
+   Real lastStatsTime = startWallTime;
+   while (gs.getFrame() < maxFrames && gs.getTime() < maxSeconds)
+   {
+      if (replay)
+      {
+         if (replay->getFrame() == replay->getFrameCount()) { break; }
+         replay->step(sim, gs);
+      }
+      else
+      {
+         gs.incFrame();
+         sim.forward(deltaT);
+      }
+
+      if (statsPeriod <= Timer::time() - lastStatsTime)
+      {
+         lastStatsTime = Timer::time();
+         cerr << "frame " << gs.getFrame() << ":" << endl << sim.getStats();
+      }
+
+      if (lastTaggedTime != gs.getLastTaggedTime())
+      {
+         lastTaggedTime = gs.getLastTaggedTime();
+         tagCount++;
+         if (tagCount == maxTags) { break; }
+      }
+   }
+   Real const wallTime = Timer::time() - startWallTime;
+
+   // Finishes the files.
+   delete telemetry;
+   delete recorder;
+   delete replay;
+   delete scenario;
+
+   cout << "frames: " << gs.getFrame() << endl;
+   cout << "game time: " << gs.getTime() << " s" << endl;
+   cout << "tags: " << tagCount << endl;
+   cout << "threads: " << sim.getThreadCount() << endl;
+   cout << "total time: " << wallTime << " s" << endl;
+   if (0 < wallTime)
+   {
+      cout << "fps: " << Real(gs.getFrame())/wallTime << endl;
+      cout << "speed-up: " << gs.getTime()/wallTime << "x" << endl;
+   }
+
+   exit(EXIT_SUCCESS);
+}
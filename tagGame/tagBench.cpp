@@ -0,0 +1,200 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+// Benchmark for Simulator::forward.  Runs the NPC behavior (see
+// GameSetup::createNPCController) in worlds of increasing size and prints
+// the cost of each phase of a step per character, one line per world, as
+// comma separated values.  The worlds grow with the number of characters,
+// so that the density of characters stays the same and any growth in the
+// cost per character shows up as a scaling problem.
+
+#include "Simulator.h"
+#include "GameState.h"
+#include "GameSetup.h"
+#include "Character.h"
+#include "Perception.h"
+#include "Timer.h"
+#include "Util.h"
+#include "Util2D.h"
+
+#include <cstring>
+
+using namespace tagGame;
+
+using namespace std;
+
+static void usage(char const* name)
+{
+   cerr << "usage: " << name << " [options]" << endl;
+   cerr << "  -characters l  comma separated numbers of characters (default 10,100,1000,10000,100000)" << endl;
+   cerr << "  -obstacles l   comma separated numbers of circular obstacles per 100 characters (default 0,5,25)" << endl;
+   cerr << "  -area a        world area per character (default 10000)" << endl;
+   cerr << "  -frames n      number of frames to measure (default 100)" << endl;
+   cerr << "  -warmup n      number of frames to run before measuring (default 10)" << endl;
+   cerr << "  -seconds t     stop measuring a world after t seconds of wall clock time (default 10)" << endl;
+   cerr << "  -dt t          fixed time step in seconds (default 1/60)" << endl;
+   cerr << "  -seed n        random number seed (default 0)" << endl;
+   cerr << "  -threads n     threads to generate actions on, 0 for one per processor (default 1)" << endl;
+   exit(EXIT_FAILURE);
+}
+
+// The results of benchmarking one world.
+struct Result
+{
+   size_t characterCount;
+   size_t obstacleCount;
+   Real worldSize;
+   size_t threadCount;
+   int frameCount;
+   Real phaseTimes[Simulator::phaseCount];
+   size_t contactCount;
+   int collisionPassCount;
+   int maxCollisionPassCount;
+};
+
+static void printHeader()
+{
+   cout << "characters,obstacles,worldSize,threads,frames";
+   for (int p = 0; p < Simulator::phaseCount; p++)
+   {
+      cout << "," << Simulator::getPhaseName(Simulator::Phase(p)) << "Ns";
+   }
+   cout << ",totalNs,contactsPerFrame,collisionPassesPerFrame,maxCollisionPasses" << endl;
+}
+
+static void printResult(Result const& r)
+{
+   // Times are in nanoseconds per character per frame.
+   Real const scale = Real(1e9) / (Real(r.frameCount) * Real(r.characterCount));
+   Real total = 0;
+
+   cout << r.characterCount << "," << r.obstacleCount << "," << r.worldSize << "," << r.threadCount << "," << r.frameCount;
+   for (int p = 0; p < Simulator::phaseCount; p++)
+   {
+      cout << "," << r.phaseTimes[p] * scale;
+      total += r.phaseTimes[p];
+   }
+   cout << "," << total * scale;
+   cout << "," << Real(r.contactCount) / Real(r.frameCount);
+   cout << "," << Real(r.collisionPassCount) / Real(r.frameCount);
+   cout << "," << r.maxCollisionPassCount << endl;
+}
+
+static Result run(size_t const characterCount, size_t const obstacleCount, Real const area,
+                  int const warmupFrames, int const maxFrames, Real const maxSeconds,
+                  Real const deltaT, unsigned const seed, size_t const threadCount)
+{
+   Result r;
+   r.characterCount = characterCount;
+   r.obstacleCount = obstacleCount;
+   r.worldSize = sqrt(area * Real(characterCount));
+   r.frameCount = 0;
+   fill(r.phaseTimes, r.phaseTimes + Simulator::phaseCount, Real(0));
+   r.contactCount = 0;
+   r.collisionPassCount = 0;
+   r.maxCollisionPassCount = 0;
+
+   RealVec2 worldDim(Util2D::dim);
+   worldDim.set(r.worldSize);
+   // Declared first, so the objects allocated from them go before they do.
+   GameSetup::Pools pools;
+   GameState gs(worldDim, seed);
+   Simulator sim(&gs, threadCount);
+   r.threadCount = sim.getThreadCount();
+
+   PerceptionPtr perception(new Perception(&gs));
+   GameSetup::setupCharacters(gs, perception, characterCount, RendererPtr(), &pools);
+   GameSetup::setupObstacles(gs, RendererPtr(), obstacleCount, &pools);
+   (*gs.getCharacterListBegin())->setTagged(gs.getTicks());
+
+   for (int i = 0; i < warmupFrames; i++)
+   {
+      gs.incFrame();
+      sim.forward(deltaT);
+   }
+
+   Real const startWallTime = Timer::preciseTime();
+   while (r.frameCount < maxFrames && (0 == r.frameCount || Timer::preciseTime() - startWallTime < maxSeconds))
+   {
+      gs.incFrame();
+      sim.forward(deltaT);
+      r.frameCount++;
+
+      for (int p = 0; p < Simulator::phaseCount; p++)
+      {
+         r.phaseTimes[p] += sim.getPhaseTime(Simulator::Phase(p));
+      }
+      r.contactCount += sim.getContactCount();
+      r.collisionPassCount += sim.getCollisionPassCount();
+      r.maxCollisionPassCount = max(r.maxCollisionPassCount, sim.getCollisionPassCount());
+   }
+
+   return r;
+}
+
+int main(int argc, char** argv)
+{
+   vector<Real> characterCounts;
+   vector<Real> obstacleRatios;
+   Util::parseList("10,100,1000,10000,100000", characterCounts);
+   Util::parseList("0,5,25", obstacleRatios);
+   Real area = 10000;
+   int maxFrames = 100;
+   int warmupFrames = 10;
+   Real maxSeconds = 10;
+   Real deltaT = Real(1)/Real(60);
+   unsigned seed = 0;
+   int threadCount = 1;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (i + 1 == argc) { usage(argv[0]); }
+
+      if (0 == strcmp(argv[i], "-characters")) { if (!Util::parseList(argv[++i], characterCounts)) { usage(argv[0]); } }
+      else if (0 == strcmp(argv[i], "-obstacles")) { if (!Util::parseList(argv[++i], obstacleRatios)) { usage(argv[0]); } }
+      else if (0 == strcmp(argv[i], "-area")) { area = atof(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-frames")) { maxFrames = atoi(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-warmup")) { warmupFrames = atoi(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-seconds")) { maxSeconds = atof(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-dt")) { deltaT = atof(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-seed")) { seed = unsigned(atoi(argv[++i])); }
+      else if (0 == strcmp(argv[i], "-threads")) { threadCount = atoi(argv[++i]); }
+      else { usage(argv[0]); }
+   }
+
+   if (characterCounts.empty() || obstacleRatios.empty() || area <= 0 ||
+       maxFrames < 1 || warmupFrames < 0 || deltaT <= 0 || threadCount < 0)
+   {
+      usage(argv[0]);
+   }
+
+   printHeader();
+   for (size_t i = 0; i < characterCounts.size(); i++)
+   {
+      size_t const characterCount = size_t(characterCounts[i]);
+      if (characterCount < 2) { usage(argv[0]); }
+
+      for (size_t j = 0; j < obstacleRatios.size(); j++)
+      {
+         size_t const obstacleCount = size_t(MathUtil::round(obstacleRatios[j] * Real(characterCount) / Real(100)));
+         printResult(run(characterCount, obstacleCount, area, warmupFrames, maxFrames, maxSeconds,
+                         deltaT, seed, size_t(threadCount)));
+      }
+   }
+
+   exit(EXIT_SUCCESS);
+}
@@ -19,14 +19,9 @@
 #include "Gui.h"
 #include "Character.h"
 #include "ControllerPC.h"
-#include "ControllerPursue.h"
-#include "ControllerEvade.h"
 #include "ControllerWander.h"
 #include "ControllerPeriodic.h"
-#include "ControllerPeriodicRamp.h"
-#include "ControllerConditional.h"
 #include "ControllerAvoid.h"
-#include "ControllerRandomize.h"
 #include "Perception.h"
 #include "Util.h"
 #include "Obstacle.h"
@@ -36,8 +31,12 @@
 #include "JoystickSDL.h"
 #include "KeyboardSDL.h"
 #include "Timer.h"
+#include "Random.h"
+#include "PerfStats.h"
 #include "CharacterRenderer.h"
 #include "Util2D.h"
+#include "GameSetup.h"
+#include "Scenario.h"
 
 #if defined(__APPLE__)
 #include <SDL.h>  // needed on MacOSX
@@ -82,32 +81,6 @@ static ControllerPtr createPCController(PerceptionPtr perception)
    return c;
 }
 
-static ControllerPtr createNPCController(PerceptionPtr perception, Real radius)
-{
-   // Define what counts as the tagged character being "near"
-   Real const tagNear = Real(2) * radius;
-   
-   // Define what counts as the tagged character being "far"
-   Real const tagFar = Real(10) * tagNear;
-
-   // What's the minimum time (in seconds) allowed between decisions
-   Real const minPeriod = 0.2;
-
-   // What's the maximum time (in seconds) allowed between decisions
-   Real const maxPeriod = 0.4;
-
-   return ControllerPtr(
-             new ControllerConditional(perception,
-             &Perception::myselfTagged,
-             ControllerPtr(new ControllerAvoid(perception, ControllerPtr(new ControllerPursue(perception)))),
-             ControllerPtr(new ControllerAvoid(perception,
-                ControllerPtr(new ControllerPeriodicRamp(perception,
-                   ControllerPtr(new ControllerRandomize(perception,
-                      ControllerPtr(new ControllerEvade(perception)),
-                      &Perception::distanceToTagged, tagNear, tagFar)),
-                                                         &Perception::distanceToTagged, tagNear, tagFar, minPeriod, maxPeriod))))));
-}
-
 static void setupCharacters(GameState& gs)
 {
    // add some characters
@@ -122,148 +95,90 @@ static void setupCharacters(GameState& gs)
    rendererNPCPtr->setColor(Gui::getColorFromName("green"));
    rendererNPCPtr->setColorFlash(Gui::getColorFromName("red"));
 
-   Real const radius = Real(10);
-   
    // Shared perception object (see Chapter 3)
    PerceptionPtr perception(new Perception(&gs));
 
-   for (size_t i = 0; i < characterCount; i++)
+   CirclePtr cs(new Circle());
+   cs->setRadius(GameSetup::characterRadius);
+   CharacterPtr c(new Character(cs, createPCController(perception)));
+   c->setRenderer(rendererPCPtr);
    {
-      CirclePtr cs(new Circle());
-      cs->setRadius(radius);
-      CharacterPtr c;
-      if (0 == i)
-      {
-#if defined(TG_USE_TR1)
-         c.reset(new Character(cs, createPCController(perception)));
-#else
-         c = new Character(cs, createPCController(perception));
-#endif
-         c->setRenderer(rendererPCPtr);
-      }
-      else
-      {
-#if defined(TG_USE_TR1)
-         c.reset(new Character(cs, createNPCController(perception, radius)));
-#else
-         c = new Character(cs, createNPCController(perception, radius));
-#endif
-         c->setRenderer(rendererNPCPtr);
-      }
+      Random::Scope scope(gs.getRandom());
       c->setPosition(Util2D::randomPosition(gs.getWorldDim()));
-      c->setMass(1);
-      // TODO: set obstacle properties too
-      // TODO: add sets to contructor parameters for all objects
-      // TODO: set other properties
-      // TODO: inside obstacle circle set radius to more default looking defaults
-      // TODO: assert that me is not NULL for all relevant percepts (ditto for tagged, etc)
-      gs.addCharacter(c);
    }
+   c->setMass(1);
+   // TODO: set obstacle properties too
+   // TODO: add sets to contructor parameters for all objects
+   // TODO: set other properties
+   // TODO: inside obstacle circle set radius to more default looking defaults
+   // TODO: assert that me is not NULL for all relevant percepts (ditto for tagged, etc)
+   gs.addCharacter(c);
+
+   GameSetup::setupCharacters(gs, perception, characterCount - 1, rendererNPCPtr);
 }
 
-static void setupObstacles(GameState& gs)
+// Character 0 is the player's, and the rest are NPCs.
+static void setupScenario(GameState& gs, Scenario const& scenario)
 {
-   CircleRendererPtr osr(new CircleRenderer());
-   osr->setColor(Gui::getColorFromName("white"));
-
-   RealVec const& worldDim(gs.getWorldDim());
-
-   size_t const circularObstacleCount = 7;
-   for (size_t i = 0; i < circularObstacleCount; i++)
-   {
-      ObstaclePtr o(new Obstacle(CirclePtr(new Circle())));
-      o->setRenderer(osr);
-      o->setPosition(Util2D::randomPosition(worldDim));
-      gs.addObstacle(o);
-   }
-
-   RealVec normal(Util2D::dim);
-   RealVec begin(Util2D::dim);
-   RealVec end(Util2D::dim);
-
-   vector<ObstaclePtr> sides(4);
-
-   SidePtr s(new Side());
-   begin.set(0);
-   end.set(0);
-   end[1] = worldDim[1];
-   s->setBegin(end);
-   s->setEnd(begin);
-   normal.set(Real(0));
-   normal[0] = Real(1);
-   s->setNormal(normal);
-   s->setDistance(Real(0));
-#if defined(TG_USE_TR1)
-   sides[0].reset(new Obstacle(s));
-
-   s.reset(new Side());
-#else
-   sides[0] = new Obstacle(s);
+   CharacterRendererPtr rendererPCPtr(new CharacterRenderer());
+   rendererPCPtr->setColor(Gui::getColorFromName("blue"));
+   rendererPCPtr->setColorFlash(Gui::getColorFromName("red"));
 
-   s = new Side();
-#endif
-   begin[0] = worldDim[0];
-   end[0] = worldDim[0];
-   s->setBegin(end);
-   s->setEnd(begin);
-   normal[0] = Real(-1);
-   s->setNormal(normal);
-   s->setDistance(-worldDim[0]);
-#if defined(TG_USE_TR1)
-   sides[1].reset(new Obstacle(s));
+   CharacterRendererPtr rendererNPCPtr(new CharacterRenderer());
+   rendererNPCPtr->setColor(Gui::getColorFromName("green"));
+   rendererNPCPtr->setColorFlash(Gui::getColorFromName("red"));
 
-   s.reset(new Side());
-#else
-   sides[1] = new Obstacle(s);
+   CircleRendererPtr osr(new CircleRenderer());
+   osr->setColor(Gui::getColorFromName("white"));
 
-   s = new Side();
-#endif
-   begin.set(0);
-   end[1] = 0;
-   s->setBegin(end);
-   s->setEnd(begin);
-   normal.set(Real(0));
-   normal[1] = Real(1);
-   s->setNormal(normal);
-   s->setDistance(Real(0));
-#if defined(TG_USE_TR1)
-   sides[2].reset(new Obstacle(s));
+   PerceptionPtr perception(new Perception(&gs));
+   scenario.setup(gs, perception, rendererNPCPtr, osr);
 
-   s.reset(new Side());
-#else
-   sides[2] = new Obstacle(s);
+   if (gs.getCharacterListBegin() == gs.getCharacterListEnd()) { Util::error("tagGame: the scenario has no characters"); }
+   CharacterPtr c(*gs.getCharacterListBegin());
+   c->setController(createPCController(perception));
+   c->setRenderer(rendererPCPtr);
+}
 
-   s = new Side();
-#endif
-   begin[1] = worldDim[1];
-   end[1] = worldDim[1];
-   s->setBegin(end);
-   s->setEnd(begin);
-   normal[1] = Real(-1);
-   s->setNormal(normal);
-   s->setDistance(-worldDim[1]);
-#if defined(TG_USE_TR1)
-   sides[3].reset(new Obstacle(s));
-#else
-   sides[3] = new Obstacle(s);
-#endif
+static void setupObstacles(GameState& gs)
+{
+   CircleRendererPtr osr(new CircleRenderer());
+   osr->setColor(Gui::getColorFromName("white"));
 
-   for (size_t i = 0; i < sides.size(); i++)
-   {
-      gs.addObstacle(sides[i]);
-   }
+   GameSetup::setupObstacles(gs, osr);
 }
 
 int main(int argc, char** argv)
 {
-   RealVec worldDim(Util2D::dim);
+   // An optional scenario file to play, instead of the default world.
+   if (2 < argc) { Util::error("usage: tagGame [scenario]"); }
+   Scenario* scenario = NULL;
+   RealVec2 worldDim(Util2D::dim);
    worldDim.set(512.0);
-   GameState gs(worldDim);
+   Random::Bits seed = 0;
+   if (2 == argc)
+   {
+      scenario = new Scenario(argv[1]);
+      worldDim = scenario->getWorldDim();
+      seed = scenario->getSeed();
+   }
+
+   GameState gs(worldDim, seed);
    Simulator sim(&gs);
 
-   setupCharacters(gs);
+   bool isTagged = false;
+   if (scenario)
+   {
+      setupScenario(gs, *scenario);
+      isTagged = 0 <= scenario->getTagged();
+      delete scenario;
+   }
+   else
+   {
+      setupCharacters(gs);
 
-   setupObstacles(gs);
+      setupObstacles(gs);
+   }
 
    Gui::createWindow(int(worldDim[0]), int(worldDim[1]), "tagGame");
 
@@ -271,12 +186,21 @@ int main(int argc, char** argv)
 
    theTimer.start();
 
-   // Make character 0 the tagged character.
-   (*gs.getCharacterListBegin())->setTagged(theTimer.gameTicks());
+   // Make character 0 the tagged character, unless the scenario says.
+   if (!isTagged)
+   {
+      (*gs.getCharacterListBegin())->setTagged(gs.getTicks());
+   }
+
+   // Show where the time goes (see Gui::setStats), and every statsPeriod
+   // seconds write the same counters out to stderr.
+   PerfStats& stats(sim.getStats());
+   Gui::setStats(&stats);
+   Real const statsPeriod(10);
 
    Real lastGameTime = theTimer.gameTime();
-   Real lastWallTime = theTimer.time();
-   int const fpsFreq(100);
+   Real lastFrameTime = Timer::preciseTime();
+   Real lastStatsTime = theTimer.time();
    while (true)
    {
       Gui::render(&gs);
@@ -284,13 +208,16 @@ int main(int argc, char** argv)
       Real const gameTime = theTimer.gameTime();
       Real const deltaGT = gameTime - lastGameTime;
       lastGameTime = gameTime;
-      if (false && 0 == gs.getFrame() % fpsFreq)
+
+      Real const frameTime = Timer::preciseTime();
+      stats.add(PerfStats::frameTime, frameTime - lastFrameTime);
+      lastFrameTime = frameTime;
+      if (statsPeriod <= theTimer.time() - lastStatsTime)
       {
-         Real const wallTime = theTimer.time();
-         Real const deltaWT = wallTime - lastWallTime;
-         lastWallTime = wallTime;
-         cerr << "fps: " << Real(fpsFreq)/deltaWT << endl;
+         lastStatsTime = theTimer.time();
+         cerr << "frame " << gs.getFrame() << ":" << endl << stats;
       }
+
       if (Gui::isQuit()) { break; }
       sim.forward(deltaGT);
    }
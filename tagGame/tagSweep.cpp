@@ -0,0 +1,472 @@
+// ----------------------------------------------------------------------------
+//
+// tagGame - Example code from the book:
+//
+//           Artficial Intelligence for Computer Games: An Introduction
+//           by John David Funge
+//
+//           www.ai4games.org
+//
+// Source code distributed under the Copyright (c) 2003-2007, John David Funge
+// Original author: John David Funge (www.jfunge.com)
+//
+// Licensed under the Academic Free License version 3.0 
+// (for details see LICENSE.txt in this directory).
+//
+// ----------------------------------------------------------------------------
+
+// Parameter sweep for tuning the NPC behavior.  Plays many independent
+// headless matches, one world per match, on all the processors, for each
+// combination of tuning constants on a grid (or for randomly chosen
+// combinations), and prints how each combination played out, one line per
+// combination as comma separated values, as soon as all its matches are
+// done.  Every combination plays the same seeds, so the differences
+// between them are down to the constants and not to luck.
+
+#include "Simulator.h"
+#include "GameState.h"
+#include "GameSetup.h"
+#include "Character.h"
+#include "Perception.h"
+#include "Scenario.h"
+#include "ThreadPool.h"
+#include "Random.h"
+#include "Util.h"
+#include "Util2D.h"
+
+#include <cmath>
+#include <cstring>
+
+using namespace tagGame;
+
+using namespace std;
+
+// The constants that can be swept.
+enum Parameter
+{
+   tagNearParameter,
+   tagFarParameter,
+   minPeriodParameter,
+   maxPeriodParameter,
+   restitutionParameter,
+   minTagIntervalParameter,
+   maxSpeedParameter,
+   maxForceParameter,
+   parameterCount
+};
+
+static char const* const parameterNames[parameterCount] =
+{
+   "tagNear",
+   "tagFar",
+   "minPeriod",
+   "maxPeriod",
+   "restitution",
+   "minTagInterval",
+   "maxSpeed",
+   "maxForce"
+};
+
+// The values to try for a parameter: either a list, or the range
+// [values[0], values[1]] if isRange.
+struct Sweep
+{
+   vector<Real> values;
+   bool isRange;
+};
+
+// One combination of values for all the parameters.
+struct Configuration
+{
+   Real values[parameterCount];
+};
+
+// How a match played out.
+enum Metric
+{
+   // How often anyone got tagged.
+   tagsPerMinuteMetric,
+   // The most time any one character spent tagged, as a share of the match.
+   taggedShareMetric,
+   // The mean distance from the tagged character to the nearest other one.
+   chaseDistanceMetric,
+   metricCount
+};
+
+static char const* const metricNames[metricCount] =
+{
+   "tagsPerMinute",
+   "taggedShare",
+   "chaseDistance"
+};
+
+struct Metrics
+{
+   Real values[metricCount];
+};
+
+// What's shared by all the matches.
+struct Settings
+{
+   Real seconds;
+   Real deltaT;
+   size_t characterCount;
+   Scenario const* scenario;
+};
+
+static Configuration getDefaults();
+
+static void usage(char const* name)
+{
+   cerr << "usage: " << name << " [options]" << endl;
+   cerr << "  -param name l  sweep a parameter over a comma separated list of values, or" << endl;
+   cerr << "                 over the range lo:hi with -samples (can be repeated)" << endl;
+   cerr << "  -samples n     try n combinations chosen at random, instead of every combination" << endl;
+   cerr << "  -matches n     matches per combination (default 16)" << endl;
+   cerr << "  -seconds t     game time of each match, in seconds (default 120)" << endl;
+   cerr << "  -dt t          fixed time step in seconds (default 1/60)" << endl;
+   cerr << "  -characters n  number of characters (default 5)" << endl;
+   cerr << "  -scenario file play the matches in a scenario (see Scenario.h), instead of at random" << endl;
+   cerr << "  -seed n        seed of the first match, and of the random search (default 0)" << endl;
+   cerr << "  -threads n     matches to play at once, 0 for one per processor (default 0)" << endl;
+   cerr << "parameters (and their defaults):";
+   Configuration const defaults(getDefaults());
+   for (int p = 0; p < parameterCount; p++)
+   {
+      cerr << " " << parameterNames[p] << " (" << defaults.values[p] << ")";
+   }
+   cerr << endl;
+   exit(EXIT_FAILURE);
+}
+
+// The game's own values, read from a world set up the usual way.
+static Configuration getDefaults()
+{
+   RealVec2 worldDim(Util2D::dim);
+   worldDim.set(512.0);
+   GameState gs(worldDim);
+   Simulator sim(&gs);
+   PerceptionPtr perception(new Perception(&gs));
+   GameSetup::setupCharacters(gs, perception, 1, RendererPtr());
+   GameSetup::NPCTuning const tuning;
+
+   Configuration c;
+   c.values[tagNearParameter] = tuning.tagNear;
+   c.values[tagFarParameter] = tuning.tagFar;
+   c.values[minPeriodParameter] = tuning.minPeriod;
+   c.values[maxPeriodParameter] = tuning.maxPeriod;
+   c.values[restitutionParameter] = sim.getRestitution();
+   c.values[minTagIntervalParameter] = Real(sim.getMinTagInterval());
+   c.values[maxSpeedParameter] = gs.getCharacterStore().getMaxSpeeds()[0];
+   c.values[maxForceParameter] = gs.getCharacterStore().getMaxForces()[0];
+   return c;
+}
+
+static bool isValid(Configuration const& c)
+{
+   Real const* v = c.values;
+   return 0 < v[tagNearParameter] && 1 <= v[tagFarParameter] &&
+          0 < v[minPeriodParameter] && v[minPeriodParameter] <= v[maxPeriodParameter] &&
+          0 <= v[restitutionParameter] && v[restitutionParameter] <= 1 &&
+          0 <= v[minTagIntervalParameter] && 0 < v[maxSpeedParameter] && 0 < v[maxForceParameter];
+}
+
+static Metrics play(Configuration const& c, Settings const& settings, unsigned const seed)
+{
+   GameSetup::NPCTuning tuning;
+   tuning.tagNear = c.values[tagNearParameter];
+   tuning.tagFar = c.values[tagFarParameter];
+   tuning.minPeriod = c.values[minPeriodParameter];
+   tuning.maxPeriod = c.values[maxPeriodParameter];
+
+   RealVec2 worldDim(Util2D::dim);
+   worldDim.set(512.0);
+   if (settings.scenario) { worldDim = settings.scenario->getWorldDim(); }
+
+   // Declared first, so the objects allocated from them go before they do.
+   GameSetup::Pools pools;
+   GameState gs(worldDim, seed);
+   // The matches are already spread over the processors.
+   Simulator sim(&gs, 1);
+   sim.setRestitution(c.values[restitutionParameter]);
+   sim.setMinTagInterval(int(c.values[minTagIntervalParameter] + Real(0.5)));
+
+   PerceptionPtr perception(new Perception(&gs));
+   if (settings.scenario)
+   {
+      settings.scenario->setup(gs, perception, RendererPtr(), RendererPtr(), &pools, tuning);
+   }
+   else
+   {
+      GameSetup::setupCharacters(gs, perception, settings.characterCount, RendererPtr(), &pools, tuning);
+      GameSetup::setupObstacles(gs, RendererPtr(), 7, &pools);
+   }
+
+   EntityStore& store(gs.getCharacterStore());
+   size_t const n = store.size();
+   fill(store.getMaxSpeeds().begin(), store.getMaxSpeeds().end(), c.values[maxSpeedParameter]);
+   fill(store.getMaxForces().begin(), store.getMaxForces().end(), c.values[maxForceParameter]);
+   if (!settings.scenario || settings.scenario->getTagged() < 0)
+   {
+      (*gs.getCharacterListBegin())->setTagged(gs.getTicks());
+   }
+
+   int tagCount = 0;
+   int lastTaggedTime = gs.getLastTaggedTime();
+   vector<Real> taggedTimes(n, Real(0));
+   Real chaseDistance = 0;
+   int chaseFrames = 0;
+   vector<RealVec2> const& positions(store.getPositions());
+   vector<int> const& tagTimes(store.getTagTimes());
+   while (gs.getTime() < settings.seconds)
+   {
+      gs.incFrame();
+      sim.forward(settings.deltaT);
+
+      if (lastTaggedTime != gs.getLastTaggedTime())
+      {
+         lastTaggedTime = gs.getLastTaggedTime();
+         tagCount++;
+      }
+
+      size_t tagged = 0;
+      while (tagged < n && tagTimes[tagged] < 0) { tagged++; }
+      if (tagged == n) { continue; }
+      taggedTimes[tagged] += settings.deltaT;
+
+      Real nearest = Inf;
+      for (size_t i = 0; i < n; i++)
+      {
+         if (i != tagged) { nearest = min(nearest, positions[i].relativeTo(positions[tagged]).length()); }
+      }
+      if (nearest < Inf)
+      {
+         chaseDistance += nearest;
+         chaseFrames++;
+      }
+   }
+
+   Metrics m;
+   m.values[tagsPerMinuteMetric] = Real(60 * tagCount) / gs.getTime();
+   m.values[taggedShareMetric] = *max_element(taggedTimes.begin(), taggedTimes.end()) / gs.getTime();
+   m.values[chaseDistanceMetric] = chaseFrames ? chaseDistance / Real(chaseFrames) : Real(0);
+   return m;
+}
+
+// Plays a batch of configurations' matches, one match per item.
+class PlayJob : public ThreadPool::Job
+{
+public:
+   PlayJob(vector<Configuration> const& configurations, size_t const matchCount, unsigned const seed, Settings const& settings) :
+      configurations(configurations),
+      matchCount(matchCount),
+      seed(seed),
+      settings(settings),
+      metrics(configurations.size() * matchCount)
+   {
+   }
+
+   void run(size_t const begin, size_t const end, size_t const worker)
+   {
+      for (size_t k = begin; k < end; k++)
+      {
+         metrics[k] = play(configurations[k / matchCount], settings, seed + unsigned(k % matchCount));
+      }
+   }
+
+   vector<Configuration> const& configurations;
+   size_t const matchCount;
+   unsigned const seed;
+   Settings const& settings;
+   vector<Metrics> metrics;
+};
+
+static void printHeader()
+{
+   cout << "configuration";
+   for (int p = 0; p < parameterCount; p++)
+   {
+      cout << "," << parameterNames[p];
+   }
+   cout << ",matches";
+   for (int k = 0; k < metricCount; k++)
+   {
+      cout << "," << metricNames[k] << "," << metricNames[k] << "Sd";
+   }
+   cout << endl;
+}
+
+// The mean and standard deviation of each metric over a configuration's
+// matches.
+static void printResult(size_t const number, Configuration const& c, Metrics const* metrics, size_t const matchCount)
+{
+   cout << number;
+   for (int p = 0; p < parameterCount; p++)
+   {
+      cout << "," << c.values[p];
+   }
+   cout << "," << matchCount;
+   for (int k = 0; k < metricCount; k++)
+   {
+      Real sum = 0;
+      Real sumSq = 0;
+      for (size_t i = 0; i < matchCount; i++)
+      {
+         Real const x = metrics[i].values[k];
+         sum += x;
+         sumSq += x * x;
+      }
+      Real const mean = sum / Real(matchCount);
+      Real const variance = 1 < matchCount ? max(Real(0), (sumSq - sum * mean) / Real(matchCount - 1)) : Real(0);
+      cout << "," << mean << "," << sqrt(variance);
+   }
+   // Flushed, so that results can be watched as they come in.
+   cout << endl;
+}
+
+int main(int argc, char** argv)
+{
+   Configuration const defaults(getDefaults());
+   Sweep sweeps[parameterCount];
+   for (int p = 0; p < parameterCount; p++)
+   {
+      sweeps[p].values.push_back(defaults.values[p]);
+      sweeps[p].isRange = false;
+   }
+   int sampleCount = 0;
+   int matchCount = 16;
+   Settings settings;
+   settings.seconds = 120;
+   settings.deltaT = Real(1)/Real(60);
+   settings.characterCount = 5;
+   settings.scenario = NULL;
+   char const* scenarioFile = NULL;
+   unsigned seed = 0;
+   int threadCount = 0;
+
+   for (int i = 1; i < argc; i++)
+   {
+      if (i + 1 == argc) { usage(argv[0]); }
+
+      if (0 == strcmp(argv[i], "-param"))
+      {
+         if (i + 2 == argc) { usage(argv[0]); }
+         char const* const name = argv[++i];
+         char const* const values = argv[++i];
+         int p = 0;
+         while (p < parameterCount && 0 != strcmp(name, parameterNames[p])) { p++; }
+         if (parameterCount == p) { usage(argv[0]); }
+         sweeps[p].isRange = NULL != strchr(values, ':');
+         if (sweeps[p].isRange)
+         {
+            char* end;
+            sweeps[p].values.resize(2);
+            sweeps[p].values[0] = strtod(values, &end);
+            if (end == values || ':' != *end) { usage(argv[0]); }
+            char const* const upper = end + 1;
+            sweeps[p].values[1] = strtod(upper, &end);
+            if (end == upper || *end || sweeps[p].values[1] < sweeps[p].values[0]) { usage(argv[0]); }
+         }
+         else if (!Util::parseList(values, sweeps[p].values))
+         {
+            usage(argv[0]);
+         }
+      }
+      else if (0 == strcmp(argv[i], "-samples")) { sampleCount = atoi(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-matches")) { matchCount = atoi(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-seconds")) { settings.seconds = atof(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-dt")) { settings.deltaT = atof(argv[++i]); }
+      else if (0 == strcmp(argv[i], "-characters")) { settings.characterCount = size_t(atoi(argv[++i])); }
+      else if (0 == strcmp(argv[i], "-scenario")) { scenarioFile = argv[++i]; }
+      else if (0 == strcmp(argv[i], "-seed")) { seed = unsigned(atoi(argv[++i])); }
+      else if (0 == strcmp(argv[i], "-threads")) { threadCount = atoi(argv[++i]); }
+      else { usage(argv[0]); }
+   }
+
+   if (sampleCount < 0 || matchCount < 1 || settings.seconds <= 0 || settings.deltaT <= 0 ||
+       settings.characterCount < 2 || threadCount < 0)
+   {
+      usage(argv[0]);
+   }
+
+   // Every combination on the grid, or sampleCount random ones.
+   vector<Configuration> configurations;
+   Random random(seed);
+   if (0 < sampleCount)
+   {
+      configurations.resize(size_t(sampleCount));
+      for (size_t i = 0; i < configurations.size(); i++)
+      {
+         for (int p = 0; p < parameterCount; p++)
+         {
+            vector<Real> const& v(sweeps[p].values);
+            if (sweeps[p].isRange) { configurations[i].values[p] = v[0] + (v[1] - v[0]) * random.uniform01(); }
+            else { configurations[i].values[p] = v[random.uniform(int(v.size()))]; }
+         }
+      }
+   }
+   else
+   {
+      size_t count = 1;
+      for (int p = 0; p < parameterCount; p++)
+      {
+         if (sweeps[p].isRange) { usage(argv[0]); }
+         count *= sweeps[p].values.size();
+      }
+      configurations.resize(count);
+      for (size_t i = 0; i < count; i++)
+      {
+         // The last parameter changes fastest.
+         size_t rest = i;
+         for (int p = parameterCount - 1; 0 <= p; p--)
+         {
+            vector<Real> const& v(sweeps[p].values);
+            configurations[i].values[p] = v[rest % v.size()];
+            rest /= v.size();
+         }
+      }
+   }
+
+   Scenario* scenario = NULL;
+   if (scenarioFile)
+   {
+      scenario = new Scenario(scenarioFile);
+      if (scenario->getCharacterCount() < 2) { usage(argv[0]); }
+      settings.scenario = scenario;
+   }
+
+   // Enough configurations at a time to keep every processor busy, while
+   // still printing results as they come.
+   ThreadPool pool((size_t(threadCount)));
+   size_t const batchSize = max(size_t(1), (4 * pool.getThreadCount() + size_t(matchCount) - 1) / size_t(matchCount));
+
+   printHeader();
+   for (size_t first = 0; first < configurations.size(); first += batchSize)
+   {
+      vector<Configuration> batch;
+      vector<size_t> numbers;
+      for (size_t i = first; i < min(first + batchSize, configurations.size()); i++)
+      {
+         if (isValid(configurations[i]))
+         {
+            batch.push_back(configurations[i]);
+            numbers.push_back(i);
+         }
+         else
+         {
+            cerr << "skipping configuration " << i << ", whose values are out of range" << endl;
+         }
+      }
+
+      PlayJob job(batch, size_t(matchCount), seed, settings);
+      pool.run(job, job.metrics.size());
+      for (size_t i = 0; i < batch.size(); i++)
+      {
+         printResult(numbers[i], batch[i], &job.metrics[i * size_t(matchCount)], size_t(matchCount));
+      }
+   }
+
+   delete scenario;
+
+   exit(EXIT_SUCCESS);
+}